@@ -13,10 +13,50 @@
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
 
+#include <osg/Timer>
+
 // Create local aliases for brevity
 namespace bpo = boost::program_options;
 namespace bfs = boost::filesystem;
 
+///Totals gathered in benchmark mode
+struct Statistics
+{
+    Statistics() : mEnabled(false), mFiles(0), mBytes(0), mSeconds(0.0) {}
+
+    bool mEnabled;
+    size_t mFiles;
+    size_t mBytes;
+    double mSeconds;
+};
+
+Statistics sStatistics;
+
+///Decode a single nif file, timing it in benchmark mode
+void readNIF(Files::IStreamPtr stream, const std::string& name)
+{
+    if(!sStatistics.mEnabled)
+    {
+        Nif::NIFFile temp_nif(stream, name);
+        return;
+    }
+
+    osg::Timer_t start = osg::Timer::instance()->tick();
+
+    std::streamoff size = 0;
+    if(stream->seekg(0, std::ios_base::end))
+    {
+        size = stream->tellg();
+        stream->seekg(0);
+    }
+
+    Nif::NIFFile temp_nif(stream, name);
+
+    sStatistics.mSeconds += osg::Timer::instance()->delta_s(start, osg::Timer::instance()->tick());
+    sStatistics.mBytes += size;
+    ++sStatistics.mFiles;
+}
+
 ///See if the file has the named extension
 bool hasExtension(std::string filename, std::string  extensionToFind)
 {
@@ -61,7 +101,7 @@ void readVFS(VFS::Archive* anArchive,std::string archivePath = "")
             if(isNIF(name))
             {
             //           std::cout << "Decoding: " << name << std::endl;
-                Nif::NIFFile temp_nif(myManager.get(name),archivePath+name);
+                readNIF(myManager.get(name),archivePath+name);
             }
             else if(isBSA(name))
             {
@@ -89,6 +129,7 @@ std::vector<std::string> parseOptions (int argc, char** argv)
         "Allowed options");
     desc.add_options()
         ("help,h", "print help message.")
+        ("benchmark,b", "report the time spent decoding nif files and the resulting throughput.")
         ("input-file", bpo::value< std::vector<std::string> >(), "input file")
         ;
 
@@ -116,6 +157,7 @@ std::vector<std::string> parseOptions (int argc, char** argv)
         std::cout << desc << std::endl;
         exit(1);
     }
+    sStatistics.mEnabled = variables.count ("benchmark") != 0;
     if (variables.count("input-file"))
     {
         return variables["input-file"].as< std::vector<std::string> >();
@@ -139,7 +181,7 @@ int main(int argc, char **argv)
             if(isNIF(name))
             {
                 //std::cout << "Decoding: " << name << std::endl;
-                Nif::NIFFile temp_nif(Files::openConstrainedFileStream(name.c_str()),name);
+                readNIF(Files::openConstrainedFileStream(name.c_str()),name);
              }
              else if(isBSA(name))
              {
@@ -161,5 +203,15 @@ int main(int argc, char **argv)
             std::cerr << "ERROR, an exception has occurred:  " << e.what() << std::endl;
         }
      }
+
+     if(sStatistics.mEnabled)
+     {
+         double megabytes = sStatistics.mBytes / (1024.0 * 1024.0);
+         std::cout << "Decoded " << sStatistics.mFiles << " nif files, " << megabytes << " MB in "
+                   << sStatistics.mSeconds << " s";
+         if(sStatistics.mSeconds > 0)
+             std::cout << " (" << megabytes / sStatistics.mSeconds << " MB/s)";
+         std::cout << std::endl;
+     }
      return 0;
 }
@@ -5,8 +5,10 @@
 #include <ctime>
 #include <cstdio>
 #include <iostream>
+#include <sstream>
 
 #include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 
 #include <osgViewer/ViewerEventHandlers>
 #include <osgDB/ReadFile>
@@ -66,6 +68,27 @@ namespace
         if (ret != 0)
             std::cerr << "SDL error: " << SDL_GetError() << std::endl;
     }
+
+    /// Identifies everything compiled scripts depend on besides their own source: the compiler and the code it
+    /// generates, and the content files (by name, size and modification time, in load order).
+    std::string getScriptCacheSignature(const boost::filesystem::path& resDir, bool newCompiler,
+        const Files::Collections& fileCollections, const std::vector<std::string>& contentFiles)
+    {
+        Version::Version version = Version::getOpenmwVersion(resDir.string());
+
+        std::ostringstream stream;
+        stream << version.mVersion << ' ' << Compiler::sCodeVersion << ' ' << newCompiler;
+
+        for (std::vector<std::string>::const_iterator it = contentFiles.begin(); it != contentFiles.end(); ++it)
+        {
+            boost::filesystem::path filename(*it);
+            boost::filesystem::path path = fileCollections.getCollection(filename.extension().string()).getPath(*it);
+            stream << '\n' << *it << ' ' << boost::filesystem::file_size(path)
+                   << ' ' << boost::filesystem::last_write_time(path);
+        }
+
+        return stream.str();
+    }
 }
 
 void OMW::Engine::executeLocalScripts()
@@ -453,7 +476,8 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
 
     mVFS.reset(new VFS::Manager(mFSStrict));
 
-    VFS::registerArchives(mVFS.get(), mFileCollections, mArchives, true);
+    VFS::registerArchives(mVFS.get(), mFileCollections, mArchives, true,
+                          Settings::Manager::getBool("memory mapped archives", "General"));
 
     mResourceSystem.reset(new Resource::ResourceSystem(mVFS.get()));
     mResourceSystem->getSceneManager()->setUnRefImageDataAfterApply(false); // keep to Off for now to allow better state sharing
@@ -534,9 +558,23 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     mScriptContext = new MWScript::CompilerContext (MWScript::CompilerContext::Type_Full);
     mScriptContext->setExtensions (&mExtensions);
 
-    mEnvironment.setScriptManager (new MWScript::ScriptManager (mEnvironment.getWorld()->getStore(),
+    MWScript::ScriptManager* scriptManager = new MWScript::ScriptManager (mEnvironment.getWorld()->getStore(),
         mVerboseScripts, *mScriptContext, mWarningsMode,
-            mScriptBlacklistUse ? mScriptBlacklist : std::vector<std::string>(), mNewCompiler));
+            mScriptBlacklistUse ? mScriptBlacklist : std::vector<std::string>(), mNewCompiler);
+    mEnvironment.setScriptManager (scriptManager);
+
+    if (Settings::Manager::getBool("script cache", "General"))
+    {
+        try
+        {
+            scriptManager->loadCache(mCfgMgr.getCachePath() / "scripts.cache",
+                getScriptCacheSignature(mResDir, mNewCompiler, mFileCollections, mContentFiles));
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Script cache disabled: " << e.what() << std::endl;
+        }
+    }
 
     // Create game mechanics system
     MWMechanics::MechanicsManager* mechanics = new MWMechanics::MechanicsManager;
@@ -561,7 +599,16 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
                 << 100*static_cast<double> (result.second)/result.first
                 << "%)"
                 << std::endl;
+
+        scriptManager->saveCache();
+    }
+    else if (Settings::Manager::getBool("precompile scripts", "General"))
+    {
+        // compile (or fetch from the cache) all scripts in the background, instead of the first time each
+        // of them runs
+        scriptManager->startPrecompile();
     }
+
     if (mCompileAllDialogue)
     {
         std::pair<int, int> result = MWDialogue::ScriptTest::compileAll(&mExtensions, mWarningsMode, mNewCompiler);
@@ -729,6 +776,9 @@ void OMW::Engine::go()
         }
     }
 
+    // The loop can also end without a quit request, e.g. when the window is closed
+    mEnvironment.getStateManager()->finishSaving();
+
     // Save user settings
     settings.saveUser(settingspath);
 
@@ -50,6 +50,10 @@ namespace MWBase
             ///< Return locals for script \a name.
 
             virtual MWScript::GlobalScripts& getGlobalScripts() = 0;
+
+            virtual void finishPrecompile() = 0;
+            ///< Wait for the background compile pass started at startup, if it is still running.
+            /// Must be called before the world state scripts are compiled against is changed.
    };
 }
 
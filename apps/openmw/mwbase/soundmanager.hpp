@@ -117,6 +117,9 @@ namespace MWBase
             /// returned by \ref playTrack). Only intended to be called by the track
             /// decoder's read method.
 
+            virtual void preloadSound(const std::string& soundId) = 0;
+            ///< Start loading the given sound in the background, so it is ready when it is played.
+
             virtual SoundPtr playSound(const std::string& soundId, float volume, float pitch,
                                        PlayType type=Play_TypeSfx, PlayMode mode=Play_Normal,
                                        float offset=0) = 0;
@@ -44,6 +44,11 @@ namespace MWBase
 
             virtual bool hasQuitRequest() const = 0;
 
+            virtual void finishSaving() = 0;
+            ///< Wait until the saved game being written in the background, if any, is on disk.
+            /// To be called before the user settings are written when quitting, since a successful
+            /// write changes them.
+
             virtual void askLoadRecent() = 0;
 
             virtual State getState() const = 0;
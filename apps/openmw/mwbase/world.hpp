@@ -52,6 +52,7 @@ namespace MWRender
 namespace MWMechanics
 {
     struct Movement;
+    class ExteriorPathgridGraph;
 }
 
 namespace MWWorld
@@ -110,9 +111,11 @@ namespace MWBase
             virtual void readRecord (ESM::ESMReader& reader, uint32_t type,
                 const std::map<int, int>& contentFileMap) = 0;
 
-            virtual MWWorld::CellStore *getExterior (int x, int y) = 0;
+            virtual MWWorld::CellStore *getExterior (int x, int y, bool forceLoad = true) = 0;
+            ///< @param forceLoad Load the references of the cell. If false, the cell may be returned in any state.
 
-            virtual MWWorld::CellStore *getInterior (const std::string& name) = 0;
+            virtual MWWorld::CellStore *getInterior (const std::string& name, bool forceLoad = true) = 0;
+            ///< @param forceLoad Load the references of the cell. If false, the cell may be returned in any state.
 
             virtual MWWorld::CellStore *getCell (const ESM::CellId& id) = 0;
 
@@ -132,6 +135,9 @@ namespace MWBase
 
             virtual const MWWorld::ESMStore& getStore() const = 0;
 
+            virtual const MWMechanics::ExteriorPathgridGraph& getExteriorPathgridGraph() const = 0;
+            ///< Routes between the pathgrids of exterior cells.
+
             virtual std::vector<ESM::ESMReader>& getEsmReader() = 0;
 
             virtual MWWorld::LocalScripts& getLocalScripts() = 0;
@@ -50,7 +50,8 @@
 namespace MWDialogue
 {
     DialogueManager::DialogueManager (Compiler::Extensions& extensions, bool scriptVerbose, Translation::Storage& translationDataStorage, bool newCompiler) :
-      mTranslationDataStorage(translationDataStorage)
+      mTopicIndex(MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>())
+      , mTranslationDataStorage(translationDataStorage)
       , mCompilerContext (MWScript::CompilerContext::Type_Dialogue)
       , mErrorStream(std::cout.rdbuf())
       , mErrorHandler(mErrorStream)
@@ -69,7 +70,7 @@ namespace MWDialogue
         MWWorld::Store<ESM::Dialogue>::iterator it = dialogs.begin();
         for (; it != dialogs.end(); ++it)
         {
-            mDialogueMap[Misc::StringUtils::lowerCase(it->mId)] = *it;
+            mDialogueMap[Misc::StringUtils::lowerCase(it->mId)] = &*it;
         }
     }
 
@@ -147,7 +148,7 @@ namespace MWDialogue
         const MWWorld::Store<ESM::Dialogue> &dialogs =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
 
-        Filter filter (actor, mChoice, mTalkedTo);
+        Filter filter (actor, mChoice, mTalkedTo, mTopicIndex);
 
         for (MWWorld::Store<ESM::Dialogue>::iterator it = dialogs.begin(); it != dialogs.end(); ++it)
         {
@@ -276,7 +277,7 @@ namespace MWDialogue
 
     void DialogueManager::executeTopic (const std::string& topic)
     {
-        Filter filter (mActor, mChoice, mTalkedTo);
+        Filter filter (mActor, mChoice, mTalkedTo, mTopicIndex);
 
         const MWWorld::Store<ESM::Dialogue> &dialogues =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
@@ -354,7 +355,7 @@ namespace MWDialogue
         const MWWorld::Store<ESM::Dialogue> &dialogs =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
 
-        Filter filter (mActor, mChoice, mTalkedTo);
+        Filter filter (mActor, mChoice, mTalkedTo, mTopicIndex);
 
         for (MWWorld::Store<ESM::Dialogue>::iterator iter = dialogs.begin(); iter != dialogs.end(); ++iter)
         {
@@ -440,7 +441,7 @@ namespace MWDialogue
         {
             if(mDialogueMap.find(keyword) != mDialogueMap.end())
             {
-                if (mDialogueMap[keyword].mType == ESM::Dialogue::Topic)
+                if (mDialogueMap[keyword]->mType == ESM::Dialogue::Topic)
                 {
                     executeTopic (keyword);
                 }
@@ -475,12 +476,12 @@ namespace MWDialogue
 
         if (mDialogueMap.find(mLastTopic) != mDialogueMap.end())
         {
-            Filter filter (mActor, mChoice, mTalkedTo);
+            Filter filter (mActor, mChoice, mTalkedTo, mTopicIndex);
 
-            if (mDialogueMap[mLastTopic].mType == ESM::Dialogue::Topic
-                    || mDialogueMap[mLastTopic].mType == ESM::Dialogue::Greeting)
+            if (mDialogueMap[mLastTopic]->mType == ESM::Dialogue::Topic
+                    || mDialogueMap[mLastTopic]->mType == ESM::Dialogue::Greeting)
             {
-                if (const ESM::DialInfo *info = filter.search (mDialogueMap[mLastTopic], true))
+                if (const ESM::DialInfo *info = filter.search (*mDialogueMap[mLastTopic], true))
                 {
                     std::string text = info->mResponse;
                     parseText (text);
@@ -494,8 +495,8 @@ namespace MWDialogue
 
                     // Make sure the returned DialInfo is from the Dialogue we supplied. If could also be from the Info refusal group,
                     // in which case it should not be added to the journal.
-                    for (ESM::Dialogue::InfoContainer::const_iterator iter = mDialogueMap[mLastTopic].mInfo.begin();
-                        iter!=mDialogueMap[mLastTopic].mInfo.end(); ++iter)
+                    for (ESM::Dialogue::InfoContainer::const_iterator iter = mDialogueMap[mLastTopic]->mInfo.begin();
+                        iter!=mDialogueMap[mLastTopic]->mInfo.end(); ++iter)
                     {
                         if (iter->mId == info->mId)
                         {
@@ -599,7 +600,7 @@ namespace MWDialogue
 
     bool DialogueManager::checkServiceRefused()
     {
-        Filter filter (mActor, mChoice, mTalkedTo);
+        Filter filter (mActor, mChoice, mTalkedTo, mTopicIndex);
 
         const MWWorld::Store<ESM::Dialogue> &dialogues =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
@@ -641,7 +642,7 @@ namespace MWDialogue
         const ESM::Dialogue *dial = store.get<ESM::Dialogue>().find(topic);
 
         const MWMechanics::CreatureStats& creatureStats = actor.getClass().getCreatureStats(actor);
-        Filter filter(actor, 0, creatureStats.hasTalkedToPlayer());
+        Filter filter(actor, 0, creatureStats.hasTalkedToPlayer(), mTopicIndex);
         const ESM::DialInfo *info = filter.search(*dial, false);
         if(info != NULL)
         {
@@ -13,6 +13,8 @@
 
 #include "../mwscript/compilercontext.hpp"
 
+#include "topicindex.hpp"
+
 namespace ESM
 {
     struct Dialogue;
@@ -22,7 +24,8 @@ namespace MWDialogue
 {
     class DialogueManager : public MWBase::DialogueManager
     {
-            std::map<std::string, ESM::Dialogue> mDialogueMap;
+            std::map<std::string, const ESM::Dialogue *> mDialogueMap;
+            TopicIndex mTopicIndex;
             std::set<std::string> mKnownTopics;// Those are the topics the player knows.
 
             // Modified faction reactions. <Faction1, <Faction2, Difference> >
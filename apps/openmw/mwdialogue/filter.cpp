@@ -1,5 +1,7 @@
 #include "filter.hpp"
 
+#include <algorithm>
+
 #include <components/compiler/locals.hpp>
 
 #include "../mwbase/environment.hpp"
@@ -20,18 +22,60 @@
 #include "../mwmechanics/actorutil.hpp"
 
 #include "selectwrapper.hpp"
+#include "topicindex.hpp"
 
-bool MWDialogue::Filter::testActor (const ESM::DialInfo& info) const
+namespace
 {
-    bool isCreature = (mActor.getTypeName() != typeid (ESM::NPC).name());
+    void addPartition (const MWDialogue::TopicIndex::Partition& partition, const ESM::RefId& id,
+        std::vector<size_t>& indices)
+    {
+        MWDialogue::TopicIndex::Partition::const_iterator found = partition.find (id);
+        if (found!=partition.end())
+            indices.insert (indices.end(), found->second.begin(), found->second.end());
+    }
+}
+
+void MWDialogue::Filter::getCandidates (const ESM::Dialogue& dialogue,
+    std::vector<const ESM::DialInfo *>& candidates) const
+{
+    const TopicIndex::Topic *topic = mTopicIndex.search (dialogue);
+    if (!topic)
+    {
+        for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin();
+            iter!=dialogue.mInfo.end(); ++iter)
+            candidates.push_back (&*iter);
+        return;
+    }
+
+    std::vector<size_t> indices;
+    addPartition (topic->mByActor, mActorId, indices);
+
+    // Creatures only get infos specific to their ID
+    if (!mIsCreature)
+    {
+        addPartition (topic->mByFaction, mActorFaction, indices);
+        addPartition (topic->mByRace, mActorRace, indices);
+        addPartition (topic->mByClass, mActorClass, indices);
+        indices.insert (indices.end(), topic->mGeneric.begin(), topic->mGeneric.end());
+    }
 
+    // restore the order of the topic, which determines the priority of the infos
+    std::sort (indices.begin(), indices.end());
+
+    candidates.reserve (indices.size());
+    for (std::vector<size_t>::const_iterator iter = indices.begin(); iter!=indices.end(); ++iter)
+        candidates.push_back (topic->mInfos[*iter]);
+}
+
+bool MWDialogue::Filter::testActor (const ESM::DialInfo& info) const
+{
     // actor id
     if (!info.mActor.empty())
     {
-        if ( !Misc::StringUtils::ciEqual(info.mActor, mActor.getCellRef().getRefId()))
+        if (info.mActorId != mActorId)
             return false;
     }
-    else if (isCreature)
+    else if (mIsCreature)
     {
         // Creatures must not have topics aside of those specific to their id
         return false;
@@ -40,42 +84,38 @@ bool MWDialogue::Filter::testActor (const ESM::DialInfo& info) const
     // NPC race
     if (!info.mRace.empty())
     {
-        if (isCreature)
+        if (mIsCreature)
             return true;
 
-        MWWorld::LiveCellRef<ESM::NPC> *cellRef = mActor.get<ESM::NPC>();
-
-        if (!Misc::StringUtils::ciEqual(info.mRace, cellRef->mBase->mRace))
+        if (info.mRaceId != mActorRace)
             return false;
     }
 
     // NPC class
     if (!info.mClass.empty())
     {
-        if (isCreature)
+        if (mIsCreature)
             return true;
 
-        MWWorld::LiveCellRef<ESM::NPC> *cellRef = mActor.get<ESM::NPC>();
-
-        if ( !Misc::StringUtils::ciEqual(info.mClass, cellRef->mBase->mClass))
+        if (info.mClassId != mActorClass)
             return false;
     }
 
     // NPC faction
     if (info.mFactionLess)
     {
-        if (isCreature)
+        if (mIsCreature)
             return true;
 
-        if (!mActor.getClass().getPrimaryFaction(mActor).empty())
+        if (!mActorFaction.empty())
             return false;
     }
     else if (!info.mFaction.empty())
     {
-        if (isCreature)
+        if (mIsCreature)
             return true;
 
-        if (!Misc::StringUtils::ciEqual(mActor.getClass().getPrimaryFaction(mActor), info.mFaction))
+        if (info.mFactionId != mActorFaction)
             return false;
 
         // check rank
@@ -84,7 +124,7 @@ bool MWDialogue::Filter::testActor (const ESM::DialInfo& info) const
     }
     else if (info.mData.mRank != -1)
     {
-        if (isCreature)
+        if (mIsCreature)
             return true;
 
         // Rank requirement, but no faction given. Use the actor's faction, if there is one.
@@ -94,7 +134,7 @@ bool MWDialogue::Filter::testActor (const ESM::DialInfo& info) const
     }
 
     // Gender
-    if (!isCreature)
+    if (!mIsCreature)
     {
         MWWorld::LiveCellRef<ESM::NPC>* npc = mActor.get<ESM::NPC>();
         if (info.mData.mGender==(npc->mBase->mFlags & npc->mBase->Female ? 0 : 1))
@@ -140,8 +180,26 @@ bool MWDialogue::Filter::testSelectStructs (const ESM::DialInfo& info) const
 {
     for (std::vector<ESM::DialInfo::SelectStruct>::const_iterator iter (info.mSelects.begin());
         iter != info.mSelects.end(); ++iter)
-        if (!testSelectStruct (*iter))
+    {
+        // Many infos share the same conditions, e.g. on a global or a journal index
+        SelectResults& results = mSelectResults[iter->mSelectRule];
+
+        SelectResults::const_iterator result = results.begin();
+        while (result!=results.end() && result->first!=iter->mValue)
+            ++result;
+
+        bool passed;
+        if (result!=results.end())
+            passed = result->second;
+        else
+        {
+            passed = testSelectStruct (*iter);
+            results.push_back (std::make_pair (iter->mValue, passed));
+        }
+
+        if (!passed)
             return false;
+    }
 
     return true;
 }
@@ -453,19 +511,19 @@ bool MWDialogue::Filter::getSelectStructBoolean (const SelectWrapper& select) co
 
         case SelectWrapper::Function_NotId:
 
-            return !Misc::StringUtils::ciEqual(mActor.getCellRef().getRefId(), select.getName());
+            return select.getNameId() != mActorId;
 
         case SelectWrapper::Function_NotFaction:
 
-            return !Misc::StringUtils::ciEqual(mActor.getClass().getPrimaryFaction(mActor), select.getName());
+            return select.getNameId() != mActorFaction;
 
         case SelectWrapper::Function_NotClass:
 
-            return !Misc::StringUtils::ciEqual(mActor.get<ESM::NPC>()->mBase->mClass, select.getName());
+            return select.getNameId() != mActorClass;
 
         case SelectWrapper::Function_NotRace:
 
-            return !Misc::StringUtils::ciEqual(mActor.get<ESM::NPC>()->mBase->mRace, select.getName());
+            return select.getNameId() != mActorRace;
 
         case SelectWrapper::Function_NotCell:
 
@@ -602,9 +660,20 @@ bool MWDialogue::Filter::hasFactionRankReputationRequirements (const MWWorld::Pt
     return stats.getFactionReputation (factionId)>=faction.mData.mRankData[rank].mFactReaction;
 }
 
-MWDialogue::Filter::Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer)
-: mActor (actor), mChoice (choice), mTalkedToPlayer (talkedToPlayer)
-{}
+MWDialogue::Filter::Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer,
+    const TopicIndex& topicIndex)
+: mActor (actor), mChoice (choice), mTalkedToPlayer (talkedToPlayer), mTopicIndex (topicIndex)
+, mIsCreature (actor.getTypeName() != typeid (ESM::NPC).name())
+, mActorId (actor.getCellRef().getRefId())
+{
+    if (!mIsCreature)
+    {
+        const ESM::NPC* npc = actor.get<ESM::NPC>()->mBase;
+        mActorRace = ESM::RefId (npc->mRace);
+        mActorClass = ESM::RefId (npc->mClass);
+        mActorFaction = ESM::RefId (actor.getClass().getPrimaryFaction (actor));
+    }
+}
 
 const ESM::DialInfo* MWDialogue::Filter::search (const ESM::Dialogue& dialogue, const bool fallbackToInfoRefusal) const
 {
@@ -618,11 +687,14 @@ const ESM::DialInfo* MWDialogue::Filter::search (const ESM::Dialogue& dialogue,
 
 std::vector<const ESM::DialInfo *> MWDialogue::Filter::listAll (const ESM::Dialogue& dialogue) const
 {
+    std::vector<const ESM::DialInfo *> candidates;
+    getCandidates (dialogue, candidates);
+
     std::vector<const ESM::DialInfo *> infos;
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin(); iter!=dialogue.mInfo.end(); ++iter)
+    for (std::vector<const ESM::DialInfo *>::const_iterator iter = candidates.begin(); iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter))
-            infos.push_back(&*iter);
+        if (testActor (**iter))
+            infos.push_back(*iter);
     }
     return infos;
 }
@@ -634,14 +706,17 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
     bool infoRefusal = false;
 
+    std::vector<const ESM::DialInfo *> candidates;
+    getCandidates (dialogue, candidates);
+
     // Iterate over topic responses to find a matching one
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin();
-        iter!=dialogue.mInfo.end(); ++iter)
+    for (std::vector<const ESM::DialInfo *>::const_iterator iter = candidates.begin();
+        iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter))
+        if (testActor (**iter) && testPlayer (**iter) && testSelectStructs (**iter))
         {
-            if (testDisposition (*iter, invertDisposition)) {
-                infos.push_back(&*iter);
+            if (testDisposition (**iter, invertDisposition)) {
+                infos.push_back(*iter);
                 if (!searchAll)
                     break;
             }
@@ -660,10 +735,13 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
         const ESM::Dialogue& infoRefusalDialogue = *dialogues.find ("Info Refusal");
 
-        for (ESM::Dialogue::InfoContainer::const_iterator iter = infoRefusalDialogue.mInfo.begin();
-            iter!=infoRefusalDialogue.mInfo.end(); ++iter)
-            if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter) && testDisposition(*iter, invertDisposition)) {
-                infos.push_back(&*iter);
+        candidates.clear();
+        getCandidates (infoRefusalDialogue, candidates);
+
+        for (std::vector<const ESM::DialInfo *>::const_iterator iter = candidates.begin();
+            iter!=candidates.end(); ++iter)
+            if (testActor (**iter) && testPlayer (**iter) && testSelectStructs (**iter) && testDisposition(**iter, invertDisposition)) {
+                infos.push_back(*iter);
                 if (!searchAll)
                     break;
             }
@@ -674,10 +752,13 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
 bool MWDialogue::Filter::responseAvailable (const ESM::Dialogue& dialogue) const
 {
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin();
-        iter!=dialogue.mInfo.end(); ++iter)
+    std::vector<const ESM::DialInfo *> candidates;
+    getCandidates (dialogue, candidates);
+
+    for (std::vector<const ESM::DialInfo *>::const_iterator iter = candidates.begin();
+        iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter))
+        if (testActor (**iter) && testPlayer (**iter) && testSelectStructs (**iter))
             return true;
     }
 
@@ -2,6 +2,12 @@
 #define GAME_MWDIALOGUE_FILTER_H
 
 #include <vector>
+#include <map>
+#include <string>
+#include <utility>
+
+#include <components/esm/refid.hpp>
+#include <components/esm/variant.hpp>
 
 #include "../mwworld/ptr.hpp"
 
@@ -14,12 +20,30 @@ namespace ESM
 namespace MWDialogue
 {
     class SelectWrapper;
+    class TopicIndex;
 
     class Filter
     {
             MWWorld::Ptr mActor;
             int mChoice;
             bool mTalkedToPlayer;
+            const TopicIndex& mTopicIndex;
+
+            // Interned IDs of the actor, for matching against DialInfos
+            bool mIsCreature;
+            ESM::RefId mActorId;
+            ESM::RefId mActorRace;
+            ESM::RefId mActorClass;
+            ESM::RefId mActorFaction;
+
+            // Results of select structs tested by this filter, by select rule and value. The runtime state
+            // they depend on does not change during the lifetime of a filter.
+            typedef std::vector<std::pair<ESM::Variant, bool> > SelectResults;
+            mutable std::map<std::string, SelectResults> mSelectResults;
+
+            void getCandidates (const ESM::Dialogue& dialogue, std::vector<const ESM::DialInfo *>& candidates) const;
+            ///< Get the infos of \a dialogue that are not ruled out for this actor by their speaker ID, faction,
+            /// race or class, in the order of the dialogue. Dialogues missing from the topic index yield all their infos.
 
             bool testActor (const ESM::DialInfo& info) const;
             ///< Is this the right actor for this \a info?
@@ -51,7 +75,7 @@ namespace MWDialogue
 
         public:
 
-            Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer);
+            Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer, const TopicIndex& topicIndex);
 
             std::vector<const ESM::DialInfo *> list (const ESM::Dialogue& dialogue,
                 bool fallbackToInfoRefusal, bool searchAll, bool invertDisposition=false) const;
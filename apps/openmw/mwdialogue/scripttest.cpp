@@ -22,13 +22,15 @@
 #include <components/compiler/newcompiler.hpp>
 
 #include "filter.hpp"
+#include "topicindex.hpp"
 
 namespace
 {
 
-void test(const MWWorld::Ptr& actor, int &compiled, int &total, Compiler::Extensions* extensions, int warningsMode, bool newCompiler)
+void test(const MWWorld::Ptr& actor, int &compiled, int &total, Compiler::Extensions* extensions, int warningsMode, bool newCompiler,
+          const MWDialogue::TopicIndex& topicIndex)
 {
-    MWDialogue::Filter filter(actor, 0, false);
+    MWDialogue::Filter filter(actor, 0, false, topicIndex);
 
     MWScript::CompilerContext compilerContext(MWScript::CompilerContext::Type_Dialogue);
     compilerContext.setExtensions(extensions);
@@ -115,18 +117,20 @@ namespace ScriptTest
     std::pair<int, int> compileAll(Compiler::Extensions *extensions, int warningsMode, bool newcompiler)
     {
         int compiled = 0, total = 0;
+        TopicIndex topicIndex(MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>());
+
         const MWWorld::Store<ESM::NPC>& npcs = MWBase::Environment::get().getWorld()->getStore().get<ESM::NPC>();
         for (MWWorld::Store<ESM::NPC>::iterator it = npcs.begin(); it != npcs.end(); ++it)
         {
             MWWorld::ManualRef ref(MWBase::Environment::get().getWorld()->getStore(), it->mId);
-            test(ref.getPtr(), compiled, total, extensions, warningsMode, newcompiler);
+            test(ref.getPtr(), compiled, total, extensions, warningsMode, newcompiler, topicIndex);
         }
 
         const MWWorld::Store<ESM::Creature>& creatures = MWBase::Environment::get().getWorld()->getStore().get<ESM::Creature>();
         for (MWWorld::Store<ESM::Creature>::iterator it = creatures.begin(); it != creatures.end(); ++it)
         {
             MWWorld::ManualRef ref(MWBase::Environment::get().getWorld()->getStore(), it->mId);
-            test(ref.getPtr(), compiled, total, extensions, warningsMode, newcompiler);
+            test(ref.getPtr(), compiled, total, extensions, warningsMode, newcompiler, topicIndex);
         }
         return std::make_pair(total, compiled);
     }
@@ -298,3 +298,8 @@ std::string MWDialogue::SelectWrapper::getName() const
 {
     return Misc::StringUtils::lowerCase (mSelect.mSelectRule.substr (5));
 }
+
+const ESM::RefId& MWDialogue::SelectWrapper::getNameId() const
+{
+    return mSelect.mName;
+}
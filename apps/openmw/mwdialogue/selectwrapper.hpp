@@ -80,6 +80,9 @@ namespace MWDialogue
 
             std::string getName() const;
             ///< Return case-smashed name.
+
+            const ESM::RefId& getNameId() const;
+            ///< Return interned name, see getName().
     };
 }
 
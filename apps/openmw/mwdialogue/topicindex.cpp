@@ -0,0 +1,37 @@
+#include "topicindex.hpp"
+
+#include <components/esm/loaddial.hpp>
+
+MWDialogue::TopicIndex::TopicIndex (const MWWorld::Store<ESM::Dialogue>& dialogues)
+{
+    for (MWWorld::Store<ESM::Dialogue>::iterator dialogue = dialogues.begin(); dialogue!=dialogues.end(); ++dialogue)
+    {
+        Topic& topic = mTopics[&*dialogue];
+
+        for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue->mInfo.begin();
+            iter!=dialogue->mInfo.end(); ++iter)
+        {
+            size_t index = topic.mInfos.size();
+            topic.mInfos.push_back (&*iter);
+
+            if (!iter->mActor.empty())
+                topic.mByActor[iter->mActorId].push_back (index);
+            else if (iter->mFactionLess)
+                topic.mByFaction[ESM::RefId()].push_back (index);
+            else if (!iter->mFaction.empty())
+                topic.mByFaction[iter->mFactionId].push_back (index);
+            else if (!iter->mRace.empty())
+                topic.mByRace[iter->mRaceId].push_back (index);
+            else if (!iter->mClass.empty())
+                topic.mByClass[iter->mClassId].push_back (index);
+            else
+                topic.mGeneric.push_back (index);
+        }
+    }
+}
+
+const MWDialogue::TopicIndex::Topic *MWDialogue::TopicIndex::search (const ESM::Dialogue& dialogue) const
+{
+    std::map<const ESM::Dialogue *, Topic>::const_iterator found = mTopics.find (&dialogue);
+    return found!=mTopics.end() ? &found->second : NULL;
+}
@@ -0,0 +1,51 @@
+#ifndef GAME_MWDIALOGUE_TOPICINDEX_H
+#define GAME_MWDIALOGUE_TOPICINDEX_H
+
+#include <vector>
+#include <map>
+
+#include <components/esm/refid.hpp>
+
+#include "../mwworld/store.hpp"
+
+namespace ESM
+{
+    struct DialInfo;
+    struct Dialogue;
+}
+
+namespace MWDialogue
+{
+    /// \brief Infos of each dialogue topic, partitioned by the most specific actor condition that can rule them out
+    ///
+    /// Built once after the content files are loaded, dialogue records do not change afterwards.
+    class TopicIndex
+    {
+        public:
+
+            typedef std::map<ESM::RefId, std::vector<size_t> > Partition;
+
+            /// Every info of a topic is in exactly one partition; positions refer to the order of the infos in the topic.
+            struct Topic
+            {
+                std::vector<const ESM::DialInfo *> mInfos;
+
+                Partition mByActor;
+                Partition mByFaction; // factionless infos are under the empty ID
+                Partition mByRace;
+                Partition mByClass;
+                std::vector<size_t> mGeneric;
+            };
+
+            TopicIndex (const MWWorld::Store<ESM::Dialogue>& dialogues);
+
+            const Topic *search (const ESM::Dialogue& dialogue) const;
+            ///< \return NULL if \a dialogue is not one of the records the index was built from
+
+        private:
+
+            std::map<const ESM::Dialogue *, Topic> mTopics;
+    };
+}
+
+#endif
@@ -0,0 +1,123 @@
+#include "actorgrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    // Smallest cell edge length, in game units
+    const float sMinCellSize = 1024.f;
+
+    // Maximum number of cells along each axis, the cell size is increased instead
+    const int sMaxGridSize = 64;
+}
+
+namespace MWMechanics
+{
+    ActorGrid::ActorGrid()
+        : mValid (false), mOriginX (0.f), mOriginY (0.f), mCellSize (sMinCellSize), mSizeX (0), mSizeY (0)
+    {
+    }
+
+    void ActorGrid::build (const std::vector<osg::Vec3f>& positions)
+    {
+        mPositions = positions;
+        mValid = true;
+
+        float minX = std::numeric_limits<float>::max();
+        float minY = std::numeric_limits<float>::max();
+        float maxX = -std::numeric_limits<float>::max();
+        float maxY = -std::numeric_limits<float>::max();
+        for (std::vector<osg::Vec3f>::const_iterator it = positions.begin(); it != positions.end(); ++it)
+        {
+            minX = std::min(minX, it->x());
+            minY = std::min(minY, it->y());
+            maxX = std::max(maxX, it->x());
+            maxY = std::max(maxY, it->y());
+        }
+
+        if (positions.empty())
+        {
+            minX = minY = maxX = maxY = 0.f;
+        }
+
+        mOriginX = minX;
+        mOriginY = minY;
+        mCellSize = std::max(sMinCellSize, std::max(maxX - minX, maxY - minY) / (sMaxGridSize - 1));
+        mSizeX = static_cast<int>((maxX - minX) / mCellSize) + 1;
+        mSizeY = static_cast<int>((maxY - minY) / mCellSize) + 1;
+
+        // two passes, counting and then filling, to store the cells contiguously
+        std::vector<size_t> cells (positions.size());
+        mCellStart.assign(mSizeX * mSizeY + 1, 0);
+        for (size_t i = 0; i < positions.size(); ++i)
+        {
+            int x, y;
+            getCell(positions[i].x(), positions[i].y(), x, y);
+            cells[i] = y * mSizeX + x;
+            ++mCellStart[cells[i] + 1];
+        }
+
+        for (size_t i = 1; i < mCellStart.size(); ++i)
+            mCellStart[i] += mCellStart[i-1];
+
+        mCellPoints.resize(positions.size());
+        std::vector<size_t> fill (mCellStart.begin(), mCellStart.end() - 1);
+        for (size_t i = 0; i < positions.size(); ++i)
+            mCellPoints[fill[cells[i]]++] = i;
+    }
+
+    void ActorGrid::clear()
+    {
+        mValid = false;
+        mPositions.clear();
+        mCellStart.clear();
+        mCellPoints.clear();
+    }
+
+    bool ActorGrid::isValid() const
+    {
+        return mValid;
+    }
+
+    bool ActorGrid::getCell (float x, float y, int& cellX, int& cellY) const
+    {
+        cellX = static_cast<int>(std::floor((x - mOriginX) / mCellSize));
+        cellY = static_cast<int>(std::floor((y - mOriginY) / mCellSize));
+
+        bool inside = cellX >= 0 && cellY >= 0 && cellX < mSizeX && cellY < mSizeY;
+
+        cellX = std::max(0, std::min(cellX, mSizeX - 1));
+        cellY = std::max(0, std::min(cellY, mSizeY - 1));
+        return inside;
+    }
+
+    void ActorGrid::query (const osg::Vec3f& position, float radius, std::vector<size_t>& out) const
+    {
+        if (!mValid || mPositions.empty())
+            return;
+
+        int minX, minY, maxX, maxY;
+        getCell(position.x() - radius, position.y() - radius, minX, minY);
+        getCell(position.x() + radius, position.y() + radius, maxX, maxY);
+
+        size_t first = out.size();
+        float radius2 = radius * radius;
+        for (int y = minY; y <= maxY; ++y)
+        {
+            for (int x = minX; x <= maxX; ++x)
+            {
+                int cell = y * mSizeX + x;
+                for (size_t i = mCellStart[cell]; i < mCellStart[cell+1]; ++i)
+                {
+                    size_t index = mCellPoints[i];
+                    if ((mPositions[index] - position).length2() <= radius2)
+                        out.push_back(index);
+                }
+            }
+        }
+
+        std::sort(out.begin() + first, out.end());
+    }
+}
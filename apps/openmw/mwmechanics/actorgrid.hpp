@@ -0,0 +1,49 @@
+#ifndef GAME_MWMECHANICS_ACTORGRID_H
+#define GAME_MWMECHANICS_ACTORGRID_H
+
+#include <vector>
+
+#include <osg/Vec3f>
+
+namespace MWMechanics
+{
+    /// \brief Uniform grid over the XY plane for finding points within a distance of a position
+    ///
+    /// Points are identified by their index in the list given to build(). The grid is meant to be rebuilt
+    /// whenever the points may have moved, typically once per frame.
+    class ActorGrid
+    {
+        public:
+
+            ActorGrid();
+
+            void build (const std::vector<osg::Vec3f>& positions);
+
+            void clear();
+
+            /// Has the grid been built since the last clear()?
+            bool isValid() const;
+
+            /// Append the indices of all points within \a radius of \a position, in ascending order.
+            void query (const osg::Vec3f& position, float radius, std::vector<size_t>& out) const;
+
+        private:
+
+            bool getCell (float x, float y, int& cellX, int& cellY) const;
+
+            std::vector<osg::Vec3f> mPositions;
+
+            bool mValid;
+            float mOriginX;
+            float mOriginY;
+            float mCellSize;
+            int mSizeX;
+            int mSizeY;
+
+            // Indices of the points in cell i are mCellPoints[mCellStart[i]] to mCellPoints[mCellStart[i+1]-1]
+            std::vector<size_t> mCellStart;
+            std::vector<size_t> mCellPoints;
+    };
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "actors.hpp"
 
 #include <typeinfo>
+#include <algorithm>
 #include <iostream>
 
 #include <components/esm/esmreader.hpp>
@@ -8,6 +9,9 @@
 #include <components/esm/loadnpc.hpp>
 
 #include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+#include <components/settings/settings.hpp>
 
 #include "../mwworld/esmstore.hpp"
 #include "../mwworld/class.hpp"
@@ -149,6 +153,42 @@ namespace MWMechanics
     const float aiProcessingDistance = 7168;
     const float sqrAiProcessingDistance = aiProcessingDistance*aiProcessingDistance;
 
+    // Number of actors whose stat modifiers are calculated by one work item
+    const size_t statUpdateChunkSize = 16;
+
+    class StatModifierUpdate : public SceneUtil::WorkItem
+    {
+        Actors& mActors;
+        size_t mBegin;
+        size_t mEnd;
+        float mDuration;
+        const Actors::StatSettings& mSettings;
+        Actors::HealthList mFatalHealth;
+
+    public:
+        StatModifierUpdate(Actors& actors, size_t begin, size_t end, float duration, const Actors::StatSettings& settings)
+            : mActors(actors), mBegin(begin), mEnd(end), mDuration(duration), mSettings(settings)
+        {
+        }
+
+        virtual void doWork()
+        {
+            try
+            {
+                mActors.updateStatModifiers(mBegin, mEnd, mDuration, mSettings, mFatalHealth);
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "Failed to update actor stats: " << e.what() << std::endl;
+            }
+        }
+
+        const Actors::HealthList& getFatalHealth() const
+        {
+            return mFatalHealth;
+        }
+    };
+
     class SoulTrap : public MWMechanics::EffectSourceVisitor
     {
         MWWorld::Ptr mCreature;
@@ -230,20 +270,35 @@ namespace MWMechanics
         }
     };
 
+    Actors::StatSettings::StatSettings()
+    {
+        const MWWorld::Store<ESM::GameSetting>& gmst = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
+
+        mPlayer = getPlayer();
+        mPCbaseMagickaMult = gmst.find("fPCbaseMagickaMult")->getFloat();
+        mNPCbaseMagickaMult = gmst.find("fNPCbaseMagickaMult")->getFloat();
+        mFatigueReturnBase = gmst.find("fFatigueReturnBase")->getFloat();
+        mFatigueReturnMult = gmst.find("fFatigueReturnMult")->getFloat();
+    }
+
     void Actors::updateActor (const MWWorld::Ptr& ptr, float duration)
+    {
+        updateActor(ptr, duration, StatSettings());
+    }
+
+    void Actors::updateActor (const MWWorld::Ptr& ptr, float duration, const StatSettings& settings)
     {
         // magic effects
         adjustMagicEffects (ptr);
         if (ptr.getClass().getCreatureStats(ptr).needToRecalcDynamicStats())
-            calculateDynamicStats (ptr);
+            calculateDynamicStats (ptr, settings);
 
-        calculateCreatureStatModifiers (ptr, duration);
+        calculateCreatureStatModifiers (ptr, duration, settings);
         // fatigue restoration
-        calculateRestoration(ptr, duration);
+        calculateRestoration(ptr, duration, settings);
     }
 
-    void Actors::updateHeadTracking(const MWWorld::Ptr& actor, const MWWorld::Ptr& targetActor,
-                                    MWWorld::Ptr& headTrackTarget, float& sqrHeadTrackDistance)
+    float Actors::getMaxHeadTrackDistance(const MWWorld::Ptr& actor) const
     {
         static const float fMaxHeadTrackDistance = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
                 .find("fMaxHeadTrackDistance")->getFloat();
@@ -253,6 +308,13 @@ namespace MWMechanics
         const ESM::Cell* currentCell = actor.getCell()->getCell();
         if (!currentCell->isExterior() && !(currentCell->mData.mFlags & ESM::Cell::QuasiEx))
             maxDistance *= fInteriorHeadTrackMult;
+        return maxDistance;
+    }
+
+    void Actors::updateHeadTracking(const MWWorld::Ptr& actor, const MWWorld::Ptr& targetActor,
+                                    MWWorld::Ptr& headTrackTarget, float& sqrHeadTrackDistance)
+    {
+        float maxDistance = getMaxHeadTrackDistance(actor);
 
         const ESM::Position& actor1Pos = actor.getRefData().getPosition();
         const ESM::Position& actor2Pos = targetActor.getRefData().getPosition();
@@ -408,17 +470,13 @@ namespace MWMechanics
         creatureStats.modifyMagicEffects(now);
     }
 
-    void Actors::calculateDynamicStats (const MWWorld::Ptr& ptr)
+    void Actors::calculateDynamicStats (const MWWorld::Ptr& ptr, const StatSettings& settings)
     {
         CreatureStats& creatureStats = ptr.getClass().getCreatureStats (ptr);
 
         int intelligence = creatureStats.getAttribute(ESM::Attribute::Intelligence).getModified();
 
-        float base = 1.f;
-        if (ptr == getPlayer())
-            base = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fPCbaseMagickaMult")->getFloat();
-        else
-            base = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fNPCbaseMagickaMult")->getFloat();
+        float base = ptr == settings.mPlayer ? settings.mPCbaseMagickaMult : settings.mNPCbaseMagickaMult;
 
         double magickaFactor = base +
             creatureStats.getMagicEffects().get (EffectKey (ESM::MagicEffect::FortifyMaximumMagicka)).getMagnitude() * 0.1;
@@ -472,7 +530,7 @@ namespace MWMechanics
         stats.setFatigue (fatigue);
     }
 
-    void Actors::calculateRestoration (const MWWorld::Ptr& ptr, float duration)
+    void Actors::calculateRestoration (const MWWorld::Ptr& ptr, float duration, const StatSettings& settings)
     {
         if (ptr.getClass().getCreatureStats(ptr).isDead())
             return;
@@ -482,11 +540,7 @@ namespace MWMechanics
         int endurance = stats.getAttribute (ESM::Attribute::Endurance).getModified ();
 
         // restore fatigue
-        const MWWorld::Store<ESM::GameSetting>& settings = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
-        static const float fFatigueReturnBase = settings.find("fFatigueReturnBase")->getFloat ();
-        static const float fFatigueReturnMult = settings.find("fFatigueReturnMult")->getFloat ();
-
-        float x = fFatigueReturnBase + fFatigueReturnMult * endurance;
+        float x = settings.mFatigueReturnBase + settings.mFatigueReturnMult * endurance;
 
         DynamicStat<float> fatigue = stats.getFatigue();
         fatigue.setCurrent (fatigue.getCurrent() + duration * x);
@@ -518,13 +572,26 @@ namespace MWMechanics
             }
     };
 
-    void Actors::calculateCreatureStatModifiers (const MWWorld::Ptr& ptr, float duration)
+    void Actors::calculateCreatureStatModifiers (const MWWorld::Ptr& ptr, float duration, const StatSettings& settings)
     {
         CreatureStats &creatureStats = ptr.getClass().getCreatureStats(ptr);
-        const MagicEffects &effects = creatureStats.getMagicEffects();
 
         bool wasDead = creatureStats.isDead();
 
+        applyMagicEffectTicks(ptr, duration);
+
+        DynamicStat<float> health;
+        if (!calculateStatModifiers(ptr, settings, health))
+            creatureStats.setHealth(health);
+
+        applyStatModifierEffects(ptr, wasDead);
+    }
+
+    void Actors::applyMagicEffectTicks (const MWWorld::Ptr& ptr, float duration)
+    {
+        CreatureStats &creatureStats = ptr.getClass().getCreatureStats(ptr);
+        const MagicEffects &effects = creatureStats.getMagicEffects();
+
         if (duration > 0)
         {
             // apply correct magnitude for tickable effects that have just expired,
@@ -552,20 +619,6 @@ namespace MWMechanics
             }
         }
 
-        // attributes
-        for(int i = 0;i < ESM::Attribute::Length;++i)
-        {
-            AttributeValue stat = creatureStats.getAttribute(i);
-            stat.setModifier(static_cast<int>(effects.get(EffectKey(ESM::MagicEffect::FortifyAttribute, i)).getMagnitude() -
-                             effects.get(EffectKey(ESM::MagicEffect::DrainAttribute, i)).getMagnitude() -
-                             effects.get(EffectKey(ESM::MagicEffect::AbsorbAttribute, i)).getMagnitude()));
-
-            creatureStats.setAttribute(i, stat);
-        }
-
-        if (creatureStats.needToRecalcDynamicStats())
-            calculateDynamicStats(ptr);
-
         {
             Spells & spells = creatureStats.getSpells();
             for (Spells::TIterator it = spells.begin(); it != spells.end(); ++it)
@@ -582,8 +635,29 @@ namespace MWMechanics
                 }
             }
         }
+    }
+
+    bool Actors::calculateStatModifiers (const MWWorld::Ptr& ptr, const StatSettings& settings, DynamicStat<float>& health)
+    {
+        CreatureStats &creatureStats = ptr.getClass().getCreatureStats(ptr);
+        const MagicEffects &effects = creatureStats.getMagicEffects();
+
+        // attributes
+        for(int i = 0;i < ESM::Attribute::Length;++i)
+        {
+            AttributeValue stat = creatureStats.getAttribute(i);
+            stat.setModifier(static_cast<int>(effects.get(EffectKey(ESM::MagicEffect::FortifyAttribute, i)).getMagnitude() -
+                             effects.get(EffectKey(ESM::MagicEffect::DrainAttribute, i)).getMagnitude() -
+                             effects.get(EffectKey(ESM::MagicEffect::AbsorbAttribute, i)).getMagnitude()));
+
+            creatureStats.setAttribute(i, stat);
+        }
+
+        if (creatureStats.needToRecalcDynamicStats())
+            calculateDynamicStats(ptr, settings);
 
         // dynamic stats
+        bool healthSet = true;
         for(int i = 0;i < 3;++i)
         {
             DynamicStat<float> stat = creatureStats.getDynamic(i);
@@ -593,7 +667,14 @@ namespace MWMechanics
                              // Fatigue can be decreased below zero meaning the actor will be knocked out
                              i == 1 || i == 2);
 
-            creatureStats.setDynamic(i, stat);
+            // Dying involves the World, so it is left to the caller
+            if (i == 0 && stat.getCurrent() < 1)
+            {
+                health = stat;
+                healthSet = false;
+            }
+            else
+                creatureStats.setDynamic(i, stat);
         }
 
         // AI setting modifiers
@@ -620,6 +701,14 @@ namespace MWMechanics
             creatureStats.setAiSetting(CreatureStats::AI_Flee, stat);
         }
 
+        return healthSet;
+    }
+
+    void Actors::applyStatModifierEffects (const MWWorld::Ptr& ptr, bool wasDead)
+    {
+        CreatureStats &creatureStats = ptr.getClass().getCreatureStats(ptr);
+        const MagicEffects &effects = creatureStats.getMagicEffects();
+
         if (!wasDead && creatureStats.isDead())
         {
             // The actor was killed by a magic effect. Figure out if the player was responsible for it.
@@ -943,7 +1032,12 @@ namespace MWMechanics
         }
     }
 
-    Actors::Actors() {}
+    Actors::Actors()
+    {
+        int statsThreads = Settings::Manager::getInt("actor stats threads", "Game");
+        if (statsThreads > 0)
+            mStatsQueue = new SceneUtil::WorkQueue(statsThreads);
+    }
 
     Actors::~Actors()
     {
@@ -953,6 +1047,7 @@ namespace MWMechanics
     void Actors::addActor (const MWWorld::Ptr& ptr, bool updateImmediately)
     {
         removeActor(ptr);
+        clearActorGrid();
 
         MWRender::Animation *anim = MWBase::Environment::get().getWorld()->getAnimation(ptr);
         if (!anim)
@@ -967,6 +1062,7 @@ namespace MWMechanics
         PtrActorMap::iterator iter = mActors.find(ptr);
         if(iter != mActors.end())
         {
+            clearActorGrid();
             delete iter->second;
             mActors.erase(iter);
         }
@@ -977,6 +1073,7 @@ namespace MWMechanics
         PtrActorMap::iterator iter = mActors.find(old);
         if(iter != mActors.end())
         {
+            clearActorGrid();
             Actor *actor = iter->second;
             mActors.erase(iter);
 
@@ -987,6 +1084,8 @@ namespace MWMechanics
 
     void Actors::dropActors (const MWWorld::CellStore *cellStore, const MWWorld::Ptr& ignore)
     {
+        clearActorGrid();
+
         PtrActorMap::iterator iter = mActors.begin();
         while(iter != mActors.end())
         {
@@ -1017,7 +1116,21 @@ namespace MWMechanics
 
             /// \todo move update logic to Actor class where appropriate
 
-             // AI and magic effects update
+            StatSettings statSettings;
+
+            // With worker threads, the magic effects and stats of all actors are updated before any AI runs.
+            // Otherwise each actor is updated right before its own AI, see below.
+            if (mStatsQueue && !updateActorStats(duration, statSettings))
+                return; // for now abort update of the old cell when cell changes by teleportation magic effect
+                        // a better solution might be to apply cell changes at the end of the frame
+
+            // Actors do not move during the AI update, so their positions can be indexed once for all proximity
+            // queries. Adding or removing an actor (e.g. a summoned creature) invalidates the index.
+            buildActorGrid();
+
+            std::vector<MWWorld::Ptr> neighbors;
+
+            // AI update
             for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
             {
                 // AI processing is only done within distance of 7168 units to the player. Note the "AI distance" slider doesn't affect this
@@ -1034,12 +1147,16 @@ namespace MWMechanics
 
                 if (!iter->first.getClass().getCreatureStats(iter->first).isDead())
                 {
-                    MWWorld::Ptr actor = iter->first; // make a copy of the map key to avoid it being invalidated when the player teleports
-                    updateActor(actor, duration);
-                    if (MWBase::Environment::get().getWorld()->hasCellChanged())
+                    if (!mStatsQueue)
                     {
-                        return; // for now abort update of the old cell when cell changes by teleportation magic effect
-                                // a better solution might be to apply cell changes at the end of the frame
+                        MWWorld::Ptr actor = iter->first; // make a copy of the map key to avoid it being invalidated when the player teleports
+                        updateActor(actor, duration, statSettings);
+                        if (MWBase::Environment::get().getWorld()->hasCellChanged())
+                        {
+                            clearActorGrid();
+                            return; // for now abort update of the old cell when cell changes by teleportation magic effect
+                                    // a better solution might be to apply cell changes at the end of the frame
+                        }
                     }
                     if (MWBase::Environment::get().getMechanicsManager()->isAIActive() && inProcessingRange)
                     {
@@ -1048,11 +1165,19 @@ namespace MWMechanics
                             if (iter->first != player)
                                 adjustCommandedActor(iter->first);
 
-                            for(PtrActorMap::iterator it(mActors.begin()); it != mActors.end(); ++it)
+                            // player is not AI-controlled
+                            if (iter->first != player)
                             {
-                                if (it->first == iter->first || iter->first == player) // player is not AI-controlled
-                                    continue;
-                                engageCombat(iter->first, it->first, it->first == player);
+                                // engageCombat ignores actors beyond the AI processing distance
+                                neighbors.clear();
+                                getObjectsInRange(iter->first.getRefData().getPosition().asVec3(), aiProcessingDistance, neighbors);
+
+                                for (std::vector<MWWorld::Ptr>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it)
+                                {
+                                    if (*it == iter->first)
+                                        continue;
+                                    engageCombat(iter->first, *it, *it == player);
+                                }
                             }
                         }
                         if (timerUpdateHeadTrack == 0)
@@ -1060,11 +1185,15 @@ namespace MWMechanics
                             float sqrHeadTrackDistance = std::numeric_limits<float>::max();
                             MWWorld::Ptr headTrackTarget;
 
-                            for(PtrActorMap::iterator it(mActors.begin()); it != mActors.end(); ++it)
+                            neighbors.clear();
+                            getObjectsInRange(iter->first.getRefData().getPosition().asVec3(),
+                                              getMaxHeadTrackDistance(iter->first), neighbors);
+
+                            for (std::vector<MWWorld::Ptr>::const_iterator it = neighbors.begin(); it != neighbors.end(); ++it)
                             {
-                                if (it->first == iter->first)
+                                if (*it == iter->first)
                                     continue;
-                                updateHeadTracking(iter->first, it->first, headTrackTarget, sqrHeadTrackDistance);
+                                updateHeadTracking(iter->first, *it, headTrackTarget, sqrHeadTrackDistance);
                             }
                             iter->second->getCharacterController()->setHeadTrackTarget(headTrackTarget);
                         }
@@ -1087,6 +1216,8 @@ namespace MWMechanics
                 }
             }
 
+            clearActorGrid();
+
             timerUpdateAITargets += duration;
             timerUpdateHeadTrack += duration;
 
@@ -1227,6 +1358,84 @@ namespace MWMechanics
         }
     }
 
+    bool Actors::updateActorStats (float duration, const StatSettings& settings)
+    {
+        // Magic effects may affect other objects and the world, so they are ticked one actor at a time
+        mStatActors.clear();
+        for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
+        {
+            if (iter->first.getClass().getCreatureStats(iter->first).isDead())
+                continue;
+
+            MWWorld::Ptr actor = iter->first; // make a copy of the map key to avoid it being invalidated when the player teleports
+            adjustMagicEffects(actor);
+            if (actor.getClass().getCreatureStats(actor).needToRecalcDynamicStats())
+                calculateDynamicStats(actor, settings);
+
+            applyMagicEffectTicks(actor, duration);
+            if (MWBase::Environment::get().getWorld()->hasCellChanged())
+            {
+                mStatActors.clear();
+                return false;
+            }
+
+            mStatActors.push_back(actor);
+        }
+
+        // Stat modifiers only depend on each actor's own magic effects and stats, so they are calculated in parallel.
+        // The main thread takes the first chunk itself.
+        HealthList fatalHealth;
+        size_t numActors = mStatActors.size();
+        if (mStatsQueue && numActors >= 2*statUpdateChunkSize)
+        {
+            std::vector<osg::ref_ptr<StatModifierUpdate> > updates;
+            for (size_t begin = statUpdateChunkSize; begin < numActors; begin += statUpdateChunkSize)
+            {
+                updates.push_back(new StatModifierUpdate(*this, begin,
+                    std::min(begin + statUpdateChunkSize, numActors), duration, settings));
+                mStatsQueue->addWorkItem(updates.back());
+            }
+
+            updateStatModifiers(0, statUpdateChunkSize, duration, settings, fatalHealth);
+
+            for (std::vector<osg::ref_ptr<StatModifierUpdate> >::const_iterator it = updates.begin(); it != updates.end(); ++it)
+            {
+                (*it)->waitTillDone();
+                fatalHealth.insert(fatalHealth.end(), (*it)->getFatalHealth().begin(), (*it)->getFatalHealth().end());
+            }
+        }
+        else
+            updateStatModifiers(0, numActors, duration, settings, fatalHealth);
+
+        for (HealthList::const_iterator it = fatalHealth.begin(); it != fatalHealth.end(); ++it)
+            it->first.getClass().getCreatureStats(it->first).setHealth(it->second);
+
+        for (std::vector<MWWorld::Ptr>::const_iterator it = mStatActors.begin(); it != mStatActors.end(); ++it)
+        {
+            // skip actors removed in the meantime, e.g. expired summoned creatures
+            if (mActors.find(*it) != mActors.end())
+                applyStatModifierEffects(*it, false);
+        }
+
+        mStatActors.clear();
+        return true;
+    }
+
+    void Actors::updateStatModifiers (size_t begin, size_t end, float duration, const StatSettings& settings,
+        HealthList& fatalHealth)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            const MWWorld::Ptr& actor = mStatActors[i];
+
+            DynamicStat<float> health;
+            if (calculateStatModifiers(actor, settings, health))
+                calculateRestoration(actor, duration, settings);
+            else
+                fatalHealth.push_back(std::make_pair(actor, health));
+        }
+    }
+
     void Actors::killDeadActors()
     {
         for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
@@ -1266,7 +1475,7 @@ namespace MWMechanics
                 // One case where we need this is to make sure bound items are removed upon death
                 stats.modifyMagicEffects(MWMechanics::MagicEffects());
                 stats.getActiveSpells().clear();
-                calculateCreatureStatModifiers(iter->first, 0);
+                calculateCreatureStatModifiers(iter->first, 0, StatSettings());
 
                 MWBase::Environment::get().getWorld()->enableActorCollision(iter->first, false);
 
@@ -1332,6 +1541,7 @@ namespace MWMechanics
     {
         float duration = 3600.f / MWBase::Environment::get().getWorld()->getTimeScaleFactor();
         MWWorld::Ptr player = MWBase::Environment::get().getWorld()->getPlayerPtr();
+        StatSettings settings;
 
         for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
         {
@@ -1346,9 +1556,9 @@ namespace MWMechanics
 
             adjustMagicEffects (iter->first);
             if (iter->first.getClass().getCreatureStats(iter->first).needToRecalcDynamicStats())
-                calculateDynamicStats (iter->first);
+                calculateDynamicStats (iter->first, settings);
 
-            calculateCreatureStatModifiers (iter->first, duration);
+            calculateCreatureStatModifiers (iter->first, duration, settings);
             if (iter->first.getClass().isNpc())
                 calculateNpcStatModifiers(iter->first, duration);
         }
@@ -1423,8 +1633,40 @@ namespace MWMechanics
             iter->second->getCharacterController()->persistAnimationState();
     }
 
+    void Actors::buildActorGrid()
+    {
+        mActorList.clear();
+        mActorList.reserve(mActors.size());
+
+        std::vector<osg::Vec3f> positions;
+        positions.reserve(mActors.size());
+
+        for (PtrActorMap::iterator iter = mActors.begin(); iter != mActors.end(); ++iter)
+        {
+            mActorList.push_back(iter->first);
+            positions.push_back(iter->first.getRefData().getPosition().asVec3());
+        }
+
+        mActorGrid.build(positions);
+    }
+
+    void Actors::clearActorGrid()
+    {
+        mActorGrid.clear();
+        mActorList.clear();
+    }
+
     void Actors::getObjectsInRange(const osg::Vec3f& position, float radius, std::vector<MWWorld::Ptr>& out)
     {
+        if (mActorGrid.isValid())
+        {
+            std::vector<size_t> indices;
+            mActorGrid.query(position, radius, indices);
+            for (std::vector<size_t>::const_iterator it = indices.begin(); it != indices.end(); ++it)
+                out.push_back(mActorList[*it]);
+            return;
+        }
+
         for (PtrActorMap::iterator iter = mActors.begin(); iter != mActors.end(); ++iter)
         {
             if ((iter->first.getRefData().getPosition().asVec3() - position).length2() <= radius*radius)
@@ -1572,6 +1814,8 @@ namespace MWMechanics
 
     void Actors::clear()
     {
+        clearActorGrid();
+
         PtrActorMap::iterator it(mActors.begin());
         for (; it != mActors.end(); ++it)
         {
@@ -1585,7 +1829,7 @@ namespace MWMechanics
     void Actors::updateMagicEffects(const MWWorld::Ptr &ptr)
     {
         adjustMagicEffects(ptr);
-        calculateCreatureStatModifiers(ptr, 0.f);
+        calculateCreatureStatModifiers(ptr, 0.f, StatSettings());
         if (ptr.getClass().isNpc())
             calculateNpcStatModifiers(ptr, 0.f);
     }
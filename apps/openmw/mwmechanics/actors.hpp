@@ -7,9 +7,13 @@
 #include <map>
 #include <list>
 
+#include <osg/ref_ptr>
+
 #include "../mwbase/world.hpp"
 
 #include "movement.hpp"
+#include "stat.hpp"
+#include "actorgrid.hpp"
 
 namespace MWWorld
 {
@@ -17,6 +21,11 @@ namespace MWWorld
     class CellStore;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWMechanics
 {
     class Actor;
@@ -30,12 +39,54 @@ namespace MWMechanics
 
             void adjustMagicEffects (const MWWorld::Ptr& creature);
 
-            void calculateDynamicStats (const MWWorld::Ptr& ptr);
+            /// Game settings and the player, looked up on the main thread, so stats can be calculated on worker
+            /// threads without going through the World.
+            struct StatSettings
+            {
+                StatSettings();
+
+                MWWorld::Ptr mPlayer;
+                float mPCbaseMagickaMult;
+                float mNPCbaseMagickaMult;
+                float mFatigueReturnBase;
+                float mFatigueReturnMult;
+            };
 
-            void calculateCreatureStatModifiers (const MWWorld::Ptr& ptr, float duration);
+            void calculateDynamicStats (const MWWorld::Ptr& ptr, const StatSettings& settings);
+
+            void calculateCreatureStatModifiers (const MWWorld::Ptr& ptr, float duration, const StatSettings& settings);
             void calculateNpcStatModifiers (const MWWorld::Ptr& ptr, float duration);
 
-            void calculateRestoration (const MWWorld::Ptr& ptr, float duration);
+            void applyMagicEffectTicks (const MWWorld::Ptr& ptr, float duration);
+            ///< Apply tickable and instant magic effects. May affect other objects and the world.
+
+            bool calculateStatModifiers (const MWWorld::Ptr& ptr, const StatSettings& settings, DynamicStat<float>& health);
+            ///< Apply the modifiers of the actor's magic effects to its attributes, dynamic stats and AI settings.
+            /// Only touches the stats of \a ptr, so it may run on a worker thread.
+            /// \return Was the health set? If not, the new health would kill the actor and is returned
+            /// in \a health instead, since dying involves the world.
+
+            void applyStatModifierEffects (const MWWorld::Ptr& ptr, bool wasDead);
+            ///< Handle the consequences of changed stats and magic effects (death by magic, calm, bound items,
+            /// summoned creatures). May affect other objects and the world.
+
+            typedef std::vector<std::pair<MWWorld::Ptr, DynamicStat<float> > > HealthList;
+
+            bool updateActorStats (float duration, const StatSettings& settings);
+            ///< Update magic effects and stats of all living actors, with the stat modifiers calculated on worker
+            /// threads. Ticks the magic effects of all actors before any AI runs.
+            /// \return false if the update was aborted, because a magic effect changed the cell.
+
+            void updateStatModifiers (size_t begin, size_t end, float duration, const StatSettings& settings,
+                HealthList& fatalHealth);
+            ///< Calculate stat modifiers and fatigue restoration of the actors in [\a begin, \a end) of mStatActors.
+            /// May run on a worker thread. Health changes that would kill an actor are added to \a fatalHealth.
+
+            friend class StatModifierUpdate;
+
+            void calculateRestoration (const MWWorld::Ptr& ptr, float duration, const StatSettings& settings);
+
+            void updateActor (const MWWorld::Ptr& ptr, float duration, const StatSettings& settings);
 
             void updateDrowning (const MWWorld::Ptr& ptr, float duration);
 
@@ -47,6 +98,11 @@ namespace MWMechanics
 
             void purgeSpellEffects (int casterActorId);
 
+            void buildActorGrid();
+            ///< Index the positions of all actors for proximity queries during the AI update.
+
+            void clearActorGrid();
+
         public:
 
             Actors();
@@ -93,6 +149,9 @@ namespace MWMechanics
             void updateHeadTracking(const MWWorld::Ptr& actor, const MWWorld::Ptr& targetActor,
                                             MWWorld::Ptr& headTrackTarget, float& sqrHeadTrackDistance);
 
+            float getMaxHeadTrackDistance(const MWWorld::Ptr& actor) const;
+            ///< Distance up to which \a actor may track other actors with its head.
+
             void rest(bool sleep);
             ///< Update actors while the player is waiting or sleeping. This should be called every hour.
 
@@ -144,6 +203,14 @@ namespace MWMechanics
     private:
         PtrActorMap mActors;
 
+        // Actors in the order of mActors and their spatial index, only valid during the AI update
+        std::vector<MWWorld::Ptr> mActorList;
+        ActorGrid mActorGrid;
+
+        // Living actors whose stats are being updated, only valid during the stats update
+        std::vector<MWWorld::Ptr> mStatActors;
+        osg::ref_ptr<SceneUtil::WorkQueue> mStatsQueue;
+
     };
 }
 
@@ -18,6 +18,7 @@
 #include "steering.hpp"
 #include "actorutil.hpp"
 #include "coordinateconverter.hpp"
+#include "exteriorpathgrid.hpp"
 
 MWMechanics::AiPackage::~AiPackage() {}
 
@@ -51,7 +52,7 @@ bool MWMechanics::AiPackage::getRepeat() const
     return false;
 }
 
-MWMechanics::AiPackage::AiPackage() : mTimer(0.26f) { //mTimer starts at .26 to force initial pathbuild
+MWMechanics::AiPackage::AiPackage() : mTimer(0.26f), mPrevCell(NULL) { //mTimer starts at .26 to force initial pathbuild
 
 }
 
@@ -81,8 +82,20 @@ bool MWMechanics::AiPackage::pathTo(const MWWorld::Ptr& actor, ESM::Pathgrid::Po
     {
         const ESM::Cell *cell = actor.getCell()->getCell();       
         if (doesPathNeedRecalc(dest, cell)) { //Only rebuild path if it's moved
-            mPathFinder.buildSyncedPath(pos.pos, dest, actor.getCell(), true); //Rebuild path, in case the target has moved
+            // A destination in another exterior cell is approached through the portals between the
+            // pathgrids of the cells on the way. The path is rebuilt in each cell the actor enters.
+            ESM::Pathgrid::Point waypoint;
+            if (cell->isExterior() && MWBase::Environment::get().getWorld()->getExteriorPathgridGraph()
+                    .getNextWaypoint(PathFinder::MakePathgridPoint(pos), dest, waypoint))
+            {
+                mPathFinder.buildSyncedPath(pos.pos, waypoint, actor.getCell(), true);
+                if (mPathFinder.getPath().empty() || distance(waypoint, mPathFinder.getPath().back()) > 100)
+                    mPathFinder.addPointToPath(waypoint);
+            }
+            else
+                mPathFinder.buildSyncedPath(pos.pos, dest, actor.getCell(), true); //Rebuild path, in case the target has moved
             mPrevDest = dest;
+            mPrevCell = cell;
         }
 
         if(!mPathFinder.getPath().empty()) //Path has points in it
@@ -140,7 +153,7 @@ void MWMechanics::AiPackage::evadeObstacles(const MWWorld::Ptr& actor, float dur
 
 bool MWMechanics::AiPackage::doesPathNeedRecalc(ESM::Pathgrid::Point dest, const ESM::Cell *cell)
 {
-    return mPathFinder.getPath().empty() || (distance(mPrevDest, dest) > 10);
+    return mPathFinder.getPath().empty() || (distance(mPrevDest, dest) > 10) || cell != mPrevCell;
 }
 
 bool MWMechanics::AiPackage::isTargetMagicallyHidden(const MWWorld::Ptr& target)
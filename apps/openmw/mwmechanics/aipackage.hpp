@@ -109,6 +109,7 @@ namespace MWMechanics
             float mTimer;
 
             ESM::Pathgrid::Point mPrevDest;
+            const ESM::Cell* mPrevCell; // cell the path was built in
 
         private:
             bool isNearInactiveCell(const ESM::Position& actorPos);
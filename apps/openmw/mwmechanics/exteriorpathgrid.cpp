@@ -0,0 +1,285 @@
+#include "exteriorpathgrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+
+#include <components/esm/loadcell.hpp>
+#include <components/esm/loadland.hpp>
+
+#include "../mwworld/esmstore.hpp"
+
+#include "pathfinding.hpp"
+
+namespace
+{
+    // Pathgrid points within this distance of a cell border are candidates for a portal
+    const float sPortalRange = 1024.f;
+
+    // Longest connection made between the points of two neighbouring pathgrids. Roughly the
+    // spacing of the points within a pathgrid, so that portals do not cut through terrain that
+    // the pathgrids go around.
+    const float sMaxPortalLength = 1024.f;
+
+    // A route may lead this many cells beyond the bounding box of the start and end cells. Limits the
+    // search for destinations that can not be reached, which would otherwise cover all connected cells.
+    const int sSearchMargin = 2;
+
+    ESM::Pathgrid::Point toWorld(const ESM::Pathgrid::Point& point, const std::pair<int, int>& cell)
+    {
+        return ESM::Pathgrid::Point(point.mX + cell.first * ESM::Land::REAL_SIZE,
+                                    point.mY + cell.second * ESM::Land::REAL_SIZE, point.mZ);
+    }
+}
+
+namespace MWMechanics
+{
+    ExteriorPathgridGraph::ExteriorPathgridGraph(const MWWorld::ESMStore& store)
+    {
+        const MWWorld::Store<ESM::Pathgrid>& pathgrids = store.get<ESM::Pathgrid>();
+        const MWWorld::Store<ESM::Cell>& cells = store.get<ESM::Cell>();
+
+        for (MWWorld::Store<ESM::Cell>::iterator it = cells.extBegin(); it != cells.extEnd(); ++it)
+        {
+            const ESM::Pathgrid* pathgrid = pathgrids.search(*it);
+            if (!pathgrid || pathgrid->mPoints.empty())
+                continue;
+
+            Cell& cell = mCells[CellIndex(it->mData.mX, it->mData.mY)];
+            cell.mCell = &*it;
+            cell.mPathgrid = pathgrid;
+        }
+
+        PortalIndex index;
+        for (CellMap::const_iterator it = mCells.begin(); it != mCells.end(); ++it)
+        {
+            connectCells(index, it->first, CellIndex(it->first.first + 1, it->first.second));
+            connectCells(index, it->first, CellIndex(it->first.first, it->first.second + 1));
+        }
+    }
+
+    const PathgridGraph& ExteriorPathgridGraph::Cell::getGraph() const
+    {
+        mGraph.load(mCell, mPathgrid); // does nothing once the graph is built
+        return mGraph;
+    }
+
+    int ExteriorPathgridGraph::getPortal(PortalIndex& index, const CellIndex& cell, int gridPoint)
+    {
+        std::pair<PortalIndex::iterator, bool> inserted =
+            index.insert(std::make_pair(std::make_pair(cell, gridPoint), static_cast<int>(mPortals.size())));
+        if (inserted.second)
+        {
+            Cell& owner = mCells[cell];
+
+            Portal portal;
+            portal.mCell = cell;
+            portal.mGridPoint = gridPoint;
+            portal.mPosition = toWorld(owner.mPathgrid->mPoints[gridPoint], cell);
+            mPortals.push_back(portal);
+
+            owner.mPortals.push_back(inserted.first->second);
+        }
+        return inserted.first->second;
+    }
+
+    void ExteriorPathgridGraph::addEdge(int from, int to, float cost)
+    {
+        std::vector<Edge>& edges = mPortals[from].mEdges;
+        for (std::vector<Edge>::const_iterator it = edges.begin(); it != edges.end(); ++it)
+        {
+            if (it->mPortal == to)
+                return;
+        }
+
+        Edge edge;
+        edge.mPortal = to;
+        edge.mCost = cost;
+        edges.push_back(edge);
+    }
+
+    /*
+     * second is the neighbour of first in +x or +y direction. Each point of either
+     * cell near the shared border is joined to the closest point on the other side,
+     * if that one is not too far away.
+     */
+    void ExteriorPathgridGraph::connectCells(PortalIndex& index, const CellIndex& first, const CellIndex& second)
+    {
+        CellMap::const_iterator secondCell = mCells.find(second);
+        if (secondCell == mCells.end())
+            return;
+        const ESM::Pathgrid* grids[2] = { mCells[first].mPathgrid, secondCell->second.mPathgrid };
+        const CellIndex indexes[2] = { first, second };
+
+        const bool alongX = second.first != first.first;
+        const float border = static_cast<float>((alongX ? second.first : second.second) * ESM::Land::REAL_SIZE);
+
+        for (int side = 0; side < 2; ++side)
+        {
+            const ESM::Pathgrid* grid = grids[side];
+            const ESM::Pathgrid* otherGrid = grids[1 - side];
+
+            for (int i = 0; i < static_cast<int>(grid->mPoints.size()); ++i)
+            {
+                ESM::Pathgrid::Point point = toWorld(grid->mPoints[i], indexes[side]);
+                if (std::abs((alongX ? point.mX : point.mY) - border) > sPortalRange)
+                    continue;
+
+                int closest = -1;
+                float closestDistance = sMaxPortalLength;
+                for (int j = 0; j < static_cast<int>(otherGrid->mPoints.size()); ++j)
+                {
+                    float dist = distance(point, toWorld(otherGrid->mPoints[j], indexes[1 - side]));
+                    if (dist <= closestDistance)
+                    {
+                        closest = j;
+                        closestDistance = dist;
+                    }
+                }
+
+                if (closest == -1)
+                    continue;
+
+                int portal = getPortal(index, indexes[side], i);
+                int otherPortal = getPortal(index, indexes[1 - side], closest);
+                addEdge(portal, otherPortal, closestDistance);
+                addEdge(otherPortal, portal, closestDistance);
+            }
+        }
+    }
+
+    const ExteriorPathgridGraph::Cell* ExteriorPathgridGraph::findCell(const ESM::Pathgrid::Point& point,
+                                                                       CellIndex& index) const
+    {
+        index.first = static_cast<int>(std::floor(static_cast<float>(point.mX) / ESM::Land::REAL_SIZE));
+        index.second = static_cast<int>(std::floor(static_cast<float>(point.mY) / ESM::Land::REAL_SIZE));
+
+        CellMap::const_iterator it = mCells.find(index);
+        return it != mCells.end() ? &it->second : NULL;
+    }
+
+    void ExteriorPathgridGraph::relax(int from, int to, float cost, float estimate) const
+    {
+        const float gScore = (from == -1 ? 0.f : mGScore[from]) + cost;
+        if (mClosed[to] || gScore >= mGScore[to])
+            return;
+
+        if (mGScore[to] == std::numeric_limits<float>::max())
+            mTouched.push_back(to);
+        mGScore[to] = gScore;
+        mParent[to] = from;
+        mOpenSet.push_back(OpenEntry(gScore + estimate, to));
+        std::push_heap(mOpenSet.begin(), mOpenSet.end(), std::greater<OpenEntry>());
+    }
+
+    bool ExteriorPathgridGraph::getNextWaypoint(const ESM::Pathgrid::Point& start, const ESM::Pathgrid::Point& end,
+                                                ESM::Pathgrid::Point& waypoint) const
+    {
+        CellIndex startIndex;
+        CellIndex endIndex;
+        const Cell* startCell = findCell(start, startIndex);
+        const Cell* endCell = findCell(end, endIndex);
+        if (!startCell || !endCell || startIndex == endIndex
+                || startCell->mPortals.empty() || endCell->mPortals.empty())
+            return false;
+
+        const int startPoint = PathFinder::GetClosestPoint(startCell->mPathgrid,
+            osg::Vec3f(static_cast<float>(start.mX - startIndex.first * ESM::Land::REAL_SIZE),
+                       static_cast<float>(start.mY - startIndex.second * ESM::Land::REAL_SIZE),
+                       static_cast<float>(start.mZ)));
+        const int endPoint = PathFinder::GetClosestPoint(endCell->mPathgrid,
+            osg::Vec3f(static_cast<float>(end.mX - endIndex.first * ESM::Land::REAL_SIZE),
+                       static_cast<float>(end.mY - endIndex.second * ESM::Land::REAL_SIZE),
+                       static_cast<float>(end.mZ)));
+
+        const int goal = static_cast<int>(mPortals.size());
+        if (mGScore.empty())
+        {
+            mGScore.assign(goal + 1, std::numeric_limits<float>::max());
+            mParent.assign(goal + 1, -1);
+            mClosed.assign(goal + 1, 0);
+        }
+
+        const int minX = std::min(startIndex.first, endIndex.first) - sSearchMargin;
+        const int maxX = std::max(startIndex.first, endIndex.first) + sSearchMargin;
+        const int minY = std::min(startIndex.second, endIndex.second) - sSearchMargin;
+        const int maxY = std::max(startIndex.second, endIndex.second) + sSearchMargin;
+
+        const PathgridGraph& startGraph = startCell->getGraph();
+        for (std::vector<int>::const_iterator it = startCell->mPortals.begin(); it != startCell->mPortals.end(); ++it)
+        {
+            if (!startGraph.isPointConnected(startPoint, mPortals[*it].mGridPoint))
+                continue;
+
+            relax(-1, *it, distance(start, mPortals[*it].mPosition), distance(mPortals[*it].mPosition, end));
+        }
+
+        // A* over the portals; the estimate is the straight distance to the end, as are the costs
+        while (!mOpenSet.empty())
+        {
+            std::pop_heap(mOpenSet.begin(), mOpenSet.end(), std::greater<OpenEntry>());
+            const int current = mOpenSet.back().second;
+            mOpenSet.pop_back();
+
+            if (mClosed[current])
+                continue;
+            mClosed[current] = 1;
+
+            if (current == goal)
+                break;
+
+            const Portal& portal = mPortals[current];
+            const Cell& cell = mCells.find(portal.mCell)->second;
+            const PathgridGraph& graph = cell.getGraph();
+
+            // portals of the end cell that lead to the end point are joined to the goal
+            if (portal.mCell == endIndex && graph.isPointConnected(portal.mGridPoint, endPoint))
+                relax(current, goal, distance(portal.mPosition, end), 0.f);
+
+            // Portals of the same cell are connected if the pathgrid connects them. The cost is only an
+            // estimate, the actual path is found when the actor is in that cell.
+            for (std::vector<int>::const_iterator it = cell.mPortals.begin(); it != cell.mPortals.end(); ++it)
+            {
+                if (*it != current && !mClosed[*it] && graph.isPointConnected(portal.mGridPoint, mPortals[*it].mGridPoint))
+                    relax(current, *it, distance(portal.mPosition, mPortals[*it].mPosition),
+                          distance(mPortals[*it].mPosition, end));
+            }
+
+            for (std::vector<Edge>::const_iterator it = portal.mEdges.begin(); it != portal.mEdges.end(); ++it)
+            {
+                const CellIndex& next = mPortals[it->mPortal].mCell;
+                if (next.first < minX || next.first > maxX || next.second < minY || next.second > maxY)
+                    continue;
+
+                relax(current, it->mPortal, it->mCost, distance(mPortals[it->mPortal].mPosition, end));
+            }
+        }
+        mOpenSet.clear();
+
+        // the first portal on the route that is outside the start cell
+        int next = -1;
+        if (mClosed[goal])
+        {
+            for (int portal = mParent[goal]; portal != -1; portal = mParent[portal])
+            {
+                if (mPortals[portal].mCell != startIndex)
+                    next = portal;
+            }
+        }
+
+        for (std::vector<int>::const_iterator it = mTouched.begin(); it != mTouched.end(); ++it)
+        {
+            mGScore[*it] = std::numeric_limits<float>::max();
+            mParent[*it] = -1;
+            mClosed[*it] = 0;
+        }
+        mTouched.clear();
+
+        if (next == -1)
+            return false;
+
+        waypoint = mPortals[next].mPosition;
+        return true;
+    }
+}
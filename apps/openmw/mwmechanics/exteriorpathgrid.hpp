@@ -0,0 +1,102 @@
+#ifndef GAME_MWMECHANICS_EXTERIORPATHGRID_H
+#define GAME_MWMECHANICS_EXTERIORPATHGRID_H
+
+#include <map>
+#include <vector>
+
+#include <components/esm/loadpgrd.hpp>
+
+#include "pathgrid.hpp"
+
+namespace MWWorld
+{
+    class ESMStore;
+}
+
+namespace MWMechanics
+{
+    /// \brief Routes between the pathgrids of different exterior cells
+    ///
+    /// Pathgrids do not have edges across cell borders. Points of neighbouring cells that lie close
+    /// to each other at the shared border are joined as portals, and the portals of a cell are
+    /// joined with each other where the cell's own pathgrid connects them. A route is searched over
+    /// the portals only; the path inside each cell is left to PathFinder once the actor gets there.
+    ///
+    /// The pathgrid graph of a cell is only built once a search reaches the cell.
+    class ExteriorPathgridGraph
+    {
+        public:
+            /// Builds the portals from all exterior pathgrids in \a store.
+            ExteriorPathgridGraph(const MWWorld::ESMStore& store);
+
+            /// Find the next point to head for on the way from \a start to \a end (world co-ordinates).
+            ///
+            /// \a waypoint is a portal point in a neighbouring cell of the start. Its counterpart in the
+            /// start cell is reachable from the pathgrid point closest to \a start.
+            ///
+            /// \return false if both points lie in the same cell, either cell has no pathgrid, or the
+            /// pathgrids do not connect the two points within a few cells around the start and end cells
+            bool getNextWaypoint(const ESM::Pathgrid::Point& start, const ESM::Pathgrid::Point& end,
+                                 ESM::Pathgrid::Point& waypoint) const;
+
+        private:
+            typedef std::pair<int, int> CellIndex;
+
+            struct Edge
+            {
+                int mPortal;
+                float mCost;
+            };
+
+            struct Portal
+            {
+                CellIndex mCell;
+                int mGridPoint; // index in the pathgrid of the cell
+                ESM::Pathgrid::Point mPosition; // world co-ordinates
+                std::vector<Edge> mEdges; // to portals of neighbouring cells
+            };
+
+            struct Cell
+            {
+                Cell() : mCell(NULL), mPathgrid(NULL) {}
+
+                const ESM::Cell *mCell;
+                const ESM::Pathgrid *mPathgrid;
+                std::vector<int> mPortals;
+
+                /// The pathgrid graph of the cell, built on first use.
+                const PathgridGraph& getGraph() const;
+
+            private:
+                mutable PathgridGraph mGraph;
+            };
+
+            typedef std::map<CellIndex, Cell> CellMap;
+            CellMap mCells;
+
+            std::vector<Portal> mPortals;
+
+            // portal of each (cell, pathgrid point), only needed while building
+            typedef std::map<std::pair<CellIndex, int>, int> PortalIndex;
+
+            int getPortal(PortalIndex& index, const CellIndex& cell, int gridPoint);
+            void addEdge(int from, int to, float cost);
+            void connectCells(PortalIndex& index, const CellIndex& first, const CellIndex& second);
+
+            const Cell* findCell(const ESM::Pathgrid::Point& point, CellIndex& index) const;
+
+            typedef std::pair<float, int> OpenEntry; // fScore, portal
+
+            // update the cost of reaching \a to, if going there from \a from (-1 for the start) is cheaper
+            void relax(int from, int to, float cost, float estimate) const;
+
+            // scratch space of the search, indexed by portal; the goal is the extra last entry
+            mutable std::vector<float> mGScore;
+            mutable std::vector<int> mParent;
+            mutable std::vector<char> mClosed;
+            mutable std::vector<int> mTouched; // entries to reset after the search
+            mutable std::vector<OpenEntry> mOpenSet; // binary heap ordered by fScore, lowest first
+    };
+}
+
+#endif
@@ -204,10 +204,10 @@ namespace MWMechanics
         }
         else
         {
-            mPath = mCell->aStarSearch(startNode, endNode.first);
+            mCell->aStarSearch(startNode, endNode.first, mPath);
 
             // convert supplied path to world co-ordinates
-            for (std::list<ESM::Pathgrid::Point>::iterator iter(mPath.begin()); iter != mPath.end(); ++iter)
+            for (std::vector<ESM::Pathgrid::Point>::iterator iter(mPath.begin()); iter != mPath.end(); ++iter)
             {
                 converter.toWorld(*iter);
             }
@@ -251,7 +251,7 @@ namespace MWMechanics
         const ESM::Pathgrid::Point& nextPoint = *mPath.begin();
         if (sqrDistanceIgnoreZ(nextPoint, x, y) < tolerance*tolerance)
         {
-            mPath.pop_front();
+            mPath.erase(mPath.begin());
             if(mPath.empty())
             {
                 return true;
@@ -281,12 +281,12 @@ namespace MWMechanics
             {
                 // if 2nd waypoint of new path == 1st waypoint of old, 
                 // delete 1st waypoint of new path.
-                std::list<ESM::Pathgrid::Point>::iterator iter = ++mPath.begin();
-                if (iter->mX == oldStart.mX
-                    && iter->mY == oldStart.mY
-                    && iter->mZ == oldStart.mZ)
+                const ESM::Pathgrid::Point& second = mPath[1];
+                if (second.mX == oldStart.mX
+                    && second.mY == oldStart.mY
+                    && second.mZ == oldStart.mZ)
                 {
-                    mPath.pop_front();
+                    mPath.erase(mPath.begin());
                 }
             }
         }
@@ -1,7 +1,7 @@
 #ifndef GAME_MWMECHANICS_PATHFINDING_H
 #define GAME_MWMECHANICS_PATHFINDING_H
 
-#include <list>
+#include <vector>
 #include <cassert>
 
 #include <components/esm/defs.hpp>
@@ -55,7 +55,7 @@ namespace MWMechanics
                 return mPath.size();
             }
 
-            const std::list<ESM::Pathgrid::Point>& getPath() const
+            const std::vector<ESM::Pathgrid::Point>& getPath() const
             {
                 return mPath;
             }
@@ -133,7 +133,7 @@ namespace MWMechanics
             void buildPath(const ESM::Pathgrid::Point &startPoint, const ESM::Pathgrid::Point &endPoint,
                 const MWWorld::CellStore* cell, bool allowShortcuts = true);
 
-            std::list<ESM::Pathgrid::Point> mPath;
+            std::vector<ESM::Pathgrid::Point> mPath;
 
             const ESM::Pathgrid *mPathgrid;
             const MWWorld::CellStore* mCell;
@@ -1,5 +1,7 @@
 #include "pathgrid.hpp"
 
+#include <algorithm>
+
 #include "../mwbase/world.hpp"
 #include "../mwbase/environment.hpp"
 
@@ -45,6 +47,70 @@ namespace
         //return distance(a, b);
         return manhattan(a, b);
     }
+
+    // Number of found paths each graph remembers. Guards and combatants tend to
+    // plan between the same few points over and over.
+    const size_t sMaxCachedPaths = 64;
+
+    /*
+     * The open set of aStarSearch is a binary min-heap of point indexes,
+     * ordered by fScore. pos[v] is the position of point v in the heap, or -1,
+     * so that membership tests and cost updates do not need to search it.
+     */
+    void heapSwap(std::vector<int>& heap, std::vector<int>& pos, size_t i, size_t j)
+    {
+        std::swap(heap[i], heap[j]);
+        pos[heap[i]] = static_cast<int>(i);
+        pos[heap[j]] = static_cast<int>(j);
+    }
+
+    void heapSiftUp(std::vector<int>& heap, std::vector<int>& pos, const std::vector<float>& fScore, size_t i)
+    {
+        while(i > 0)
+        {
+            size_t parent = (i - 1) / 2;
+            if(fScore[heap[parent]] <= fScore[heap[i]])
+                break;
+            heapSwap(heap, pos, i, parent);
+            i = parent;
+        }
+    }
+
+    void heapSiftDown(std::vector<int>& heap, std::vector<int>& pos, const std::vector<float>& fScore, size_t i)
+    {
+        while(true)
+        {
+            size_t smallest = i;
+            size_t left = 2 * i + 1;
+            size_t right = left + 1;
+            if(left < heap.size() && fScore[heap[left]] < fScore[heap[smallest]])
+                smallest = left;
+            if(right < heap.size() && fScore[heap[right]] < fScore[heap[smallest]])
+                smallest = right;
+            if(smallest == i)
+                break;
+            heapSwap(heap, pos, i, smallest);
+            i = smallest;
+        }
+    }
+
+    void heapPush(std::vector<int>& heap, std::vector<int>& pos, const std::vector<float>& fScore, int v)
+    {
+        heap.push_back(v);
+        pos[v] = static_cast<int>(heap.size() - 1);
+        heapSiftUp(heap, pos, fScore, heap.size() - 1);
+    }
+
+    int heapPop(std::vector<int>& heap, std::vector<int>& pos, const std::vector<float>& fScore)
+    {
+        int top = heap.front();
+        heapSwap(heap, pos, 0, heap.size() - 1);
+        heap.pop_back();
+        pos[top] = -1;
+        if(!heap.empty())
+            heapSiftDown(heap, pos, fScore, 0);
+        return top;
+    }
 }
 
 namespace MWMechanics
@@ -60,6 +126,35 @@ namespace MWMechanics
     {
     }
 
+    PathgridGraph::PathgridGraph(const PathgridGraph& other)
+        : mCell(other.mCell)
+        , mPathgrid(other.mPathgrid)
+        , mIsExterior(other.mIsExterior)
+        , mGraph(other.mGraph)
+        , mIsGraphConstructed(other.mIsGraphConstructed)
+        , mSCCId(other.mSCCId)
+        , mSCCIndex(other.mSCCIndex)
+    {
+    }
+
+    PathgridGraph& PathgridGraph::operator=(const PathgridGraph& other)
+    {
+        if (this == &other)
+            return *this;
+
+        mCell = other.mCell;
+        mPathgrid = other.mPathgrid;
+        mIsExterior = other.mIsExterior;
+        mGraph = other.mGraph;
+        mIsGraphConstructed = other.mIsGraphConstructed;
+        mSCCId = other.mSCCId;
+        mSCCIndex = other.mSCCIndex;
+
+        mPathCache.clear();
+        mPathCacheIndex.clear();
+        return *this;
+    }
+
     /*
      * mGraph is populated with the cost of each allowed edge.
      *
@@ -104,12 +199,24 @@ namespace MWMechanics
         if(mIsGraphConstructed)
             return true;
 
-        mCell = cell->getCell();
-        mIsExterior = cell->getCell()->isExterior();
-        mPathgrid = MWBase::Environment::get().getWorld()->getStore().get<ESM::Pathgrid>().search(*cell->getCell());
-        if(!mPathgrid)
+        return load(cell->getCell(),
+            MWBase::Environment::get().getWorld()->getStore().get<ESM::Pathgrid>().search(*cell->getCell()));
+    }
+
+    bool PathgridGraph::load(const ESM::Cell *cell, const ESM::Pathgrid *pathgrid)
+    {
+        if(!cell || !pathgrid)
             return false;
 
+        if(mIsGraphConstructed)
+            return true;
+
+        mCell = cell;
+        mIsExterior = cell->isExterior();
+        mPathgrid = pathgrid;
+
+        mPathCache.clear();
+        mPathCacheIndex.clear();
 
         mGraph.resize(mPathgrid->mPoints.size());
         for(int i = 0; i < static_cast<int> (mPathgrid->mEdges.size()); i++)
@@ -214,6 +321,45 @@ namespace MWMechanics
         return (mGraph[start].componentId == mGraph[end].componentId);
     }
 
+    /*
+     * Paths found by search() are remembered for the most recently used
+     * start/goal pairs. The cache is in pathgrid point form (local
+     * co-ordinates), and is only valid as long as the pathgrid does not
+     * change, i.e. until the graph is loaded again.
+     */
+    void PathgridGraph::aStarSearch(const int start, const int goal,
+                                    std::vector<ESM::Pathgrid::Point>& path) const
+    {
+        path.clear();
+        if(!isPointConnected(start, goal))
+        {
+            return; // there is no path, return an empty path
+        }
+
+        PathKey key(start, goal);
+        std::map<PathKey, PathCache::iterator>::iterator found = mPathCacheIndex.find(key);
+        if(found != mPathCacheIndex.end())
+        {
+            mPathCache.splice(mPathCache.begin(), mPathCache, found->second);
+            path = found->second->second;
+            return;
+        }
+
+        search(start, goal, path);
+
+        if(mPathCache.size() >= sMaxCachedPaths)
+        {
+            // reuse the least recently used entry
+            mPathCacheIndex.erase(mPathCache.back().first);
+            mPathCache.splice(mPathCache.begin(), mPathCache, --mPathCache.end());
+            mPathCache.front().first = key;
+            mPathCache.front().second = path;
+        }
+        else
+            mPathCache.push_front(std::make_pair(key, path));
+        mPathCacheIndex[key] = mPathCache.begin();
+    }
+
     /*
      * NOTE: Based on buildPath2(), please check git history if interested
      *       Should consider using a 3rd party library version (e.g. boost)
@@ -222,106 +368,84 @@ namespace MWMechanics
      * Uses mGraph which has pre-computed costs for allowed edges.  It is assumed
      * that mGraph is already constructed.
      *
-     * Should be possible to make this MT safe.
+     * Not MT safe, the scratch vectors are shared by all searches on this graph.
      *
-     * Returns path which may be empty.  path contains pathgrid points in local
+     * path may be empty.  path contains pathgrid points in local
      * cell co-ordinates (indoors) or world co-ordinates (external).
      *
      * Input params:
      *   start, goal - pathgrid point indexes (for this cell)
      *
      * Variables:
-     *   openset - point indexes to be traversed, lowest cost at the front
-     *   closedset - point indexes already traversed
-     *   gScore - past accumulated costs vector indexed by point index
-     *   fScore - future estimated costs vector indexed by point index
-     *
-     * TODO: An intersting exercise might be to cache the paths created for a
-     *       start/goal pair.  To cache the results the paths need to be in
-     *       pathgrid points form (currently they are converted to world
-     *       co-ordinates).  Essentially trading speed w/ memory.
+     *   mOpenSet - point indexes to be traversed, binary heap with the lowest fScore at the front
+     *   mClosed - flags of point indexes already traversed
+     *   mGScore - past accumulated costs vector indexed by point index
+     *   mFScore - future estimated costs vector indexed by point index
      */
-    std::list<ESM::Pathgrid::Point> PathgridGraph::aStarSearch(const int start,
-                                                               const int goal) const
+    void PathgridGraph::search(const int start, const int goal,
+                               std::vector<ESM::Pathgrid::Point>& path) const
     {
-        std::list<ESM::Pathgrid::Point> path;
-        if(!isPointConnected(start, goal))
-        {
-            return path; // there is no path, return an empty path
-        }
-
-        int graphSize = static_cast<int> (mGraph.size());
-        std::vector<float> gScore (graphSize, -1);
-        std::vector<float> fScore (graphSize, -1);
-        std::vector<int> graphParent (graphSize, -1);
+        size_t graphSize = mGraph.size();
+        mGScore.assign(graphSize, -1);
+        mFScore.assign(graphSize, -1);
+        mGraphParent.assign(graphSize, -1);
+        mClosed.assign(graphSize, 0);
+        mOpenSetPos.assign(graphSize, -1);
+        mOpenSet.clear();
 
         // gScore & fScore keep costs for each pathgrid point in mPoints
-        gScore[start] = 0;
-        fScore[start] = costAStar(mPathgrid->mPoints[start], mPathgrid->mPoints[goal]);
+        mGScore[start] = 0;
+        mFScore[start] = costAStar(mPathgrid->mPoints[start], mPathgrid->mPoints[goal]);
 
-        std::list<int> openset;
-        std::list<int> closedset;
-        openset.push_back(start);
+        heapPush(mOpenSet, mOpenSetPos, mFScore, start);
 
         int current = -1;
 
-        while(!openset.empty())
+        while(!mOpenSet.empty())
         {
-            current = openset.front(); // front has the lowest cost
-            openset.pop_front();
+            current = heapPop(mOpenSet, mOpenSetPos, mFScore); // lowest cost
 
             if(current == goal)
                 break;
 
-            closedset.push_back(current); // remember we've been here
+            mClosed[current] = 1; // remember we've been here
 
             // check all edges for the current point index
             for(int j = 0; j < static_cast<int> (mGraph[current].edges.size()); j++)
             {
-                if(std::find(closedset.begin(), closedset.end(), mGraph[current].edges[j].index) ==
-                   closedset.end())
+                int dest = mGraph[current].edges[j].index;
+                if(mClosed[dest])
+                    continue; // traversed this edge destination already, try the next edge
+
+                float tentative_g = mGScore[current] + mGraph[current].edges[j].cost;
+                bool isInOpenSet = mOpenSetPos[dest] != -1;
+                if(!isInOpenSet
+                    || tentative_g < mGScore[dest])
                 {
-                    // not in closedset - i.e. have not traversed this edge destination
-                    int dest = mGraph[current].edges[j].index;
-                    float tentative_g = gScore[current] + mGraph[current].edges[j].cost;
-                    bool isInOpenSet = std::find(openset.begin(), openset.end(), dest) != openset.end();
-                    if(!isInOpenSet
-                        || tentative_g < gScore[dest])
-                    {
-                        graphParent[dest] = current;
-                        gScore[dest] = tentative_g;
-                        fScore[dest] = tentative_g + costAStar(mPathgrid->mPoints[dest],
-                                                               mPathgrid->mPoints[goal]);
-                        if(!isInOpenSet)
-                        {
-                            // add this edge to openset, lowest cost goes to the front
-                            // TODO: if this causes performance problems a hash table may help
-                            std::list<int>::iterator it = openset.begin();
-                            for(it = openset.begin(); it!= openset.end(); ++it)
-                            {
-                                if(fScore[*it] > fScore[dest])
-                                    break;
-                            }
-                            openset.insert(it, dest);
-                        }
-                    }
-                } // if in closedset, i.e. traversed this edge already, try the next edge
+                    mGraphParent[dest] = current;
+                    mGScore[dest] = tentative_g;
+                    mFScore[dest] = tentative_g + costAStar(mPathgrid->mPoints[dest],
+                                                            mPathgrid->mPoints[goal]);
+                    if(!isInOpenSet)
+                        heapPush(mOpenSet, mOpenSetPos, mFScore, dest);
+                    else // the cost went down, move it towards the front
+                        heapSiftUp(mOpenSet, mOpenSetPos, mFScore, mOpenSetPos[dest]);
+                }
             }
         }
 
         if(current != goal)
-            return path; // for some reason couldn't build a path
+            return; // for some reason couldn't build a path
 
         // reconstruct path to return, using local co-ordinates
-        while(graphParent[current] != -1)
+        while(mGraphParent[current] != -1)
         {
-            path.push_front(mPathgrid->mPoints[current]);
-            current = graphParent[current];
+            path.push_back(mPathgrid->mPoints[current]);
+            current = mGraphParent[current];
         }
 
         // add first node to path explicitly
-        path.push_front(mPathgrid->mPoints[start]);
-        return path;
+        path.push_back(mPathgrid->mPoints[start]);
+        std::reverse(path.begin(), path.end());
     }
 }
-
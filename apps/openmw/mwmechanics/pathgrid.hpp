@@ -2,6 +2,8 @@
 #define GAME_MWMECHANICS_PATHGRID_H
 
 #include <list>
+#include <map>
+#include <vector>
 
 #include <components/esm/loadpgrd.hpp>
 
@@ -22,19 +24,27 @@ namespace MWMechanics
         public:
             PathgridGraph();
 
+            /// Copies the graph only. The cached paths are not copied, since the cache index refers into
+            /// the list of the original, and neither is the scratch space of the search.
+            PathgridGraph(const PathgridGraph& other);
+            PathgridGraph& operator=(const PathgridGraph& other);
+
             bool load(const MWWorld::CellStore *cell);
 
+            // for cells that are not loaded; the caller looks up the pathgrid
+            bool load(const ESM::Cell *cell, const ESM::Pathgrid *pathgrid);
+
             // returns true if end point is strongly connected (i.e. reachable
             // from start point) both start and end are pathgrid point indexes
             bool isPointConnected(const int start, const int end) const;
 
             // the input parameters are pathgrid point indexes
-            // the output list is in local (internal cells) or world (external
-            // cells) co-ordinates
+            // the output path is in local (internal cells) or world (external
+            // cells) co-ordinates and replaces the contents of path
             //
             // NOTE: if start equals end an empty path is returned
-            std::list<ESM::Pathgrid::Point> aStarSearch(const int start,
-                                                        const int end) const;
+            void aStarSearch(const int start, const int end,
+                             std::vector<ESM::Pathgrid::Point>& path) const;
         private:
 
             const ESM::Cell *mCell;
@@ -74,6 +84,23 @@ namespace MWMechanics
             // methods used to calculate connected components
             void recursiveStrongConnect(int v);
             void buildConnectedPoints();
+
+            void search(const int start, const int goal,
+                        std::vector<ESM::Pathgrid::Point>& path) const;
+
+            // scratch space of the search, indexed by point index
+            mutable std::vector<float> mGScore;
+            mutable std::vector<float> mFScore;
+            mutable std::vector<int> mGraphParent;
+            mutable std::vector<char> mClosed;
+            mutable std::vector<int> mOpenSet; // binary heap ordered by fScore
+            mutable std::vector<int> mOpenSetPos; // heap position of each point, -1 if not in the open set
+
+            // recently found paths, most recently used first
+            typedef std::pair<int, int> PathKey; // start, goal
+            typedef std::list<std::pair<PathKey, std::vector<ESM::Pathgrid::Point> > > PathCache;
+            mutable PathCache mPathCache;
+            mutable std::map<PathKey, PathCache::iterator> mPathCacheIndex;
     };
 }
 
@@ -1,6 +1,7 @@
 #include "physicssystem.hpp"
 
 #include <stdexcept>
+#include <iostream>
 
 #include <osg/Group>
 
@@ -23,6 +24,9 @@
 #include <components/esm/loadgmst.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/unrefqueue.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+#include <components/settings/settings.hpp>
 
 #include <components/nifosg/particle.hpp> // FindRecIndexVisitor
 
@@ -58,6 +62,30 @@ namespace MWPhysics
     // Arbitrary number. To prevent infinite loops. They shouldn't happen but it's good to be prepared.
     static const int sMaxIterations = 8;
 
+    // Number of actors moved by one work item
+    static const size_t sMovementChunkSize = 8;
+
+    /// Input and result of moving one actor in applyQueuedMovement. The input is read from the world on the main
+    /// thread, so the actor can be moved on a worker thread.
+    struct ActorMovement
+    {
+        MWWorld::Ptr mPtr;
+        Actor* mActor;
+        osg::Vec3f mVelocity;
+        float mWaterLevel;
+        float mSlowFall;
+        bool mFlying;
+        float mSwimHeightScale;
+        bool mInStorm;
+        osg::Vec3f mStormDirection;
+        float mStormWalkMult;
+
+        osg::Vec3f mPosition;
+        osg::Vec3f mLastStepPosition; // position before the last step
+        MWWorld::Ptr mStandingOn;
+        bool mClearVerticalMovement; // the vertical component of the actor's movement settings must be reset
+    };
+
     // FIXME: move to a separate file
     class MovementSolver
     {
@@ -234,10 +262,31 @@ namespace MWPhysics
             }
         }
 
-        static osg::Vec3f move(osg::Vec3f position, const MWWorld::Ptr &ptr, Actor* physicActor, const osg::Vec3f &movement, float time,
-                                  bool isFlying, float waterlevel, float slowFall, const btCollisionWorld* collisionWorld,
-                               std::map<MWWorld::Ptr, MWWorld::Ptr>& standingCollisionTracker)
+        /// Move an actor by \a numSteps steps of \a time each.
+        /// @param updateActor Move the actor's collision object after each step, so that actors moved later collide
+        /// with its new position. Otherwise the collision world is only read, and the caller must update the actor.
+        static void moveSteps(ActorMovement& movement, int numSteps, float time, const btCollisionWorld* collisionWorld,
+                              bool updateActor)
+        {
+            for (int i=0; i<numSteps; ++i)
+            {
+                movement.mLastStepPosition = movement.mPosition;
+                movement.mPosition = move(movement.mPosition, movement, time, collisionWorld);
+                if (updateActor)
+                    movement.mActor->setPosition(movement.mPosition);
+            }
+        }
+
+        static osg::Vec3f move(osg::Vec3f position, ActorMovement& actorMovement, float time, const btCollisionWorld* collisionWorld)
         {
+            const MWWorld::Ptr& ptr = actorMovement.mActor->getPtr();
+            Actor* physicActor = actorMovement.mActor;
+            const osg::Vec3f& movement = actorMovement.mVelocity;
+            bool isFlying = actorMovement.mFlying;
+            float waterlevel = actorMovement.mWaterLevel;
+            float slowFall = actorMovement.mSlowFall;
+            MWWorld::Ptr& standingOn = actorMovement.mStandingOn;
+
             const ESM::Position& refpos = ptr.getRefData().getPosition();
             // Early-out for totally static creatures
             // (Not sure if gravity should still apply?)
@@ -263,9 +312,7 @@ namespace MWPhysics
             // While this is strictly speaking wrong, it's needed for MW compatibility.
             position.z() += halfExtents.z();
 
-            static const float fSwimHeightScale = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                    .find("fSwimHeightScale")->getFloat();
-            float swimlevel = waterlevel + halfExtents.z() - (physicActor->getRenderingHalfExtents().z() * 2 * fSwimHeightScale);
+            float swimlevel = waterlevel + halfExtents.z() - (physicActor->getRenderingHalfExtents().z() * 2 * actorMovement.mSwimHeightScale);
 
             ActorTracer tracer;
             osg::Vec3f inertia = physicActor->getInertialForce();
@@ -292,16 +339,15 @@ namespace MWPhysics
             if (movement.z() > 0 && ptr.getClass().getCreatureStats(ptr).isDead() && position.z() < swimlevel)
                 velocity = osg::Vec3f(0,0,1) * 25;
 
-            ptr.getClass().getMovementSettings(ptr).mPosition[2] = 0;
+            // applied by the caller, since the movement settings belong to the mechanics
+            actorMovement.mClearVerticalMovement = true;
 
             // Now that we have the effective movement vector, apply wind forces to it
-            if (MWBase::Environment::get().getWorld()->isInStorm())
+            if (actorMovement.mInStorm)
             {
-                osg::Vec3f stormDirection = MWBase::Environment::get().getWorld()->getStormDirection();
+                const osg::Vec3f& stormDirection = actorMovement.mStormDirection;
                 float angleDegrees = osg::RadiansToDegrees(std::acos(stormDirection * velocity / (stormDirection.length() * velocity.length())));
-                static const float fStromWalkMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                        .find("fStromWalkMult")->getFloat();
-                velocity *= 1.f-(fStromWalkMult * (angleDegrees/180.f));
+                velocity *= 1.f-(actorMovement.mStormWalkMult * (angleDegrees/180.f));
             }
 
             osg::Vec3f origVelocity = velocity;
@@ -407,12 +453,12 @@ namespace MWPhysics
                 if(tracer.mFraction < 1.0f && getSlope(tracer.mPlaneNormal) <= sMaxSlope
                         && tracer.mHitObject->getBroadphaseHandle()->m_collisionFilterGroup != CollisionType_Actor)
                 {
-                    const btCollisionObject* standingOn = tracer.mHitObject;
-                    PtrHolder* ptrHolder = static_cast<PtrHolder*>(standingOn->getUserPointer());
+                    const btCollisionObject* hitObject = tracer.mHitObject;
+                    PtrHolder* ptrHolder = static_cast<PtrHolder*>(hitObject->getUserPointer());
                     if (ptrHolder)
-                        standingCollisionTracker[ptr] = ptrHolder->getPtr();
+                        standingOn = ptrHolder->getPtr();
 
-                    if (standingOn->getBroadphaseHandle()->m_collisionFilterGroup == CollisionType_Water)
+                    if (hitObject->getBroadphaseHandle()->m_collisionFilterGroup == CollisionType_Water)
                         physicActor->setWalkingOnWater(true);
                     if (!isFlying)
                         newPosition.z() = tracer.mEndPos.z() + 1.0f;
@@ -462,6 +508,40 @@ namespace MWPhysics
     };
 
 
+    /// Moves a range of actors on a worker thread
+    class ActorMovementWork : public SceneUtil::WorkItem
+    {
+    public:
+        ActorMovementWork(std::vector<ActorMovement>& movements, size_t begin, size_t end, int numSteps, float time,
+                          const btCollisionWorld* collisionWorld)
+            : mMovements(movements), mBegin(begin), mEnd(end), mNumSteps(numSteps), mTime(time)
+            , mCollisionWorld(collisionWorld)
+        {
+        }
+
+        virtual void doWork()
+        {
+            try
+            {
+                for (size_t i=mBegin; i<mEnd; ++i)
+                    MovementSolver::moveSteps(mMovements[i], mNumSteps, mTime, mCollisionWorld, false);
+            }
+            catch (std::exception& e)
+            {
+                std::cerr << "Failed to move actors: " << e.what() << std::endl;
+            }
+        }
+
+    private:
+        std::vector<ActorMovement>& mMovements;
+        size_t mBegin;
+        size_t mEnd;
+        int mNumSteps;
+        float mTime;
+        const btCollisionWorld* mCollisionWorld;
+    };
+
+
     // ---------------------------------------------------------------
 
     class HeightField
@@ -660,6 +740,10 @@ namespace MWPhysics
         // Don't update AABBs of all objects every frame. Most objects in MW are static, so we don't need this.
         // Should a "static" object ever be moved, we have to update its AABB manually using DynamicsWorld::updateSingleAabb.
         mCollisionWorld->setForceUpdateAllAabbs(false);
+
+        int movementThreads = Settings::Manager::getInt("movement threads", "Physics");
+        if (movementThreads > 0)
+            mMovementWorkQueue = new SceneUtil::WorkQueue(movementThreads);
     }
 
     PhysicsSystem::~PhysicsSystem()
@@ -1305,6 +1389,14 @@ namespace MWPhysics
         }
 
         const MWBase::World *world = MWBase::Environment::get().getWorld();
+        const MWWorld::Store<ESM::GameSetting>& gmst = world->getStore().get<ESM::GameSetting>();
+        static const float fSwimHeightScale = gmst.find("fSwimHeightScale")->getFloat();
+        static const float fStromWalkMult = gmst.find("fStromWalkMult")->getFloat();
+        bool inStorm = world->isInStorm();
+        osg::Vec3f stormDirection = inStorm ? world->getStormDirection() : osg::Vec3f();
+
+        std::vector<ActorMovement> movements;
+        movements.reserve(mMovementQueue.size());
         PtrVelocityList::iterator iter = mMovementQueue.begin();
         for(;iter != mMovementQueue.end();++iter)
         {
@@ -1329,28 +1421,78 @@ namespace MWPhysics
             Actor* physicActor = foundActor->second;
             physicActor->setCanWaterWalk(waterCollision);
 
+            ActorMovement movement;
+            movement.mPtr = iter->first;
+            movement.mActor = physicActor;
+            movement.mVelocity = iter->second;
+            movement.mWaterLevel = waterlevel;
             // Slow fall reduces fall speed by a factor of (effect magnitude / 200)
-            float slowFall = 1.f - std::max(0.f, std::min(1.f, effects.get(ESM::MagicEffect::SlowFall).getMagnitude() * 0.005f));
+            movement.mSlowFall = 1.f - std::max(0.f, std::min(1.f, effects.get(ESM::MagicEffect::SlowFall).getMagnitude() * 0.005f));
+            movement.mFlying = world->isFlying(iter->first);
+            movement.mSwimHeightScale = fSwimHeightScale;
+            movement.mInStorm = inStorm;
+            movement.mStormDirection = stormDirection;
+            movement.mStormWalkMult = fStromWalkMult;
+            movement.mPosition = physicActor->getPosition();
+            movement.mLastStepPosition = movement.mPosition;
+            movement.mClearVerticalMovement = false;
+            movements.push_back(movement);
+        }
 
-            osg::Vec3f position = physicActor->getPosition();
-            float oldHeight = position.z();
-            for (int i=0; i<numSteps; ++i)
+        size_t numMovements = movements.size();
+        bool parallel = mMovementWorkQueue && numSteps > 0 && numMovements >= 2*sMovementChunkSize;
+        if (parallel)
+        {
+            // All actors are moved against the collision world as it was before the movement, and their collision
+            // objects are updated afterwards in queue order. The main thread takes the first chunk itself.
+            std::vector<osg::ref_ptr<ActorMovementWork> > work;
+            for (size_t begin = sMovementChunkSize; begin < numMovements; begin += sMovementChunkSize)
+            {
+                work.push_back(new ActorMovementWork(movements, begin, std::min(begin + sMovementChunkSize, numMovements),
+                                                     numSteps, physicsDt, mCollisionWorld));
+                mMovementWorkQueue->addWorkItem(work.back());
+            }
+
+            osg::ref_ptr<ActorMovementWork> first (new ActorMovementWork(movements, 0, sMovementChunkSize,
+                                                                         numSteps, physicsDt, mCollisionWorld));
+            first->doWork();
+
+            for (std::vector<osg::ref_ptr<ActorMovementWork> >::const_iterator it = work.begin(); it != work.end(); ++it)
+                (*it)->waitTillDone();
+        }
+
+        for (std::vector<ActorMovement>::iterator it = movements.begin(); it != movements.end(); ++it)
+        {
+            Actor* physicActor = it->mActor;
+            float oldHeight = physicActor->getPosition().z();
+
+            if (!parallel)
+                MovementSolver::moveSteps(*it, numSteps, physicsDt, mCollisionWorld, true);
+            else if (numSteps > 0)
             {
-                position = MovementSolver::move(position, physicActor->getPtr(), physicActor, iter->second, physicsDt,
-                                                world->isFlying(iter->first),
-                                                waterlevel, slowFall, mCollisionWorld, mStandingCollisions);
-                physicActor->setPosition(position);
+                // leaves the same previous position as moving step by step
+                physicActor->setPosition(it->mLastStepPosition);
+                physicActor->setPosition(it->mPosition);
             }
 
+            if (it->mClearVerticalMovement)
+            {
+                MWWorld::Ptr ptr = physicActor->getPtr();
+                ptr.getClass().getMovementSettings(ptr).mPosition[2] = 0;
+            }
+
+            if (!it->mStandingOn.isEmpty())
+                mStandingCollisions[physicActor->getPtr()] = it->mStandingOn;
+
             float interpolationFactor = mTimeAccum / physicsDt;
-            osg::Vec3f interpolated = position * interpolationFactor + physicActor->getPreviousPosition() * (1.f - interpolationFactor);
+            osg::Vec3f interpolated = it->mPosition * interpolationFactor + physicActor->getPreviousPosition() * (1.f - interpolationFactor);
 
-            float heightDiff = position.z() - oldHeight;
+            float heightDiff = it->mPosition.z() - oldHeight;
 
             if (heightDiff < 0)
-                iter->first.getClass().getCreatureStats(iter->first).addToFallHeight(-heightDiff);
+                it->mPtr.getClass().getCreatureStats(it->mPtr).addToFallHeight(-heightDiff);
 
-            mMovementResults.push_back(std::make_pair(iter->first, interpolated));
+            mMovementResults.push_back(std::make_pair(it->mPtr, interpolated));
         }
 
         mMovementQueue.clear();
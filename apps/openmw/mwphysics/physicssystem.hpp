@@ -31,6 +31,7 @@ namespace Resource
 namespace SceneUtil
 {
     class UnrefQueue;
+    class WorkQueue;
 }
 
 class btCollisionWorld;
@@ -204,6 +205,9 @@ namespace MWPhysics
             PtrVelocityList mMovementQueue;
             PtrVelocityList mMovementResults;
 
+            // moves actors in parallel, if enabled
+            osg::ref_ptr<SceneUtil::WorkQueue> mMovementWorkQueue;
+
             float mTimeAccum;
 
             float mWaterHeight;
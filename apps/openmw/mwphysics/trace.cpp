@@ -5,6 +5,8 @@
 #include <BulletCollision/CollisionDispatch/btCollisionWorld.h>
 #include <BulletCollision/CollisionShapes/btConvexShape.h>
 #include <BulletCollision/CollisionShapes/btCylinderShape.h>
+#include <BulletCollision/CollisionShapes/btCompoundShape.h>
+#include <LinearMath/btAabbUtil2.h>
 
 #include "collisiontype.hpp"
 #include "actor.hpp"
@@ -49,6 +51,78 @@ protected:
     const btScalar mMinSlopeDot;
 };
 
+/// Tests a convex sweep against the objects found by a broadphase AABB query.
+class SweepCallback : public btBroadphaseAabbCallback
+{
+public:
+    SweepCallback(const btConvexShape* castShape, const btTransform& from, const btTransform& to,
+                  const btVector3& aabbMin, const btVector3& aabbMax, btCollisionWorld::ConvexResultCallback& resultCallback)
+      : mCastShape(castShape), mFrom(from), mTo(to), mAabbMin(aabbMin), mAabbMax(aabbMax), mResultCallback(resultCallback)
+    {
+    }
+
+    virtual bool process(const btBroadphaseProxy* proxy)
+    {
+        // a hit at the start position can not be improved on
+        if (mResultCallback.m_closestHitFraction == btScalar(0))
+            return false;
+
+        if (!mResultCallback.needsCollision(const_cast<btBroadphaseProxy*>(proxy)))
+            return true;
+
+        const btCollisionObject* object = static_cast<const btCollisionObject*>(proxy->m_clientObject);
+        sweepShape(object, object->getCollisionShape(), object->getWorldTransform());
+        return true;
+    }
+
+private:
+    void sweepShape(const btCollisionObject* object, const btCollisionShape* shape, const btTransform& transform)
+    {
+        if (!shape->isCompound())
+        {
+            btCollisionWorld::objectQuerySingle(mCastShape, mFrom, mTo, object, shape, transform, mResultCallback, btScalar(0));
+            return;
+        }
+
+        // Compound shapes are split up here rather than in Bullet, whose handling of them is profiled.
+        // The Bullet profiler is not thread safe.
+        const btCompoundShape* compound = static_cast<const btCompoundShape*>(shape);
+        for (int i = 0; i < compound->getNumChildShapes(); ++i)
+        {
+            const btCollisionShape* child = compound->getChildShape(i);
+            btTransform childTransform = transform * compound->getChildTransform(i);
+
+            btVector3 childMin, childMax;
+            child->getAabb(childTransform, childMin, childMax);
+            if (TestAabbAgainstAabb2(mAabbMin, mAabbMax, childMin, childMax))
+                sweepShape(object, child, childTransform);
+        }
+    }
+
+    const btConvexShape* mCastShape;
+    const btTransform& mFrom;
+    const btTransform& mTo;
+    btVector3 mAabbMin;
+    btVector3 mAabbMax;
+    btCollisionWorld::ConvexResultCallback& mResultCallback;
+};
+
+/// Equivalent to btCollisionWorld::convexSweepTest, but safe to call from several threads at once,
+/// as long as the collision world is not modified in the meantime. (btDbvtBroadphase::rayTest, which
+/// Bullet uses to find the objects along the sweep, shares its traversal stack between all calls.)
+void convexSweepTest(const btConvexShape* castShape, const btTransform& from, const btTransform& to,
+                     const btCollisionWorld* world, btCollisionWorld::ConvexResultCallback& resultCallback)
+{
+    btVector3 aabbMin, aabbMax, toMin, toMax;
+    castShape->getAabb(from, aabbMin, aabbMax);
+    castShape->getAabb(to, toMin, toMax);
+    aabbMin.setMin(toMin);
+    aabbMax.setMax(toMax);
+
+    SweepCallback callback(castShape, from, to, aabbMin, aabbMax, resultCallback);
+    const_cast<btCollisionWorld*>(world)->getBroadphase()->aabbTest(aabbMin, aabbMax, callback);
+}
+
 
 void ActorTracer::doTrace(const btCollisionObject *actor, const osg::Vec3f& start, const osg::Vec3f& end, const btCollisionWorld* world)
 {
@@ -68,8 +142,7 @@ void ActorTracer::doTrace(const btCollisionObject *actor, const osg::Vec3f& star
 
     const btCollisionShape *shape = actor->getCollisionShape();
     assert(shape->isConvex());
-    world->convexSweepTest(static_cast<const btConvexShape*>(shape),
-                                               from, to, newTraceCallback);
+    convexSweepTest(static_cast<const btConvexShape*>(shape), from, to, world, newTraceCallback);
 
     // Copy the hit data over to our trace results struct:
     if(newTraceCallback.hasHit())
@@ -19,6 +19,7 @@ namespace MWPhysics
 
         float mFraction;
 
+        /// Only reads \a world, so traces may run on several threads at once.
         void doTrace(const btCollisionObject *actor, const osg::Vec3f& start, const osg::Vec3f& end, const btCollisionWorld* world);
         void findGround(const Actor* actor, const osg::Vec3f& start, const osg::Vec3f& end, const btCollisionWorld* world);
     };
@@ -134,6 +134,12 @@ public:
 
     virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
     {
+        if (!SceneUtil::Skeleton::animateBones())
+        {
+            traverse(node, nv);
+            return;
+        }
+
         osg::MatrixTransform* transform = static_cast<osg::MatrixTransform*>(node);
         osg::Matrix matrix = transform->getMatrix();
 
@@ -1,6 +1,7 @@
 #include "renderingmanager.hpp"
 
 #include <stdexcept>
+#include <algorithm>
 #include <limits>
 
 #include <osg/Light>
@@ -28,8 +29,11 @@
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/workqueue.hpp>
 #include <components/sceneutil/unrefqueue.hpp>
+#include <components/sceneutil/riggeometry.hpp>
+#include <components/sceneutil/skeleton.hpp>
 
 #include <components/terrain/terraingrid.hpp>
+#include <components/terrain/quadtreeworld.hpp>
 
 #include <components/esm/loadcell.hpp>
 #include <components/fallback/fallback.hpp>
@@ -168,6 +172,18 @@ namespace MWRender
         , mFieldOfViewOverridden(false)
     {
         resourceSystem->getSceneManager()->setParticleSystemMask(MWRender::Mask_ParticleSystem);
+
+        // a queue of its own, so that drawing never waits for the skinning behind a background loading job
+        int skinningThreads = Settings::Manager::getInt("skinning threads", "Video");
+        if (skinningThreads > 0)
+        {
+            mSkinningQueue = new SceneUtil::WorkQueue(skinningThreads);
+            SceneUtil::RigGeometry::setWorkQueue(mSkinningQueue.get());
+        }
+
+        SceneUtil::Skeleton::setLodSettings(Settings::Manager::getFloat("animation lod distance", "Camera"),
+                                            std::max(1, Settings::Manager::getInt("animation lod max interval", "Camera")));
+
         resourceSystem->getSceneManager()->setShaderPath(resourcePath + "/shaders");
         resourceSystem->getSceneManager()->setForceShaders(Settings::Manager::getBool("force shaders", "Shaders"));
         resourceSystem->getSceneManager()->setClampLighting(Settings::Manager::getBool("clamp lighting", "Shaders"));
@@ -197,11 +213,20 @@ namespace MWRender
 
         mWater.reset(new Water(mRootNode, sceneRoot, mResourceSystem, mViewer->getIncrementalCompileOperation(), fallback, resourcePath));
 
-        mTerrain.reset(new Terrain::TerrainGrid(sceneRoot, mResourceSystem, mViewer->getIncrementalCompileOperation(),
-                                                new TerrainStorage(mResourceSystem->getVFS(), Settings::Manager::getString("normal map pattern", "Shaders"), Settings::Manager::getString("normal height map pattern", "Shaders"),
-                                                                   Settings::Manager::getBool("auto use terrain normal maps", "Shaders"),
-                                                     Settings::Manager::getString("terrain specular map pattern", "Shaders"), Settings::Manager::getBool("auto use terrain specular maps", "Shaders")),
-                                                 Mask_Terrain, &mResourceSystem->getSceneManager()->getShaderManager(), mUnrefQueue.get()));
+        TerrainStorage* terrainStorage = new TerrainStorage(mResourceSystem->getVFS(), Settings::Manager::getString("normal map pattern", "Shaders"), Settings::Manager::getString("normal height map pattern", "Shaders"),
+                                                            Settings::Manager::getBool("auto use terrain normal maps", "Shaders"),
+                                                            Settings::Manager::getString("terrain specular map pattern", "Shaders"), Settings::Manager::getBool("auto use terrain specular maps", "Shaders"));
+        if (Settings::Manager::getBool("distant terrain", "Terrain"))
+        {
+            // a queue of its own, so that building distant chunks neither delays nor waits for the cell preloading
+            mTerrainQueue = new SceneUtil::WorkQueue;
+            mTerrain.reset(new Terrain::QuadTreeWorld(sceneRoot, mResourceSystem, mViewer->getIncrementalCompileOperation(), terrainStorage, Mask_Terrain,
+                                                      mTerrainQueue.get(), Settings::Manager::getFloat("lod factor", "Terrain"),
+                                                      &mResourceSystem->getSceneManager()->getShaderManager(), mUnrefQueue.get()));
+        }
+        else
+            mTerrain.reset(new Terrain::TerrainGrid(sceneRoot, mResourceSystem, mViewer->getIncrementalCompileOperation(), terrainStorage,
+                                                    Mask_Terrain, &mResourceSystem->getSceneManager()->getShaderManager(), mUnrefQueue.get()));
 
         mCamera.reset(new Camera(mViewer->getCamera()));
 
@@ -251,6 +276,7 @@ namespace MWRender
         mFirstPersonFieldOfView = Settings::Manager::getFloat("first person field of view", "Camera");
         updateProjectionMatrix();
         mStateUpdater->setFogEnd(mViewDistance);
+        mTerrain->setViewDistance(mViewDistance);
 
         mRootNode->getOrCreateStateSet()->addUniform(new osg::Uniform("near", mNearClip));
         mRootNode->getOrCreateStateSet()->addUniform(new osg::Uniform("far", mViewDistance));
@@ -260,6 +286,12 @@ namespace MWRender
     {
         // let background loading thread finish before we delete anything else
         mWorkQueue = NULL;
+
+        SceneUtil::RigGeometry::setWorkQueue(NULL);
+        mSkinningQueue = NULL;
+
+        // the terrain may still be building chunks
+        mTerrainQueue = NULL;
     }
 
     MWRender::Objects& RenderingManager::getObjects()
@@ -890,6 +922,7 @@ namespace MWRender
             {
                 mViewDistance = Settings::Manager::getFloat("viewing distance", "Camera");
                 mStateUpdater->setFogEnd(mViewDistance);
+                mTerrain->setViewDistance(mViewDistance);
                 updateProjectionMatrix();
             }
             else if (it->first == "General" && (it->second == "texture filter" ||
@@ -2,6 +2,8 @@
 
 #include <osg/MatrixTransform>
 
+#include <components/sceneutil/skeleton.hpp>
+
 namespace MWRender
 {
 
@@ -24,7 +26,7 @@ void RotateController::setRotate(const osg::Quat &rotate)
 
 void RotateController::operator()(osg::Node *node, osg::NodeVisitor *nv)
 {
-    if (!mEnabled)
+    if (!mEnabled || !SceneUtil::Skeleton::animateBones())
     {
         traverse(node, nv);
         return;
@@ -9,7 +9,8 @@ namespace MWRender
 
 /// Applies a rotation in \a relativeTo's space.
 /// @note Assumes that the node being rotated has its "original" orientation set every frame by a different controller.
-/// The rotation is then applied on top of that orientation.
+/// The rotation is then applied on top of that orientation. Like that controller, it leaves the node alone on the
+/// frames a Skeleton above it is not animated.
 /// @note Must be set on a MatrixTransform.
 class RotateController : public osg::NodeCallback
 {
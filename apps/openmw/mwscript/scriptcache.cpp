@@ -0,0 +1,241 @@
+#include "scriptcache.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <components/misc/stringops.hpp>
+
+namespace
+{
+    const uint32_t sMagic = 0x4353574f; // "OWSC"
+    const uint32_t sFormatVersion = 2;
+
+    // upper bound for any length read from the file, to reject corrupted files early
+    const uint32_t sMaxLength = 1 << 24;
+
+    const char sLocalTypes[] = { 's', 'l', 'f' };
+
+    template<typename T>
+    void writeValue (std::ostream& stream, T value)
+    {
+        stream.write (reinterpret_cast<const char *> (&value), sizeof (T));
+    }
+
+    void writeString (std::ostream& stream, const std::string& value)
+    {
+        writeValue (stream, static_cast<uint32_t> (value.size()));
+        stream.write (value.data(), value.size());
+    }
+
+    template<typename T>
+    T readValue (std::istream& stream)
+    {
+        T value;
+        if (!stream.read (reinterpret_cast<char *> (&value), sizeof (T)))
+            throw std::runtime_error ("unexpected end of file");
+        return value;
+    }
+
+    uint32_t readLength (std::istream& stream)
+    {
+        uint32_t length = readValue<uint32_t> (stream);
+        if (length>sMaxLength)
+            throw std::runtime_error ("invalid length");
+        return length;
+    }
+
+    std::string readString (std::istream& stream)
+    {
+        std::string value (readLength (stream), '\0');
+        if (!value.empty() && !stream.read (&value[0], value.size()))
+            throw std::runtime_error ("unexpected end of file");
+        return value;
+    }
+}
+
+namespace MWScript
+{
+    uint64_t ScriptCache::hashSource (const std::string& source)
+    {
+        // 64-bit FNV-1a
+        uint64_t hash = 14695981039346656037ULL;
+
+        for (std::string::const_iterator iter (source.begin()); iter!=source.end(); ++iter)
+        {
+            hash ^= static_cast<unsigned char> (*iter);
+            hash *= 1099511628211ULL;
+        }
+
+        return hash;
+    }
+
+    ScriptCache::ScriptCache() : mEnabled (false), mDirty (false) {}
+
+    void ScriptCache::load (const boost::filesystem::path& path, const std::string& signature)
+    {
+        mPath = path;
+        mSignature = signature;
+        mEntries.clear();
+        mEnabled = true;
+        mDirty = false;
+
+        if (!boost::filesystem::exists (path))
+            return;
+
+        try
+        {
+            boost::filesystem::ifstream stream (path, std::ios::binary);
+
+            if (readValue<uint32_t> (stream)!=sMagic || readValue<uint32_t> (stream)!=sFormatVersion ||
+                readString (stream)!=signature)
+            {
+                // written by another version or for other content files
+                mDirty = true;
+                return;
+            }
+
+            uint32_t count = readLength (stream);
+
+            for (uint32_t i=0; i<count; ++i)
+            {
+                std::string name = readString (stream);
+
+                Entry entry;
+                entry.mSourceHash = readValue<uint64_t> (stream);
+                entry.mFailed = readValue<uint8_t> (stream)!=0;
+
+                entry.mCode.resize (readLength (stream));
+                if (!entry.mCode.empty() && !stream.read (reinterpret_cast<char *> (&entry.mCode[0]),
+                    entry.mCode.size()*sizeof (Interpreter::Type_Code)))
+                    throw std::runtime_error ("unexpected end of file");
+
+                for (int type=0; type<3; ++type)
+                {
+                    uint32_t locals = readLength (stream);
+                    for (uint32_t j=0; j<locals; ++j)
+                        entry.mLocals.declare (sLocalTypes[type], readString (stream));
+                }
+
+                mEntries.insert (std::make_pair (name, entry));
+            }
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Ignoring script cache " << path.string() << ": " << e.what() << std::endl;
+            mEntries.clear();
+            mDirty = true;
+        }
+    }
+
+    void ScriptCache::save()
+    {
+        if (!mEnabled || !mDirty)
+            return;
+
+        try
+        {
+            boost::filesystem::create_directories (mPath.parent_path());
+
+            // write to a temporary file first, so an interrupted write can not leave a truncated cache behind
+            boost::filesystem::path tempPath (mPath.string() + ".tmp");
+
+            {
+                boost::filesystem::ofstream stream (tempPath, std::ios::binary | std::ios::trunc);
+
+                writeValue (stream, sMagic);
+                writeValue (stream, sFormatVersion);
+                writeString (stream, mSignature);
+                writeValue (stream, static_cast<uint32_t> (mEntries.size()));
+
+                for (std::map<std::string, Entry>::const_iterator iter (mEntries.begin());
+                    iter!=mEntries.end(); ++iter)
+                {
+                    writeString (stream, iter->first);
+                    writeValue (stream, iter->second.mSourceHash);
+                    writeValue (stream, static_cast<uint8_t> (iter->second.mFailed));
+                    writeValue (stream, static_cast<uint32_t> (iter->second.mCode.size()));
+                    if (!iter->second.mCode.empty())
+                        stream.write (reinterpret_cast<const char *> (&iter->second.mCode[0]),
+                            iter->second.mCode.size()*sizeof (Interpreter::Type_Code));
+
+                    for (int type=0; type<3; ++type)
+                    {
+                        const std::vector<std::string>& locals = iter->second.mLocals.get (sLocalTypes[type]);
+                        writeValue (stream, static_cast<uint32_t> (locals.size()));
+                        for (std::vector<std::string>::const_iterator local (locals.begin());
+                            local!=locals.end(); ++local)
+                            writeString (stream, *local);
+                    }
+                }
+
+                if (!stream.good())
+                    throw std::runtime_error ("write failed");
+            }
+
+            boost::filesystem::rename (tempPath, mPath);
+            mDirty = false;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Failed to write script cache " << mPath.string() << ": " << e.what() << std::endl;
+        }
+    }
+
+    bool ScriptCache::get (const std::string& name, const std::string& source,
+        std::vector<Interpreter::Type_Code>& code, Compiler::Locals& locals) const
+    {
+        if (!mEnabled)
+            return false;
+
+        std::map<std::string, Entry>::const_iterator iter =
+            mEntries.find (Misc::StringUtils::lowerCase (name));
+
+        if (iter==mEntries.end() || iter->second.mFailed || iter->second.mSourceHash!=hashSource (source))
+            return false;
+
+        code = iter->second.mCode;
+        locals = iter->second.mLocals;
+        return true;
+    }
+
+    void ScriptCache::insert (const std::string& name, const std::string& source,
+        const std::vector<Interpreter::Type_Code>& code, const Compiler::Locals& locals)
+    {
+        if (!mEnabled)
+            return;
+
+        Entry& entry = mEntries[Misc::StringUtils::lowerCase (name)];
+        entry.mSourceHash = hashSource (source);
+        entry.mFailed = false;
+        entry.mCode = code;
+        entry.mLocals = locals;
+        mDirty = true;
+    }
+
+    bool ScriptCache::hasFailed (const std::string& name, const std::string& source) const
+    {
+        if (!mEnabled)
+            return false;
+
+        std::map<std::string, Entry>::const_iterator iter =
+            mEntries.find (Misc::StringUtils::lowerCase (name));
+
+        return iter!=mEntries.end() && iter->second.mFailed && iter->second.mSourceHash==hashSource (source);
+    }
+
+    void ScriptCache::insertFailure (const std::string& name, const std::string& source)
+    {
+        if (!mEnabled)
+            return;
+
+        Entry& entry = mEntries[Misc::StringUtils::lowerCase (name)];
+        entry.mSourceHash = hashSource (source);
+        entry.mFailed = true;
+        entry.mCode.clear();
+        entry.mLocals.clear();
+        mDirty = true;
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef GAME_SCRIPT_SCRIPTCACHE_H
+#define GAME_SCRIPT_SCRIPTCACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#include <stdint.h>
+
+#include <boost/filesystem/path.hpp>
+
+#include <components/compiler/locals.hpp>
+
+#include <components/interpreter/types.hpp>
+
+namespace MWScript
+{
+    /// \brief Compiled scripts, kept on disk across sessions
+    ///
+    /// Every entry is checked against a hash of the script source. The cache as a whole is
+    /// tied to a signature, which must change whenever anything else the compiled code depends
+    /// on may have changed (engine version, compiler, content files).
+    class ScriptCache
+    {
+            struct Entry
+            {
+                uint64_t mSourceHash;
+                bool mFailed;
+                std::vector<Interpreter::Type_Code> mCode;
+                Compiler::Locals mLocals;
+            };
+
+            boost::filesystem::path mPath;
+            std::string mSignature;
+            std::map<std::string, Entry> mEntries;
+            bool mEnabled;
+            bool mDirty;
+
+            static uint64_t hashSource (const std::string& source);
+
+        public:
+
+            ScriptCache();
+
+            void load (const boost::filesystem::path& path, const std::string& signature);
+            ///< Enable the cache and read the cache file at \a path, if it exists and was written
+            /// with the same \a signature. A cache file that can not be read is ignored.
+
+            void save();
+            ///< Write the cache file, if the cache was changed since it was loaded.
+
+            bool get (const std::string& name, const std::string& source,
+                std::vector<Interpreter::Type_Code>& code, Compiler::Locals& locals) const;
+            ///< Look up the compiled script \a name.
+            /// \return Was the script found and compiled from \a source?
+
+            void insert (const std::string& name, const std::string& source,
+                const std::vector<Interpreter::Type_Code>& code, const Compiler::Locals& locals);
+            ///< Add or replace a compiled script. Ignored if the cache is not enabled.
+
+            bool hasFailed (const std::string& name, const std::string& source) const;
+            ///< \return Did compiling script \a name from \a source fail before?
+
+            void insertFailure (const std::string& name, const std::string& source);
+            ///< Remember that script \a name can not be compiled from \a source, so it is not
+            /// compiled again. Ignored if the cache is not enabled.
+    };
+}
+
+#endif
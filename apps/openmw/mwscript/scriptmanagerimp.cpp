@@ -6,6 +6,8 @@
 #include <exception>
 #include <algorithm>
 
+#include <OpenThreads/ScopedLock>
+
 #include <components/esm/loadscpt.hpp>
 
 #include <components/misc/stringops.hpp>
@@ -19,10 +21,32 @@
 
 #include <components/compiler/nullerrorhandler.hpp>
 
+#include <components/sceneutil/workqueue.hpp>
+
 #include "../mwworld/esmstore.hpp"
 
 #include "extensions.hpp"
 
+namespace
+{
+    class PrecompileWorkItem : public SceneUtil::WorkItem
+    {
+        public:
+
+            PrecompileWorkItem (MWScript::ScriptManager& scriptManager) : mScriptManager (scriptManager) {}
+
+            virtual void doWork()
+            {
+                mScriptManager.compileAll();
+                mScriptManager.saveCache();
+            }
+
+        private:
+
+            MWScript::ScriptManager& mScriptManager;
+    };
+}
+
 namespace MWScript
 {
     ScriptManager::ScriptManager (const MWWorld::ESMStore& store, bool verbose,
@@ -41,8 +65,67 @@ namespace MWScript
         std::sort (mScriptBlacklist.begin(), mScriptBlacklist.end());
     }
 
+    ScriptManager::~ScriptManager()
+    {
+        // don't hold up quitting for scripts that are not needed anymore
+        ++mAbortPrecompile;
+        finishPrecompile();
+
+        saveCache();
+    }
+
+    void ScriptManager::loadCache (const boost::filesystem::path& path, const std::string& signature)
+    {
+        mCache.load (path, signature);
+    }
+
+    void ScriptManager::saveCache()
+    {
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock (mMutex);
+        mCache.save();
+    }
+
+    void ScriptManager::startPrecompile()
+    {
+        finishPrecompile();
+
+        mPrecompileQueue = new SceneUtil::WorkQueue;
+        mPrecompile = new PrecompileWorkItem (*this);
+        mPrecompileQueue->addWorkItem (mPrecompile);
+    }
+
+    void ScriptManager::finishPrecompile()
+    {
+        if (!mPrecompile)
+            return;
+
+        mPrecompile->waitTillDone();
+        mPrecompile = NULL;
+        mPrecompileQueue = NULL;
+    }
+
     bool ScriptManager::compile (const std::string& name)
     {
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock (mMutex);
+
+        if (const ESM::Script *script = mStore.get<ESM::Script>().search (name))
+        {
+            CompiledScript compiled;
+
+            if (mCache.get (name, script->mScriptText, compiled.first, compiled.second))
+            {
+                mScripts.insert (std::make_pair (name, compiled));
+                return true;
+            }
+
+            // the errors have been reported when the script was compiled for the cache
+            if (mCache.hasFailed (name, script->mScriptText))
+            {
+                std::cerr << "compiling failed (cached): " << name << std::endl;
+                return false;
+            }
+        }
+
         mErrorHandler.reset();
         Compiler::NullErrorHandler noError;
 
@@ -86,6 +169,8 @@ namespace MWScript
                                 << "compiling failed: " << name << std::endl;
                             if (mVerbose)
                                 std::cerr << script->mScriptText << std::endl << std::endl;
+
+                            mCache.insertFailure (name, script->mScriptText);
                         }
 
                     if (Success)
@@ -93,6 +178,7 @@ namespace MWScript
                             std::vector<Interpreter::Type_Code> code;
                             mParser.getCode (code);
                             mScripts.insert (std::make_pair (name, std::make_pair (code, mParser.getLocals())));
+                            mCache.insert (name, script->mScriptText, code, mParser.getLocals());
 
                             return true;
                         }
@@ -117,6 +203,7 @@ namespace MWScript
                                 std::vector<Interpreter::Type_Code> code;
                                 output.getCode(code);
                                 mScripts.insert (std::make_pair (name, std::make_pair (code, output.getLocals())));
+                                mCache.insert (name, script->mScriptText, code, output.getLocals());
 
                                 if (errorhandler.countWarnings() > 0) {
                                     std::cout << script->mScriptText << std::endl;
@@ -133,6 +220,7 @@ namespace MWScript
                                     compiler.compile_stream(input, name, output);
                                 }
                                 std::cout << "Failed on " << name << std::endl;
+                                mCache.insertFailure (name, script->mScriptText);
                                 return false;
                             }
 
@@ -150,6 +238,8 @@ namespace MWScript
 
     void ScriptManager::run (const std::string& name, Interpreter::Context& interpreterContext)
     {
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock (mMutex);
+
         // compile script
         ScriptCollection::iterator iter = mScripts.find (name);
 
@@ -196,7 +286,7 @@ namespace MWScript
         const MWWorld::Store<ESM::Script>& scripts = mStore.get<ESM::Script>();
 
         for (MWWorld::Store<ESM::Script>::iterator iter = scripts.begin();
-            iter != scripts.end(); ++iter)
+            iter != scripts.end() && !mAbortPrecompile; ++iter)
             if (!std::binary_search (mScriptBlacklist.begin(), mScriptBlacklist.end(),
                 Misc::StringUtils::lowerCase (iter->mId)))
             {
@@ -211,6 +301,8 @@ namespace MWScript
 
     const Compiler::Locals& ScriptManager::getLocals (const std::string& name)
     {
+        OpenThreads::ScopedLock<OpenThreads::ReentrantMutex> lock (mMutex);
+
         std::string name2 = Misc::StringUtils::lowerCase (name);
 
         {
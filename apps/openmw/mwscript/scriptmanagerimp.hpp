@@ -4,6 +4,11 @@
 #include <map>
 #include <string>
 
+#include <OpenThreads/Atomic>
+#include <OpenThreads/ReentrantMutex>
+
+#include <osg/ref_ptr>
+
 #include <components/compiler/streamerrorhandler.hpp>
 #include <components/compiler/fileparser.hpp>
 
@@ -13,6 +18,7 @@
 #include "../mwbase/scriptmanager.hpp"
 
 #include "globalscripts.hpp"
+#include "scriptcache.hpp"
 
 namespace MWWorld
 {
@@ -24,6 +30,12 @@ namespace Compiler
     class Context;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+    class WorkItem;
+}
+
 namespace Interpreter
 {
     class Context;
@@ -50,12 +62,38 @@ namespace MWScript
             std::map<std::string, Compiler::Locals> mOtherLocals;
             std::vector<std::string> mScriptBlacklist;
             bool mNewCompiler;
+            ScriptCache mCache;
+
+            // Held while compiling or running a script, so the background compile pass and the main thread
+            // can use the compiler and the compiled scripts in turn. Reentrant, since compiling a script
+            // may look up the locals of another one.
+            OpenThreads::ReentrantMutex mMutex;
+            osg::ref_ptr<SceneUtil::WorkQueue> mPrecompileQueue;
+            osg::ref_ptr<SceneUtil::WorkItem> mPrecompile;
+            OpenThreads::Atomic mAbortPrecompile;
+
         public:
 
             ScriptManager (const MWWorld::ESMStore& store, bool verbose,
                 Compiler::Context& compilerContext, int warningsMode,
                 const std::vector<std::string>& scriptBlacklist, bool newCompiler);
 
+            virtual ~ScriptManager();
+            ///< Writes the script cache, if it has been changed.
+
+            void loadCache (const boost::filesystem::path& path, const std::string& signature);
+            ///< Take compiled scripts from the cache file at \a path instead of compiling them
+            /// again, and add newly compiled scripts to it. See ScriptCache::load.
+
+            void saveCache();
+
+            void startPrecompile();
+            ///< Compile all scripts (or take them from the cache) on a background thread, then write
+            /// the cache. Scripts needed in the meantime are still compiled on demand.
+
+            virtual void finishPrecompile();
+            ///< Wait for the background compile pass started with startPrecompile, if it is still running.
+
             virtual void run (const std::string& name, Interpreter::Context& interpreterContext);
             ///< Run the script with the given name (compile first, if not compiled yet)
 
@@ -66,6 +104,8 @@ namespace MWScript
             virtual std::pair<int, int> compileAll();
             ///< Compile all scripts
             /// \return count, success
+            ///
+            /// \note Also called from the background compile pass, see startPrecompile.
 
             virtual const Compiler::Locals& getLocals (const std::string& name);
             ///< Return locals for script \a name.
@@ -2,64 +2,135 @@
 
 #include <stdint.h>
 #include <limits>
+#include <cmath>
+#include <algorithm>
 
 #include "soundmanagerimp.hpp"
 
+namespace
+{
+    // Sample conversions to a scale from -1 to 1
+
+    struct ConvertUInt8
+    {
+        float operator()(const char *sample) const
+        {
+            return (static_cast<unsigned char>(*sample) - 128) / 128.f;
+        }
+    };
+
+    struct ConvertInt16
+    {
+        float operator()(const char *sample) const
+        {
+            return *reinterpret_cast<const int16_t*>(sample) / float(std::numeric_limits<int16_t>::max());
+        }
+    };
+
+    struct ConvertFloat32
+    {
+        float operator()(const char *sample) const
+        {
+            // Float samples *should* be scaled to [-1,1] already.
+            return std::max(-1.f, std::min(1.f, *reinterpret_cast<const float*>(sample)));
+        }
+    };
+
+    /// Sum of the squared values of the first channel of \a frames frames.
+    /// The loop is free of branches on the sample type, and keeps four independent partial sums, so the
+    /// compiler can vectorize it without having to reorder floating point additions itself.
+    template <class Convert>
+    float sumSquares(const char *data, size_t frames, size_t frameSize, Convert convert)
+    {
+        float sum[4] = { 0.f, 0.f, 0.f, 0.f };
+
+        size_t frame = 0;
+        for (; frame + 4 <= frames; frame += 4)
+        {
+            for (size_t i = 0; i < 4; ++i)
+            {
+                float value = convert(data + (frame+i)*frameSize);
+                sum[i] += value*value;
+            }
+        }
+        for (; frame < frames; ++frame)
+        {
+            float value = convert(data + frame*frameSize);
+            sum[0] += value*value;
+        }
+
+        return (sum[0] + sum[1]) + (sum[2] + sum[3]);
+    }
+}
+
 namespace MWSound
 {
 
+void Sound_Loudness::setFormat(int sampleRate, ChannelConfig chans, SampleType type)
+{
+    mSampleRate = sampleRate;
+    mChannelConfig = chans;
+    mSampleType = type;
+}
+
 void Sound_Loudness::analyzeLoudness(const std::vector< char >& data)
 {
     mQueue.insert( mQueue.end(), data.begin(), data.end() );
-    if (!mQueue.size())
+    if (mQueue.empty())
         return;
 
-    int samplesPerSegment = static_cast<int>(mSampleRate / mSamplesPerSec);
-    int numSamples = bytesToFrames(mQueue.size(), mChannelConfig, mSampleType);
-    int advance = framesToBytes(1, mChannelConfig, mSampleType);
+    size_t samplesPerSegment = static_cast<size_t>(mSampleRate / mSamplesPerSec);
+    if (samplesPerSegment == 0)
+        return;
 
+    size_t numSamples = bytesToFrames(mQueue.size(), mChannelConfig, mSampleType);
+    size_t advance = framesToBytes(1, mChannelConfig, mSampleType);
+    size_t numSegments = numSamples/samplesPerSegment;
+    if (numSegments == 0)
+        return;
 
-    int segment=0;
-    int sample=0;
-    while (segment < numSamples/samplesPerSegment)
+    std::vector<float> values(numSegments);
+    for (size_t segment = 0; segment < numSegments; ++segment)
     {
-        float sum=0;
-        int samplesAdded = 0;
-        while (sample < numSamples && sample < (segment+1)*samplesPerSegment)
-        {
-            // get sample on a scale from -1 to 1
-            float value = 0;
-            if (mSampleType == SampleType_UInt8)
-                value = ((char)(mQueue[sample*advance]^0x80))/128.f;
-            else if (mSampleType == SampleType_Int16)
-            {
-                value = *reinterpret_cast<const int16_t*>(&mQueue[sample*advance]);
-                value /= float(std::numeric_limits<int16_t>::max());
-            }
-            else if (mSampleType == SampleType_Float32)
-            {
-                value = *reinterpret_cast<const float*>(&mQueue[sample*advance]);
-                value = std::max(-1.f, std::min(1.f, value)); // Float samples *should* be scaled to [-1,1] already.
-            }
+        const char *segmentData = &mQueue[segment*samplesPerSegment*advance];
 
-            sum += value*value;
-            ++samplesAdded;
-            ++sample;
-        }
+        float sum = 0;
+        if (mSampleType == SampleType_UInt8)
+            sum = sumSquares(segmentData, samplesPerSegment, advance, ConvertUInt8());
+        else if (mSampleType == SampleType_Int16)
+            sum = sumSquares(segmentData, samplesPerSegment, advance, ConvertInt16());
+        else if (mSampleType == SampleType_Float32)
+            sum = sumSquares(segmentData, samplesPerSegment, advance, ConvertFloat32());
+
+        values[segment] = std::sqrt(sum / samplesPerSegment); // root mean square
+    }
 
-        float rms = 0; // root mean square
-        if (samplesAdded > 0)
-            rms = std::sqrt(sum / samplesAdded);
-        mSamples.push_back(rms);
-        ++segment;
+    {
+        boost::lock_guard<boost::mutex> lock(mMutex);
+        mSamples.insert(mSamples.end(), values.begin(), values.end());
     }
 
-    mQueue.erase(mQueue.begin(), mQueue.begin() + sample*advance);
+    mQueue.erase(mQueue.begin(), mQueue.begin() + numSegments*samplesPerSegment*advance);
 }
 
+void Sound_Loudness::setReady()
+{
+    std::vector<char>().swap(mQueue);
+
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    mReady = true;
+}
+
+bool Sound_Loudness::isReady() const
+{
+    boost::lock_guard<boost::mutex> lock(mMutex);
+    return mReady;
+}
 
 float Sound_Loudness::getLoudnessAtTime(float sec) const
 {
+    boost::lock_guard<boost::mutex> lock(mMutex);
+
     if(mSamplesPerSec <= 0.0f || mSamples.empty() || sec < 0.0f)
         return 0.0f;
 
@@ -2,7 +2,9 @@
 #define GAME_SOUND_LOUDNESS_H
 
 #include <vector>
-#include <deque>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
 
 #include "sound_decoder.hpp"
 
@@ -17,23 +19,36 @@ class Sound_Loudness {
 
     // Loudness sample info
     std::vector<float> mSamples;
+    bool mReady;
+
+    // Guards mSamples and mReady, which are written by the stream thread and read by the main thread
+    mutable boost::mutex mMutex;
 
-    std::deque<char> mQueue;
+    std::vector<char> mQueue;
+
+    Sound_Loudness(const Sound_Loudness &rhs);
+    Sound_Loudness& operator=(const Sound_Loudness &rhs);
 
 public:
     /**
      * @param samplesPerSecond How many loudness values per second of audio to compute.
-     * @param sampleRate the sample rate of the sound buffer
-     * @param chans channel layout of the buffer
-     * @param type sample type of the buffer
     */
-    Sound_Loudness(float samplesPerSecond, int sampleRate, ChannelConfig chans, SampleType type)
+    Sound_Loudness(float samplesPerSecond)
         : mSamplesPerSec(samplesPerSecond)
-        , mSampleRate(sampleRate)
-        , mChannelConfig(chans)
-        , mSampleType(type)
+        , mSampleRate(0)
+        , mChannelConfig(ChannelConfig_Mono)
+        , mSampleType(SampleType_Int16)
+        , mReady(false)
     { }
 
+    /**
+     * Set the format of the audio data, to be called before analyzeLoudness.
+     * @param sampleRate the sample rate of the sound buffer
+     * @param chans channel layout of the buffer
+     * @param type sample type of the buffer
+     */
+    void setFormat(int sampleRate, ChannelConfig chans, SampleType type);
+
     /**
      * Analyzes the energy (closely related to loudness) of a sound buffer.
      * The buffer will be divided into segments according to \a valuesPerSecond,
@@ -46,6 +61,14 @@ public:
      */
     void analyzeLoudness(const std::vector<char>& data);
 
+    /**
+     * Mark the analysis as complete, once the whole audio file has been passed to analyzeLoudness().
+     * The loudness values may then be reused for later playbacks of the same file.
+     */
+    void setReady();
+
+    bool isReady() const;
+
     /**
      * Get loudness at a particular time. Before calling this, the stream has to be analyzed up to that point in time (see analyzeLoudness()).
      */
@@ -49,7 +49,6 @@ ALC_API ALCboolean ALC_APIENTRY alcResetDeviceSOFT(ALCdevice *device, const ALCi
 namespace
 {
 
-const int sLoudnessFPS = 20; // loudness values per second of audio
 
 // Helper to get an OpenAL extension function
 template<typename T, typename R>
@@ -213,7 +212,8 @@ private:
 
     DecoderPtr mDecoder;
 
-    std::auto_ptr<Sound_Loudness> mLoudnessAnalyzer;
+    LoudnessPtr mLoudnessAnalyzer;
+    bool mAnalyzeLoudness;
 
     volatile bool mIsFinished;
 
@@ -225,7 +225,7 @@ private:
     friend class OpenAL_Output;
 
 public:
-    OpenAL_SoundStream(ALuint src, DecoderPtr decoder, bool getLoudnessData=false);
+    OpenAL_SoundStream(ALuint src, DecoderPtr decoder, LoudnessPtr loudness=LoudnessPtr());
     ~OpenAL_SoundStream();
 
     bool isPlaying();
@@ -313,8 +313,9 @@ private:
 };
 
 
-OpenAL_SoundStream::OpenAL_SoundStream(ALuint src, DecoderPtr decoder, bool getLoudnessData)
-  : mSource(src), mCurrentBufIdx(0), mFrameSize(0), mSilence(0), mDecoder(decoder), mIsFinished(false)
+OpenAL_SoundStream::OpenAL_SoundStream(ALuint src, DecoderPtr decoder, LoudnessPtr loudness)
+  : mSource(src), mCurrentBufIdx(0), mFrameSize(0), mSilence(0), mDecoder(decoder), mLoudnessAnalyzer(loudness), mAnalyzeLoudness(false)
+  , mIsFinished(false)
 {
     alGenBuffers(sNumBuffers, mBuffers);
     throwALerror();
@@ -339,8 +340,12 @@ OpenAL_SoundStream::OpenAL_SoundStream(ALuint src, DecoderPtr decoder, bool getL
         mBufferSize = static_cast<ALuint>(sBufferLength*srate);
         mBufferSize *= mFrameSize;
 
-        if (getLoudnessData)
-            mLoudnessAnalyzer.reset(new Sound_Loudness(sLoudnessFPS, mSampleRate, chans, type));
+        // An analyzer that is already complete was filled by an earlier playback of the same file
+        if (mLoudnessAnalyzer.get() && !mLoudnessAnalyzer->isReady())
+        {
+            mLoudnessAnalyzer->setFormat(mSampleRate, chans, type);
+            mAnalyzeLoudness = true;
+        }
     }
     catch(std::exception&)
     {
@@ -472,7 +477,7 @@ ALint OpenAL_SoundStream::refillQueue()
             }
             if(got > 0)
             {
-                if (mLoudnessAnalyzer.get())
+                if (mAnalyzeLoudness)
                     mLoudnessAnalyzer->analyzeLoudness(data);
 
                 ALuint bufid = mBuffers[mCurrentBufIdx];
@@ -481,6 +486,12 @@ ALint OpenAL_SoundStream::refillQueue()
                 mCurrentBufIdx = (mCurrentBufIdx+1) % sNumBuffers;
             }
         }
+
+        if (mIsFinished && mAnalyzeLoudness)
+        {
+            mLoudnessAnalyzer->setReady();
+            mAnalyzeLoudness = false;
+        }
     }
 
     return queued;
@@ -696,8 +707,6 @@ void OpenAL_Output::disableHrtf()
 
 Sound_Handle OpenAL_Output::loadSound(const std::string &fname)
 {
-    throwALerror();
-
     DecoderPtr decoder = mManager.getDecoder();
     // Workaround: Bethesda at some point converted some of the files to mp3, but the references were kept as .wav.
     if(decoder->mResourceMgr->exists(fname))
@@ -714,19 +723,26 @@ Sound_Handle OpenAL_Output::loadSound(const std::string &fname)
     std::vector<char> data;
     ChannelConfig chans;
     SampleType type;
-    ALenum format;
     int srate;
 
     decoder->getInfo(&srate, &chans, &type);
-    format = getALFormat(chans, type);
 
     decoder->readAll(data);
     decoder->close();
 
+    return loadSound(data, srate, chans, type);
+}
+
+Sound_Handle OpenAL_Output::loadSound(const std::vector<char> &data, int srate, ChannelConfig chans, SampleType type)
+{
+    throwALerror();
+
+    ALenum format = getALFormat(chans, type);
+
     ALuint buf = 0;
     try {
         alGenBuffers(1, &buf);
-        alBufferData(buf, format, &data[0], data.size(), srate);
+        alBufferData(buf, format, data.empty() ? NULL : &data[0], data.size(), srate);
         throwALerror();
     }
     catch(...) {
@@ -963,7 +979,7 @@ void OpenAL_Output::streamSound(DecoderPtr decoder, MWBase::SoundStreamPtr sound
     sound->mHandle = stream;
 }
 
-void OpenAL_Output::streamSound3D(DecoderPtr decoder, MWBase::SoundStreamPtr sound, bool getLoudnessData)
+void OpenAL_Output::streamSound3D(DecoderPtr decoder, MWBase::SoundStreamPtr sound, LoudnessPtr loudness)
 {
     OpenAL_SoundStream *stream = 0;
     ALuint source;
@@ -980,7 +996,7 @@ void OpenAL_Output::streamSound3D(DecoderPtr decoder, MWBase::SoundStreamPtr sou
                      sound->getRealVolume(), sound->getPitch(), false, sound->getUseEnv());
         throwALerror();
 
-        stream = new OpenAL_SoundStream(source, decoder, getLoudnessData);
+        stream = new OpenAL_SoundStream(source, decoder, loudness);
         mStreamThread->add(stream);
         mActiveStreams.push_back(sound);
     }
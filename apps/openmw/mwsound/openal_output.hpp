@@ -53,6 +53,7 @@ namespace MWSound
         virtual void disableHrtf();
 
         virtual Sound_Handle loadSound(const std::string &fname);
+        virtual Sound_Handle loadSound(const std::vector<char> &data, int srate, ChannelConfig chans, SampleType type);
         virtual void unloadSound(Sound_Handle data);
         virtual size_t getSoundDataSize(Sound_Handle data) const;
 
@@ -63,7 +64,7 @@ namespace MWSound
         virtual void updateSound(MWBase::SoundPtr sound);
 
         virtual void streamSound(DecoderPtr decoder, MWBase::SoundStreamPtr sound);
-        virtual void streamSound3D(DecoderPtr decoder, MWBase::SoundStreamPtr sound, bool getLoudnessData);
+        virtual void streamSound3D(DecoderPtr decoder, MWBase::SoundStreamPtr sound, LoudnessPtr loudness);
         virtual void finishStream(MWBase::SoundStreamPtr sound);
         virtual double getStreamDelay(MWBase::SoundStreamPtr sound);
         virtual double getStreamOffset(MWBase::SoundStreamPtr sound);
@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "soundmanagerimp.hpp"
+#include "sound_decoder.hpp"
 
 namespace MWSound
 {
@@ -31,6 +32,8 @@ namespace MWSound
         virtual void disableHrtf() = 0;
 
         virtual Sound_Handle loadSound(const std::string &fname) = 0;
+        /// Create a buffer from already decoded sample data.
+        virtual Sound_Handle loadSound(const std::vector<char> &data, int srate, ChannelConfig chans, SampleType type) = 0;
         virtual void unloadSound(Sound_Handle data) = 0;
         virtual size_t getSoundDataSize(Sound_Handle data) const = 0;
 
@@ -41,7 +44,7 @@ namespace MWSound
         virtual void updateSound(MWBase::SoundPtr sound) = 0;
 
         virtual void streamSound(DecoderPtr decoder, MWBase::SoundStreamPtr sound) = 0;
-        virtual void streamSound3D(DecoderPtr decoder, MWBase::SoundStreamPtr sound, bool getLoudnessData) = 0;
+        virtual void streamSound3D(DecoderPtr decoder, MWBase::SoundStreamPtr sound, LoudnessPtr loudness) = 0;
         virtual void finishStream(MWBase::SoundStreamPtr sound) = 0;
         virtual double getStreamDelay(MWBase::SoundStreamPtr sound) = 0;
         virtual double getStreamOffset(MWBase::SoundStreamPtr sound) = 0;
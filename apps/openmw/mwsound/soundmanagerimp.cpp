@@ -3,6 +3,7 @@
 #include <iostream>
 #include <algorithm>
 #include <map>
+#include <stdexcept>
 
 #include <osg/Matrixf>
 
@@ -10,6 +11,8 @@
 
 #include <components/vfs/manager.hpp>
 
+#include <components/sceneutil/workqueue.hpp>
+
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
 #include "../mwbase/statemanager.hpp"
@@ -23,6 +26,7 @@
 #include "sound_buffer.hpp"
 #include "sound_decoder.hpp"
 #include "sound.hpp"
+#include "loudness.hpp"
 
 #include "openal_output.hpp"
 #define SOUND_OUT "OpenAL"
@@ -34,6 +38,63 @@
 
 namespace MWSound
 {
+    const int sLoudnessFPS = 20; // loudness values per second of audio
+
+    // Upper bound for the number of voice files to keep loudness values for
+    const size_t sMaxVoiceLoudnessEntries = 1024;
+
+    /// Worker thread item: decode a sound file into memory, ready for creating a sound buffer from it.
+    class SoundBufferDecoder : public SceneUtil::WorkItem
+    {
+    public:
+        /// @param decoder An opened decoder. It is closed again by finish(), on the main thread, as opening and
+        /// closing codecs is not thread-safe.
+        SoundBufferDecoder(DecoderPtr decoder)
+            : mDecoder(decoder)
+            , mSampleRate(0)
+            , mChannels(ChannelConfig_Mono)
+            , mType(SampleType_Int16)
+        {
+        }
+
+        virtual void doWork()
+        {
+            try
+            {
+                mDecoder->getInfo(&mSampleRate, &mChannels, &mType);
+                mDecoder->readAll(mData);
+            }
+            catch (std::exception& e)
+            {
+                mError = e.what();
+            }
+        }
+
+        /// To be called from the main thread once the work is done.
+        /// @note Throws an exception if decoding failed.
+        void finish()
+        {
+            mDecoder->close();
+            mDecoder.reset();
+
+            if (!mError.empty())
+                throw std::runtime_error(mError);
+        }
+
+        const std::vector<char>& getData() const { return mData; }
+        int getSampleRate() const { return mSampleRate; }
+        ChannelConfig getChannels() const { return mChannels; }
+        SampleType getSampleType() const { return mType; }
+
+    private:
+        DecoderPtr mDecoder;
+        std::vector<char> mData;
+        int mSampleRate;
+        ChannelConfig mChannels;
+        SampleType mType;
+        std::string mError;
+    };
+
     SoundManager::SoundManager(const VFS::Manager* vfs, bool useSound)
         : mVFS(vfs)
         , mOutput(new DEFAULT_OUTPUT(*this))
@@ -69,6 +130,10 @@ namespace MWSound
         if(!useSound)
             return;
 
+        int decodingThreads = Settings::Manager::getInt("decoding threads", "Sound");
+        if(decodingThreads > 0)
+            mDecodeQueue = new SceneUtil::WorkQueue(decodingThreads);
+
         std::string hrtfname = Settings::Manager::getString("hrtf", "Sound");
         int hrtfstate = Settings::Manager::getInt("hrtf enable", "Sound");
 
@@ -114,6 +179,11 @@ namespace MWSound
     SoundManager::~SoundManager()
     {
         clear();
+
+        // stops the decoding threads, so the remaining decoders are released on this thread
+        mDecodeQueue = NULL;
+        mPendingBuffers.clear();
+
         SoundBufferList::element_type::iterator sfxiter = mSoundBuffers->begin();
         for(;sfxiter != mSoundBuffers->end();++sfxiter)
         {
@@ -177,46 +247,197 @@ namespace MWSound
     }
 
     // Lookup a soundId for its sound data (resource name, local volume,
-    // minRange, and maxRange), and ensure it's ready for use.
-    Sound_Buffer *SoundManager::loadSound(const std::string &soundId)
+    // minRange, and maxRange), adding it if it hasn't been used yet.
+    Sound_Buffer *SoundManager::getSound(const std::string &soundId)
     {
-        Sound_Buffer *sfx;
-        NameBufferMap::const_iterator snd = mBufferNameMap.find(soundId);
-        if(snd != mBufferNameMap.end())
-            sfx = snd->second;
-        else
+        Sound_Buffer *sfx = lookupSound(soundId);
+        if(!sfx)
         {
             MWBase::World *world = MWBase::Environment::get().getWorld();
             const ESM::Sound *sound = world->getStore().get<ESM::Sound>().find(soundId);
             sfx = insertSound(soundId, sound);
         }
+        return sfx;
+    }
+
+    // Lookup a soundId for its sound data (resource name, local volume,
+    // minRange, and maxRange), and ensure it's ready for use.
+    Sound_Buffer *SoundManager::loadSound(const std::string &soundId)
+    {
+        Sound_Buffer *sfx = getSound(soundId);
+        finishLoading(sfx, true);
+        return sfx;
+    }
 
-        if(!sfx->mHandle)
+    // Lookup a soundId for its sound data, and start loading it if needed. The
+    // buffer may not be ready yet when this returns.
+    Sound_Buffer *SoundManager::requestSound(const std::string &soundId)
+    {
+        if(!mDecodeQueue)
+            return loadSound(soundId);
+
+        Sound_Buffer *sfx = getSound(soundId);
+        startLoading(sfx);
+        return sfx;
+    }
+
+    void SoundManager::startLoading(Sound_Buffer *sfx)
+    {
+        if(sfx->mHandle || mPendingBuffers.find(sfx) != mPendingBuffers.end())
+            return;
+
+        osg::ref_ptr<SoundBufferDecoder> decoder(new SoundBufferDecoder(loadVoice(sfx->mResourceName)));
+        mPendingBuffers.insert(std::make_pair(sfx, decoder));
+        mDecodeQueue->addWorkItem(decoder);
+    }
+
+    // Create the buffer for a sound, if it has been decoded in the background (or
+    // if wait is true, once it has been decoded). Returns whether the buffer is
+    // ready to play.
+    bool SoundManager::finishLoading(Sound_Buffer *sfx, bool wait)
+    {
+        if(sfx->mHandle)
+            return true;
+
+        PendingBufferMap::iterator found = mPendingBuffers.find(sfx);
+        if(found == mPendingBuffers.end())
         {
+            if(!wait)
+                return false;
             sfx->mHandle = mOutput->loadSound(sfx->mResourceName);
-            mBufferCacheSize += mOutput->getSoundDataSize(sfx->mHandle);
+        }
+        else
+        {
+            if(!wait && !found->second->isDone())
+                return false;
 
-            if(mBufferCacheSize > mBufferCacheMax)
-            {
-                do {
-                    if(mUnusedBuffers.empty())
-                    {
-                        std::cerr<< "No unused sound buffers to free, using "<<mBufferCacheSize<<" bytes!" <<std::endl;
-                        break;
-                    }
-                    Sound_Buffer *unused = mUnusedBuffers.back();
+            osg::ref_ptr<SoundBufferDecoder> decoder = found->second;
+            mPendingBuffers.erase(found);
+
+            decoder->waitTillDone();
+            decoder->finish();
+            sfx->mHandle = mOutput->loadSound(decoder->getData(), decoder->getSampleRate(),
+                                              decoder->getChannels(), decoder->getSampleType());
+        }
+
+        addToCache(sfx);
+        return true;
+    }
+
+    void SoundManager::addToCache(Sound_Buffer *sfx)
+    {
+        mBufferCacheSize += mOutput->getSoundDataSize(sfx->mHandle);
+
+        if(mBufferCacheSize > mBufferCacheMax)
+        {
+            do {
+                if(mUnusedBuffers.empty())
+                {
+                    std::cerr<< "No unused sound buffers to free, using "<<mBufferCacheSize<<" bytes!" <<std::endl;
+                    break;
+                }
+                Sound_Buffer *unused = mUnusedBuffers.back();
 
+                // sounds stopped before their buffer was decoded leave unloaded entries behind
+                if(unused->mHandle)
+                {
                     mBufferCacheSize -= mOutput->getSoundDataSize(unused->mHandle);
                     mOutput->unloadSound(unused->mHandle);
                     unused->mHandle = 0;
+                }
 
-                    mUnusedBuffers.pop_back();
-                } while(mBufferCacheSize > mBufferCacheMin);
-            }
+                mUnusedBuffers.pop_back();
+            } while(mBufferCacheSize > mBufferCacheMin);
+        }
+
+        if(sfx->mUses == 0 && std::find(mUnusedBuffers.begin(), mUnusedBuffers.end(), sfx) == mUnusedBuffers.end())
             mUnusedBuffers.push_front(sfx);
+    }
+
+    // Play a sound on the output, or queue it until its buffer is ready.
+    void SoundManager::startSound(MWBase::SoundPtr sound, Sound_Buffer *sfx, float offset)
+    {
+        if(!finishLoading(sfx, false))
+        {
+            PendingSound pending;
+            pending.mSound = sound;
+            pending.mBuffer = sfx;
+            pending.mOffset = offset;
+            mPendingSounds.push_back(pending);
+            return;
         }
 
-        return sfx;
+        if(sound->getIs3D())
+            mOutput->playSound3D(sound, sfx->mHandle, offset);
+        else
+            mOutput->playSound(sound, sfx->mHandle, offset);
+    }
+
+    void SoundManager::finishSound(MWBase::SoundPtr sound)
+    {
+        for(PendingSoundList::iterator iter = mPendingSounds.begin();iter != mPendingSounds.end();++iter)
+        {
+            if(iter->mSound == sound)
+            {
+                mPendingSounds.erase(iter);
+                return;
+            }
+        }
+        mOutput->finishSound(sound);
+    }
+
+    bool SoundManager::isSoundPlaying(MWBase::SoundPtr sound) const
+    {
+        for(PendingSoundList::const_iterator iter = mPendingSounds.begin();iter != mPendingSounds.end();++iter)
+        {
+            if(iter->mSound == sound)
+                return true;
+        }
+        return mOutput->isSoundPlaying(sound);
+    }
+
+    void SoundManager::updatePendingSounds()
+    {
+        PendingBufferMap::iterator bufiter = mPendingBuffers.begin();
+        while(bufiter != mPendingBuffers.end())
+        {
+            Sound_Buffer *sfx = bufiter->first;
+            bool done = bufiter->second->isDone();
+            ++bufiter;
+
+            if(done)
+            {
+                try {
+                    finishLoading(sfx, false);
+                }
+                catch(std::exception &e) {
+                    std::cerr << "Failed to load " << sfx->mResourceName << ": " << e.what() << std::endl;
+                }
+            }
+        }
+
+        PendingSoundList::iterator snditer = mPendingSounds.begin();
+        while(snditer != mPendingSounds.end())
+        {
+            PendingSound pending = *snditer;
+            if(pending.mBuffer->mHandle)
+            {
+                snditer = mPendingSounds.erase(snditer);
+                try {
+                    startSound(pending.mSound, pending.mBuffer, pending.mOffset);
+                }
+                catch(std::exception&) {
+                    // the sound is not playing, and will be removed by updateSounds
+                }
+            }
+            else if(mPendingBuffers.find(pending.mBuffer) == mPendingBuffers.end())
+            {
+                // loading failed
+                snditer = mPendingSounds.erase(snditer);
+            }
+            else
+                ++snditer;
+        }
     }
 
     DecoderPtr SoundManager::loadVoice(const std::string &voicefile)
@@ -237,7 +458,23 @@ namespace MWSound
         return decoder;
     }
 
-    MWBase::SoundStreamPtr SoundManager::playVoice(DecoderPtr decoder, const osg::Vec3f &pos, bool playlocal)
+    LoudnessPtr SoundManager::getVoiceLoudness(const std::string &voicefile)
+    {
+        LoudnessMap::iterator found = mVoiceLoudness.find(voicefile);
+        if(found != mVoiceLoudness.end() && found->second->isReady())
+            return found->second;
+
+        // Analyzers that are not complete yet may still be filled by a playing stream, so a new
+        // one is used. The previous one is kept alive by its stream, if any.
+        if(mVoiceLoudness.size() >= sMaxVoiceLoudnessEntries && found == mVoiceLoudness.end())
+            mVoiceLoudness.clear();
+
+        LoudnessPtr loudness(new Sound_Loudness(sLoudnessFPS));
+        mVoiceLoudness[voicefile] = loudness;
+        return loudness;
+    }
+
+    MWBase::SoundStreamPtr SoundManager::playVoice(DecoderPtr decoder, const osg::Vec3f &pos, bool playlocal, LoudnessPtr loudness)
     {
         MWBase::World* world = MWBase::Environment::get().getWorld();
         static const float fAudioMinDistanceMult = world->getStore().get<ESM::GameSetting>().find("fAudioMinDistanceMult")->getFloat();
@@ -258,7 +495,7 @@ namespace MWSound
         {
             sound.reset(new Stream(pos, 1.0f, basevol, 1.0f, minDistance, maxDistance,
                                    Play_Normal|Play_TypeVoice|Play_3D));
-            mOutput->streamSound3D(decoder, sound, true);
+            mOutput->streamSound3D(decoder, sound, loudness);
         }
         return sound;
     }
@@ -398,7 +635,9 @@ namespace MWSound
                 mActiveSaySounds.erase(oldIt);
             }
 
-            MWBase::SoundStreamPtr sound = playVoice(decoder, pos, (ptr == MWMechanics::getPlayer()));
+            bool playlocal = (ptr == MWMechanics::getPlayer());
+            MWBase::SoundStreamPtr sound = playVoice(decoder, pos, playlocal,
+                                                     playlocal ? LoudnessPtr() : getVoiceLoudness(voicefile));
 
             mActiveSaySounds.insert(std::make_pair(ptr, sound));
         }
@@ -439,7 +678,7 @@ namespace MWSound
             }
 
             mActiveSaySounds.insert(std::make_pair(MWWorld::ConstPtr(),
-                                                   playVoice(decoder, osg::Vec3f(), true)));
+                                                   playVoice(decoder, osg::Vec3f(), true, LoudnessPtr())));
         }
         catch(std::exception &e)
         {
@@ -504,6 +743,20 @@ namespace MWSound
     }
 
 
+    void SoundManager::preloadSound(const std::string& soundId)
+    {
+        if(!mOutput->isInitialized() || !mDecodeQueue)
+            return;
+        try
+        {
+            startLoading(getSound(Misc::StringUtils::lowerCase(soundId)));
+        }
+        catch(std::exception&)
+        {
+            // the error is reported if the sound is actually played
+        }
+    }
+
     MWBase::SoundPtr SoundManager::playSound(const std::string& soundId, float volume, float pitch, PlayType type, PlayMode mode, float offset)
     {
         MWBase::SoundPtr sound;
@@ -511,11 +764,11 @@ namespace MWSound
             return sound;
         try
         {
-            Sound_Buffer *sfx = loadSound(Misc::StringUtils::lowerCase(soundId));
+            Sound_Buffer *sfx = requestSound(Misc::StringUtils::lowerCase(soundId));
             float basevol = volumeFromType(type);
 
             sound.reset(new Sound(volume * sfx->mVolume, basevol, pitch, mode|type|Play_2D));
-            mOutput->playSound(sound, sfx->mHandle, offset);
+            startSound(sound, sfx, offset);
             if(sfx->mUses++ == 0)
             {
                 SoundList::iterator iter = std::find(mUnusedBuffers.begin(), mUnusedBuffers.end(), sfx);
@@ -541,7 +794,7 @@ namespace MWSound
         try
         {
             // Look up the sound in the ESM data
-            Sound_Buffer *sfx = loadSound(Misc::StringUtils::lowerCase(soundId));
+            Sound_Buffer *sfx = requestSound(Misc::StringUtils::lowerCase(soundId));
             float basevol = volumeFromType(type);
             const ESM::Position &pos = ptr.getRefData().getPosition();
             const osg::Vec3f objpos(pos.asVec3());
@@ -552,13 +805,13 @@ namespace MWSound
             if(!(mode&Play_NoPlayerLocal) && ptr == MWMechanics::getPlayer())
             {
                 sound.reset(new Sound(volume * sfx->mVolume, basevol, pitch, mode|type|Play_2D));
-                mOutput->playSound(sound, sfx->mHandle, offset);
+                startSound(sound, sfx, offset);
             }
             else
             {
                 sound.reset(new Sound(objpos, volume * sfx->mVolume, basevol, pitch,
                                       sfx->mMinDist, sfx->mMaxDist, mode|type|Play_3D));
-                mOutput->playSound3D(sound, sfx->mHandle, offset);
+                startSound(sound, sfx, offset);
             }
             if(sfx->mUses++ == 0)
             {
@@ -585,12 +838,12 @@ namespace MWSound
         try
         {
             // Look up the sound in the ESM data
-            Sound_Buffer *sfx = loadSound(Misc::StringUtils::lowerCase(soundId));
+            Sound_Buffer *sfx = requestSound(Misc::StringUtils::lowerCase(soundId));
             float basevol = volumeFromType(type);
 
             sound.reset(new Sound(initialPos, volume * sfx->mVolume, basevol, pitch,
                                   sfx->mMinDist, sfx->mMaxDist, mode|type|Play_3D));
-            mOutput->playSound3D(sound, sfx->mHandle, offset);
+            startSound(sound, sfx, offset);
             if(sfx->mUses++ == 0)
             {
                 SoundList::iterator iter = std::find(mUnusedBuffers.begin(), mUnusedBuffers.end(), sfx);
@@ -610,7 +863,7 @@ namespace MWSound
     void SoundManager::stopSound(MWBase::SoundPtr sound)
     {
         if (sound.get())
-            mOutput->finishSound(sound);
+            finishSound(sound);
     }
 
     void SoundManager::stopSound3D(const MWWorld::ConstPtr &ptr, const std::string& soundId)
@@ -618,12 +871,12 @@ namespace MWSound
         SoundMap::iterator snditer = mActiveSounds.find(ptr);
         if(snditer != mActiveSounds.end())
         {
-            Sound_Buffer *sfx = loadSound(Misc::StringUtils::lowerCase(soundId));
+            Sound_Buffer *sfx = lookupSound(Misc::StringUtils::lowerCase(soundId));
             SoundBufferRefPairList::iterator sndidx = snditer->second.begin();
             for(;sndidx != snditer->second.end();++sndidx)
             {
                 if(sndidx->second == sfx)
-                    mOutput->finishSound(sndidx->first);
+                    finishSound(sndidx->first);
             }
         }
     }
@@ -635,7 +888,7 @@ namespace MWSound
         {
             SoundBufferRefPairList::iterator sndidx = snditer->second.begin();
             for(;sndidx != snditer->second.end();++sndidx)
-                mOutput->finishSound(sndidx->first);
+                finishSound(sndidx->first);
         }
     }
 
@@ -650,7 +903,7 @@ namespace MWSound
             {
                 SoundBufferRefPairList::iterator sndidx = snditer->second.begin();
                 for(;sndidx != snditer->second.end();++sndidx)
-                    mOutput->finishSound(sndidx->first);
+                    finishSound(sndidx->first);
             }
             ++snditer;
         }
@@ -672,12 +925,12 @@ namespace MWSound
         SoundMap::iterator snditer = mActiveSounds.find(MWWorld::ConstPtr());
         if(snditer != mActiveSounds.end())
         {
-            Sound_Buffer *sfx = loadSound(Misc::StringUtils::lowerCase(soundId));
+            Sound_Buffer *sfx = lookupSound(Misc::StringUtils::lowerCase(soundId));
             SoundBufferRefPairList::iterator sndidx = snditer->second.begin();
             for(;sndidx != snditer->second.end();++sndidx)
             {
                 if(sndidx->second == sfx)
-                    mOutput->finishSound(sndidx->first);
+                    finishSound(sndidx->first);
             }
         }
     }
@@ -688,7 +941,7 @@ namespace MWSound
         SoundMap::iterator snditer = mActiveSounds.find(ptr);
         if(snditer != mActiveSounds.end())
         {
-            Sound_Buffer *sfx = loadSound(Misc::StringUtils::lowerCase(soundId));
+            Sound_Buffer *sfx = lookupSound(Misc::StringUtils::lowerCase(soundId));
             SoundBufferRefPairList::iterator sndidx = snditer->second.begin();
             for(;sndidx != snditer->second.end();++sndidx)
             {
@@ -707,7 +960,7 @@ namespace MWSound
             SoundBufferRefPairList::const_iterator sndidx = snditer->second.begin();
             for(;sndidx != snditer->second.end();++sndidx)
             {
-                if(sndidx->second == sfx && mOutput->isSoundPlaying(sndidx->first))
+                if(sndidx->second == sfx && isSoundPlaying(sndidx->first))
                     return true;
             }
         }
@@ -815,7 +1068,7 @@ namespace MWSound
             env = Env_Underwater;
         else if(mUnderwaterSound)
         {
-            mOutput->finishSound(mUnderwaterSound);
+            finishSound(mUnderwaterSound);
             mUnderwaterSound.reset();
         }
 
@@ -845,13 +1098,13 @@ namespace MWSound
                     if(sound->getDistanceCull())
                     {
                         if((mListenerPos - objpos).length2() > 2000*2000)
-                            mOutput->finishSound(sound);
+                            finishSound(sound);
                     }
                 }
 
-                if(!mOutput->isSoundPlaying(sound))
+                if(!isSoundPlaying(sound))
                 {
-                    mOutput->finishSound(sound);
+                    finishSound(sound);
                     Sound_Buffer *sfx = sndidx->second;
                     if(sfx->mUses-- == 1)
                         mUnusedBuffers.push_front(sfx);
@@ -924,7 +1177,7 @@ namespace MWSound
         if(mListenerUnderwater)
         {
             // Play underwater sound (after updating sounds)
-            if(!(mUnderwaterSound && mOutput->isSoundPlaying(mUnderwaterSound)))
+            if(!(mUnderwaterSound && isSoundPlaying(mUnderwaterSound)))
                 mUnderwaterSound = playSound("Underwater", 1.0f, 1.0f, Play_TypeSfx, Play_LoopNoEnv);
         }
         mOutput->finishUpdate();
@@ -936,6 +1189,8 @@ namespace MWSound
         if(!mOutput->isInitialized())
             return;
 
+        updatePendingSounds();
+
         if (MWBase::Environment::get().getStateManager()->getState()!=
             MWBase::StateManager::State_NoGame)
         {
@@ -1089,7 +1344,7 @@ namespace MWSound
             SoundBufferRefPairList::iterator sndidx = snditer->second.begin();
             for(;sndidx != snditer->second.end();++sndidx)
             {
-                mOutput->finishSound(sndidx->first);
+                finishSound(sndidx->first);
                 Sound_Buffer *sfx = sndidx->second;
                 if(sfx->mUses-- == 1)
                     mUnusedBuffers.push_front(sfx);
@@ -9,6 +9,8 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <osg/ref_ptr>
+
 #include <components/settings/settings.hpp>
 
 #include "../mwbase/soundmanager.hpp"
@@ -23,12 +25,21 @@ namespace ESM
     struct Sound;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWSound
 {
     class Sound_Output;
     struct Sound_Decoder;
     class Sound;
     class Sound_Buffer;
+    class SoundBufferDecoder;
+    class Sound_Loudness;
+
+    typedef boost::shared_ptr<Sound_Loudness> LoudnessPtr;
 
     enum Environment {
         Env_Normal,
@@ -72,6 +83,23 @@ namespace MWSound
         typedef std::deque<Sound_Buffer*> SoundList;
         SoundList mUnusedBuffers;
 
+        // Decodes sound buffers in the background. NULL if sounds are loaded on the main thread.
+        osg::ref_ptr<SceneUtil::WorkQueue> mDecodeQueue;
+
+        typedef std::map<Sound_Buffer*,osg::ref_ptr<SoundBufferDecoder> > PendingBufferMap;
+        PendingBufferMap mPendingBuffers;
+
+        // Sounds that were played while their buffer was still being decoded. They are started as soon as
+        // the buffer is ready, and are in mActiveSounds in the meantime.
+        struct PendingSound
+        {
+            MWBase::SoundPtr mSound;
+            Sound_Buffer *mBuffer;
+            float mOffset;
+        };
+        typedef std::vector<PendingSound> PendingSoundList;
+        PendingSoundList mPendingSounds;
+
         typedef std::pair<MWBase::SoundPtr,Sound_Buffer*> SoundBufferRefPair;
         typedef std::vector<SoundBufferRefPair> SoundBufferRefPairList;
         typedef std::map<MWWorld::ConstPtr,SoundBufferRefPairList> SoundMap;
@@ -80,6 +108,11 @@ namespace MWSound
         typedef std::map<MWWorld::ConstPtr,MWBase::SoundStreamPtr> SaySoundMap;
         SaySoundMap mActiveSaySounds;
 
+        // Loudness of voice files played with lip sync, by normalized file name. An entry is analyzed
+        // while its voice file is streamed for the first time, later playbacks reuse the finished values.
+        typedef std::map<std::string,LoudnessPtr> LoudnessMap;
+        LoudnessMap mVoiceLoudness;
+
         typedef std::vector<MWBase::SoundStreamPtr> TrackList;
         TrackList mActiveTracks;
 
@@ -98,12 +131,26 @@ namespace MWSound
         Sound_Buffer *insertSound(const std::string &soundId, const ESM::Sound *sound);
 
         Sound_Buffer *lookupSound(const std::string &soundId) const;
+        Sound_Buffer *getSound(const std::string &soundId);
         Sound_Buffer *loadSound(const std::string &soundId);
+        Sound_Buffer *requestSound(const std::string &soundId);
+
+        void startLoading(Sound_Buffer *sfx);
+        bool finishLoading(Sound_Buffer *sfx, bool wait);
+        void addToCache(Sound_Buffer *sfx);
+
+        void startSound(MWBase::SoundPtr sound, Sound_Buffer *sfx, float offset);
+        void finishSound(MWBase::SoundPtr sound);
+        bool isSoundPlaying(MWBase::SoundPtr sound) const;
+        void updatePendingSounds();
 
         // returns a decoder to start streaming
         DecoderPtr loadVoice(const std::string &voicefile);
 
-        MWBase::SoundStreamPtr playVoice(DecoderPtr decoder, const osg::Vec3f &pos, bool playlocal);
+        // returns the loudness analyzer to use for a voice file
+        LoudnessPtr getVoiceLoudness(const std::string &voicefile);
+
+        MWBase::SoundStreamPtr playVoice(DecoderPtr decoder, const osg::Vec3f &pos, bool playlocal, LoudnessPtr loudness);
 
         void streamMusicFull(const std::string& filename);
         void updateSounds(float duration);
@@ -171,6 +218,9 @@ namespace MWSound
         /// returned by \ref playTrack). Only intended to be called by the track
         /// decoder's read method.
 
+        virtual void preloadSound(const std::string& soundId);
+        ///< Start loading the given sound in the background, so it is ready when it is played.
+
         virtual MWBase::SoundPtr playSound(const std::string& soundId, float volume, float pitch, PlayType type=Play_TypeSfx, PlayMode mode=Play_Normal, float offset=0);
         ///< Play a sound, independently of 3D-position
         ///< @param offset Number of seconds into the sound to start playback.
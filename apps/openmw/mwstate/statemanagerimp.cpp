@@ -11,6 +11,8 @@
 
 #include <components/settings/settings.hpp>
 
+#include <components/sceneutil/workqueue.hpp>
+
 #include <osg/Image>
 
 #include <osgDB/Registry>
@@ -40,8 +42,71 @@
 
 #include "../mwscript/globalscripts.hpp"
 
+namespace MWState
+{
+    /// Worker thread item: write a serialized saved game to disk.
+    class SaveGameWriter : public SceneUtil::WorkItem
+    {
+    public:
+        SaveGameWriter(const boost::filesystem::path& path)
+            : mPath(path)
+            , mSuccess(false)
+        {
+        }
+
+        /// The stream to serialize the saved game into, on the main thread before the writer is queued.
+        std::ostream& getStream() { return mData; }
+
+        virtual void doWork()
+        {
+            // Write to a temporary file first. If the write fails, we don't want to trash the existing save file
+            // we are overwriting.
+            boost::filesystem::path tempPath (mPath.string() + ".tmp");
+
+            try
+            {
+                {
+                    boost::filesystem::ofstream filestream (tempPath, std::ios::binary);
+                    filestream << mData.rdbuf();
+                    filestream.flush();
+
+                    if (filestream.fail())
+                        throw std::runtime_error("Write operation failed (file stream)");
+                }
+
+                boost::filesystem::rename(tempPath, mPath);
+                mSuccess = true;
+            }
+            catch (const std::exception& e)
+            {
+                mError = e.what();
+
+                boost::system::error_code ec;
+                boost::filesystem::remove(tempPath, ec);
+            }
+
+            mData.str(std::string());
+        }
+
+        const boost::filesystem::path& getPath() const { return mPath; }
+
+        bool getSuccess() const { return mSuccess; }
+
+        const std::string& getError() const { return mError; }
+
+    private:
+        boost::filesystem::path mPath;
+        std::stringstream mData;
+        bool mSuccess;
+        std::string mError;
+    };
+}
+
 void MWState::StateManager::cleanup (bool force)
 {
+    // scripts compiled in the background look at the world
+    MWBase::Environment::get().getScriptManager()->finishPrecompile();
+
     if (mState!=State_NoGame || force)
     {
         MWBase::Environment::get().getSoundManager()->clear();
@@ -86,17 +151,78 @@ std::map<int, int> MWState::StateManager::buildContentFileIndexMap (const ESM::E
     return map;
 }
 
+void MWState::StateManager::finishWrite (bool wait)
+{
+    if (!mPendingWrite)
+        return;
+
+    if (!wait && !mPendingWrite->isDone())
+        return;
+
+    mPendingWrite->waitTillDone();
+
+    osg::ref_ptr<SaveGameWriter> write = mPendingWrite;
+    Character *character = mPendingWriteCharacter;
+    mPendingWrite = NULL;
+    mPendingWriteCharacter = NULL;
+
+    if (write->getSuccess())
+    {
+        Settings::Manager::setString ("character", "Saves",
+            write->getPath().parent_path().filename().string());
+        return;
+    }
+
+    std::stringstream error;
+    error << "Failed to save game: " << write->getError();
+
+    std::cerr << error.str() << std::endl;
+
+    std::vector<std::string> buttons;
+    buttons.push_back("#{sOk}");
+    MWBase::Environment::get().getWindowManager()->interactiveMessageBox(error.str(), buttons);
+
+    // If no file was written, clean up the slot
+    if (character && !boost::filesystem::exists(write->getPath()))
+    {
+        for (Character::SlotIterator it = character->begin(); it != character->end(); ++it)
+        {
+            if (it->mPath == write->getPath())
+            {
+                character->deleteSlot(&*it);
+                character->cleanup();
+                break;
+            }
+        }
+    }
+}
+
 MWState::StateManager::StateManager (const boost::filesystem::path& saves, const std::string& game)
 : mQuitRequest (false), mAskLoadRecent(false), mState (State_NoGame), mCharacterManager (saves, game), mTimePlayed (0)
+, mWriteQueue (new SceneUtil::WorkQueue(1)), mPendingWriteCharacter (NULL)
 {
 
 }
 
+MWState::StateManager::~StateManager()
+{
+    if (mPendingWrite)
+        mPendingWrite->waitTillDone();
+}
+
 void MWState::StateManager::requestQuit()
 {
+    finishSaving();
+
     mQuitRequest = true;
 }
 
+void MWState::StateManager::finishSaving()
+{
+    // Make sure the last saved game is on disk and the settings are updated, before the settings are written
+    finishWrite (true);
+}
+
 bool MWState::StateManager::hasQuitRequest() const
 {
     return mQuitRequest;
@@ -173,6 +299,9 @@ void MWState::StateManager::endGame()
 
 void MWState::StateManager::saveGame (const std::string& description, const Slot *slot)
 {
+    // Wait for the previous save, which may be in the same slot
+    finishWrite (true);
+
     MWState::Character* character = getCurrentCharacter();
 
     try
@@ -222,9 +351,11 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
         // Make sure the animation state held by references is up to date before saving the game.
         MWBase::Environment::get().getMechanicsManager()->persistAnimationStates();
 
-        // Write to a memory stream first. If there is an exception during the save process, we don't want to trash the
-        // existing save file we are overwriting.
-        std::stringstream stream;
+        // Write to the memory stream of the writer first, which is handed over to the write queue once complete.
+        // If there is an exception during the save process, we don't want to trash the existing save file we
+        // are overwriting.
+        osg::ref_ptr<SaveGameWriter> write (new SaveGameWriter(slot->mPath));
+        std::ostream& stream = write->getStream();
 
         ESM::ESMWriter writer;
 
@@ -281,15 +412,10 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
         if (stream.fail())
             throw std::runtime_error("Write operation failed (memory stream)");
 
-        // All good, write to file
-        boost::filesystem::ofstream filestream (slot->mPath, std::ios::binary);
-        filestream << stream.rdbuf();
-
-        if (filestream.fail())
-            throw std::runtime_error("Write operation failed (file stream)");
-
-        Settings::Manager::setString ("character", "Saves",
-            slot->mPath.parent_path().filename().string());
+        // All good, write to file in the background. The result is handled by finishWrite().
+        mPendingWrite = write;
+        mPendingWriteCharacter = character;
+        mWriteQueue->addWorkItem(mPendingWrite);
     }
     catch (const std::exception& e)
     {
@@ -360,6 +486,8 @@ void MWState::StateManager::loadGame(const std::string& filepath)
 
 void MWState::StateManager::loadGame (const Character *character, const std::string& filepath)
 {
+    finishWrite (true);
+
     try
     {
         cleanup();
@@ -554,6 +682,8 @@ void MWState::StateManager::quickLoad()
 
 void MWState::StateManager::deleteGame(const MWState::Character *character, const MWState::Slot *slot)
 {
+    finishWrite (true);
+
     mCharacterManager.deleteSlot(character, slot);
 }
 
@@ -576,6 +706,8 @@ void MWState::StateManager::update (float duration)
 {
     mTimePlayed += duration;
 
+    finishWrite (false);
+
     // Note: It would be nicer to trigger this from InputManager, i.e. the very beginning of the frame update.
     if (mAskLoadRecent)
     {
@@ -7,10 +7,19 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <osg/ref_ptr>
+
 #include "charactermanager.hpp"
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWState
 {
+    class SaveGameWriter;
+
     class StateManager : public MWBase::StateManager
     {
             bool mQuitRequest;
@@ -19,10 +28,20 @@ namespace MWState
             CharacterManager mCharacterManager;
             double mTimePlayed;
 
+            // Saved games are serialized on the main thread, and written to disk in the background
+            osg::ref_ptr<SceneUtil::WorkQueue> mWriteQueue;
+            osg::ref_ptr<SaveGameWriter> mPendingWrite;
+            Character *mPendingWriteCharacter;
+
         private:
 
             void cleanup (bool force = false);
 
+            void finishWrite (bool wait);
+            ///< Handle the result of the pending saved game write, if it is complete.
+            ///
+            /// \param wait Block until the write is complete.
+
             bool verifyProfile (const ESM::SavedGame& profile) const;
 
             void writeScreenshot (std::vector<char>& imageData) const;
@@ -33,10 +52,14 @@ namespace MWState
 
             StateManager (const boost::filesystem::path& saves, const std::string& game);
 
+            virtual ~StateManager();
+
             virtual void requestQuit();
 
             virtual bool hasQuitRequest() const;
 
+            virtual void finishSaving();
+
             virtual void askLoadRecent();
 
             virtual State getState() const;
@@ -1,6 +1,7 @@
 #include "cellpreloader.hpp"
 
 #include <iostream>
+#include <set>
 
 #include <components/resource/scenemanager.hpp>
 #include <components/resource/resourcesystem.hpp>
@@ -12,6 +13,7 @@
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
+#include "../mwbase/soundmanager.hpp"
 
 #include "../mwworld/inventorystore.hpp"
 #include "../mwworld/esmstore.hpp"
@@ -40,6 +42,23 @@ namespace MWWorld
         std::vector<std::string>& mOut;
     };
 
+    struct ListIdsVisitor
+    {
+        ListIdsVisitor(std::vector<std::string>& out)
+            : mOut(out)
+        {
+        }
+
+        virtual bool operator()(const MWWorld::Ptr& ptr)
+        {
+            mOut.push_back(ptr.getCellRef().getRefId());
+
+            return true;
+        }
+
+        std::vector<std::string>& mOut;
+    };
+
     /// Worker thread item: preload models in a cell.
     class PreloadItem : public SceneUtil::WorkItem
     {
@@ -179,6 +198,7 @@ namespace MWWorld
         , mMinCacheSize(0)
         , mMaxCacheSize(0)
         , mPreloadInstances(true)
+        , mCreatureSoundsIndexed(false)
     {
     }
 
@@ -196,17 +216,16 @@ namespace MWWorld
             std::cerr << "can't preload, no work queue set " << std::endl;
             return;
         }
-        if (cell->getState() == CellStore::State_Unloaded)
-        {
-            std::cerr << "can't preload objects for unloaded cell" << std::endl;
-            return;
-        }
 
         PreloadMap::iterator found = mPreloadCells.find(cell);
         if (found != mPreloadCells.end())
         {
             // already preloaded, nothing to do other than updating the timestamp
             found->second.mTimeStamp = timestamp;
+
+            // unless the references have just become available
+            if (found->second.mRefDecoder && found->second.mRefDecoder->isDone())
+                preloadObjects(cell, found->second);
             return;
         }
 
@@ -226,15 +245,93 @@ namespace MWWorld
             }
 
             if (oldestTimestamp + threshold < timestamp)
-                mPreloadCells.erase(oldestCell);
+                erase(oldestCell);
             else
                 return;
         }
 
+        PreloadEntry& entry = mPreloadCells[cell];
+        entry.mTimeStamp = timestamp;
+
+        if (cell->getState() == CellStore::State_Unloaded)
+        {
+            // read the references in the background rather than from the main thread
+            entry.mRefDecoder = cell->createRefDecoder();
+            if (entry.mRefDecoder)
+            {
+                entry.mWorkItem = entry.mRefDecoder;
+                mWorkQueue->addWorkItem(entry.mWorkItem);
+                return;
+            }
+        }
+
+        preloadObjects(cell, entry);
+    }
+
+    void CellPreloader::preloadObjects(CellStore *cell, PreloadEntry &entry)
+    {
+        if (cell->getState() == CellStore::State_Unloaded)
+            cell->preload();
+
+        entry.mRefDecoder = NULL;
+
+        preloadSounds(cell);
+
         osg::ref_ptr<PreloadItem> item (new PreloadItem(cell, mResourceSystem->getSceneManager(), mBulletShapeManager, mResourceSystem->getKeyframeManager(), mTerrain, mPreloadInstances));
         mWorkQueue->addWorkItem(item);
 
-        mPreloadCells[cell] = PreloadEntry(timestamp, item);
+        entry.mWorkItem = item;
+    }
+
+    void CellPreloader::preloadSounds(CellStore* cell)
+    {
+        std::vector<std::string> ids;
+        if (cell->getState() == CellStore::State_Loaded)
+        {
+            ListIdsVisitor visitor (ids);
+            cell->forEach(visitor);
+        }
+        else
+            ids = cell->getPreloadedIds();
+
+        const ESMStore& store = MWBase::Environment::get().getWorld()->getStore();
+        MWBase::SoundManager* soundManager = MWBase::Environment::get().getSoundManager();
+
+        std::set<std::string> creatures;
+        for (std::vector<std::string>::const_iterator it = ids.begin(); it != ids.end(); ++it)
+        {
+            if (const ESM::Light* light = store.get<ESM::Light>().search(*it))
+            {
+                if (!light->mSound.empty())
+                    soundManager->preloadSound(light->mSound);
+            }
+            else if (const ESM::Creature* creature = store.get<ESM::Creature>().search(*it))
+                creatures.insert(Misc::StringUtils::lowerCase(creature->mOriginal.empty() ? creature->mId : creature->mOriginal));
+        }
+
+        if (creatures.empty())
+            return;
+
+        if (!mCreatureSoundsIndexed)
+        {
+            const Store<ESM::SoundGenerator>& soundGens = store.get<ESM::SoundGenerator>();
+            for (Store<ESM::SoundGenerator>::iterator it = soundGens.begin(); it != soundGens.end(); ++it)
+            {
+                if (!it->mCreature.empty())
+                    mCreatureSounds[Misc::StringUtils::lowerCase(it->mCreature)].push_back(it->mSound);
+            }
+            mCreatureSoundsIndexed = true;
+        }
+
+        for (std::set<std::string>::const_iterator it = creatures.begin(); it != creatures.end(); ++it)
+        {
+            CreatureSoundMap::const_iterator found = mCreatureSounds.find(*it);
+            if (found == mCreatureSounds.end())
+                continue;
+
+            for (std::vector<std::string>::const_iterator sound = found->second.begin(); sound != found->second.end(); ++sound)
+                soundManager->preloadSound(*sound);
+        }
     }
 
     void CellPreloader::notifyLoaded(CellStore *cell)
@@ -247,7 +344,7 @@ namespace MWWorld
         for (PreloadMap::iterator it = mPreloadCells.begin(); it != mPreloadCells.end();)
         {
             if (mPreloadCells.size() >= mMinCacheSize && it->second.mTimeStamp < timestamp - mExpiryDelay)
-                mPreloadCells.erase(it++);
+                erase(it++);
             else
                 ++it;
         }
@@ -256,6 +353,14 @@ namespace MWWorld
         mWorkQueue->addWorkItem(new UpdateCacheItem(mResourceSystem, mTerrain, timestamp), true);
     }
 
+    void CellPreloader::erase(PreloadMap::iterator it)
+    {
+        // don't hold on to references that were read for a cell that is no longer needed
+        if (it->first->getState() != CellStore::State_Loaded)
+            it->first->discardDecodedRefs();
+        mPreloadCells.erase(it);
+    }
+
     void CellPreloader::setExpiryDelay(double expiryDelay)
     {
         mExpiryDelay = expiryDelay;
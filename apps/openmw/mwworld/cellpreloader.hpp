@@ -2,9 +2,13 @@
 #define OPENMW_MWWORLD_CELLPRELOADER_H
 
 #include <map>
+#include <string>
+#include <vector>
 #include <osg/ref_ptr>
 #include <components/sceneutil/workqueue.hpp>
 
+#include "cellrefdecoder.hpp"
+
 namespace Resource
 {
     class ResourceSystem;
@@ -27,7 +31,8 @@ namespace MWWorld
         ~CellPreloader();
 
         /// Ask a background thread to preload rendering meshes and collision shapes for objects in this cell.
-        /// @note The cell itself must be in State_Loaded or State_Preloaded.
+        /// @note If the cell is in State_Unloaded, its references are read in the background first. Objects are
+        /// preloaded by a later call to preload() for the same cell, once the references are available.
         void preload(MWWorld::CellStore* cell, double timestamp);
 
         void notifyLoaded(MWWorld::CellStore* cell);
@@ -75,11 +80,28 @@ namespace MWWorld
 
             double mTimeStamp;
             osg::ref_ptr<SceneUtil::WorkItem> mWorkItem;
+
+            // Set while the references of the cell are being read, in that case mWorkItem is the same object
+            osg::ref_ptr<CellRefDecoder> mRefDecoder;
         };
-        typedef std::map<const MWWorld::CellStore*, PreloadEntry> PreloadMap;
+
+        void preloadObjects(MWWorld::CellStore* cell, PreloadEntry& entry);
+
+        /// Start loading the sounds that objects in the cell play by themselves: light sounds and creature sound
+        /// generators. To be called from the main thread.
+        void preloadSounds(MWWorld::CellStore* cell);
+        typedef std::map<MWWorld::CellStore*, PreloadEntry> PreloadMap;
+
+        void erase(PreloadMap::iterator it);
 
         // Cells that are currently being preloaded, or have already finished preloading
         PreloadMap mPreloadCells;
+
+        // Sounds of the sound generators of each creature, by lower case creature ID. Built on first use,
+        // sound generator records do not change after loading.
+        typedef std::map<std::string, std::vector<std::string> > CreatureSoundMap;
+        CreatureSoundMap mCreatureSounds;
+        bool mCreatureSoundsIndexed;
     };
 
 }
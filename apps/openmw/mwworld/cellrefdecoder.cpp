@@ -0,0 +1,86 @@
+#include "cellrefdecoder.hpp"
+
+#include <algorithm>
+
+#include <components/to_utf8/to_utf8.hpp>
+
+namespace MWWorld
+{
+
+    CellRefDecoder::CellRefDecoder(const ESM::Cell* cell, const std::vector<ESM::ESMReader>& readers)
+        : mContextList(cell->mContextList)
+        , mMovedRefs(cell->mMovedRefs)
+        , mFailed(false)
+    {
+        for (std::vector<ESM::ESM_Context>::const_iterator it = mContextList.begin(); it != mContextList.end(); ++it)
+        {
+            int index = it->index;
+            if (mReaders.find(index) != mReaders.end())
+                continue;
+
+            const ESM::ESMReader& reader = readers.at(index);
+            if (!mEncoder.get() && reader.getEncoder())
+                mEncoder.reset(new ToUTF8::Utf8Encoder(*reader.getEncoder()));
+
+            // Keep the header and index of the content file, but not the stream; restoreContext opens a new one.
+            ESM::ESMReader& copy = mReaders[index];
+            copy = reader;
+            copy.close();
+            copy.setEncoder(mEncoder.get());
+        }
+    }
+
+    CellRefDecoder::~CellRefDecoder()
+    {
+    }
+
+    void CellRefDecoder::doWork()
+    {
+        for (std::vector<ESM::ESM_Context>::const_iterator it = mContextList.begin(); it != mContextList.end(); ++it)
+        {
+            try
+            {
+                ESM::ESMReader& esm = mReaders[it->index];
+                esm.restoreContext(*it);
+
+                ESM::CellRef ref;
+                ref.mRefNum.mContentFile = ESM::RefNum::RefNum_NoContentFile;
+
+                bool deleted = false;
+                while (ESM::Cell::getNextRef(esm, ref, deleted))
+                {
+                    // Don't load reference if it was moved to a different cell.
+                    ESM::MovedCellRefTracker::const_iterator iter =
+                        std::find(mMovedRefs.begin(), mMovedRefs.end(), ref.mRefNum);
+                    if (iter != mMovedRefs.end())
+                        continue;
+
+                    Ref decoded;
+                    decoded.mRef = ref;
+                    decoded.mDeleted = deleted;
+                    mRefs.push_back(decoded);
+                }
+
+                esm.close();
+            }
+            catch (std::exception& e)
+            {
+                // The main thread will read the references again and report the error
+                mFailed = true;
+                mRefs.clear();
+                return;
+            }
+        }
+    }
+
+    bool CellRefDecoder::hasFailed() const
+    {
+        return mFailed;
+    }
+
+    CellRefDecoder::RefList& CellRefDecoder::getRefs()
+    {
+        return mRefs;
+    }
+
+}
@@ -0,0 +1,62 @@
+#ifndef OPENMW_MWWORLD_CELLREFDECODER_H
+#define OPENMW_MWWORLD_CELLREFDECODER_H
+
+#include <vector>
+#include <map>
+#include <memory>
+
+#include <components/esm/cellref.hpp>
+#include <components/esm/loadcell.hpp>
+#include <components/esm/esmreader.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+namespace ToUTF8
+{
+    class Utf8Encoder;
+}
+
+namespace MWWorld
+{
+
+    /// \brief Worker thread item: read the references of a cell from the content files.
+    /// @note To be constructed from the main thread. The work item uses its own readers, so that the
+    /// readers shared by the main thread are not touched.
+    class CellRefDecoder : public SceneUtil::WorkItem
+    {
+    public:
+        struct Ref
+        {
+            ESM::CellRef mRef;
+            bool mDeleted;
+        };
+        typedef std::vector<Ref> RefList;
+
+        CellRefDecoder(const ESM::Cell* cell, const std::vector<ESM::ESMReader>& readers);
+        ~CellRefDecoder();
+
+        virtual void doWork();
+
+        /// Did reading the content files fail? Only valid once the work item is done.
+        bool hasFailed() const;
+
+        /// References in the order they appear in the content files, excluding references moved to a different cell.
+        /// @note Only valid once the work item is done.
+        RefList& getRefs();
+
+    private:
+        std::vector<ESM::ESM_Context> mContextList;
+        ESM::MovedCellRefTracker mMovedRefs;
+
+        /// Copies of the readers for the content files contributing to the cell.
+        std::map<int, ESM::ESMReader> mReaders;
+
+        /// The encoder keeps an internal conversion buffer, so the worker needs its own copy.
+        std::auto_ptr<ToUTF8::Utf8Encoder> mEncoder;
+
+        RefList mRefs;
+        bool mFailed;
+    };
+
+}
+
+#endif
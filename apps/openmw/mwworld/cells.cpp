@@ -1,5 +1,6 @@
 #include "cells.hpp"
 
+#include <algorithm>
 #include <iostream>
 
 #include <components/esm/esmreader.hpp>
@@ -7,6 +8,7 @@
 #include <components/esm/defs.hpp>
 #include <components/esm/cellstate.hpp>
 #include <components/loadinglistener/loadinglistener.hpp>
+#include <components/misc/stringops.hpp>
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
@@ -16,6 +18,30 @@
 #include "containerstore.hpp"
 #include "cellstore.hpp"
 
+namespace
+{
+    /// Order in which cells holding the same reference ID are searched.
+    /// Exteriors come first, in reverse. This is a workaround for an ambiguous chargen_plank reference in the
+    /// vanilla game. There is one at -22,16 and one at -2,-9, the latter should be used.
+    struct SearchOrder
+    {
+        bool operator() (const MWWorld::CellStore *left, const MWWorld::CellStore *right) const
+        {
+            const ESM::Cell *leftCell = left->getCell();
+            const ESM::Cell *rightCell = right->getCell();
+
+            if (leftCell->isExterior()!=rightCell->isExterior())
+                return leftCell->isExterior();
+
+            if (leftCell->isExterior())
+                return std::make_pair (rightCell->getGridX(), rightCell->getGridY()) <
+                    std::make_pair (leftCell->getGridX(), leftCell->getGridY());
+
+            return Misc::StringUtils::lowerCase (leftCell->mName) < Misc::StringUtils::lowerCase (rightCell->mName);
+        }
+    };
+}
+
 MWWorld::CellStore *MWWorld::Cells::getCellStore (const ESM::Cell *cell)
 {
     if (cell->mData.mFlags & ESM::Cell::Interior)
@@ -25,7 +51,7 @@ MWWorld::CellStore *MWWorld::Cells::getCellStore (const ESM::Cell *cell)
 
         if (result==mInteriors.end())
         {
-            result = mInteriors.insert (std::make_pair (lowerName, CellStore (cell, mStore, mReader))).first;
+            result = mInteriors.insert (std::make_pair (lowerName, CellStore (cell, mStore, mReader, &mRefIdIndex))).first;
         }
 
         return &result->second;
@@ -38,7 +64,7 @@ MWWorld::CellStore *MWWorld::Cells::getCellStore (const ESM::Cell *cell)
         if (result==mExteriors.end())
         {
             result = mExteriors.insert (std::make_pair (
-                std::make_pair (cell->getGridX(), cell->getGridY()), CellStore (cell, mStore, mReader))).first;
+                std::make_pair (cell->getGridX(), cell->getGridY()), CellStore (cell, mStore, mReader, &mRefIdIndex))).first;
 
         }
 
@@ -50,23 +76,7 @@ void MWWorld::Cells::clear()
 {
     mInteriors.clear();
     mExteriors.clear();
-    std::fill(mIdCache.begin(), mIdCache.end(), std::make_pair("", (MWWorld::CellStore*)0));
-    mIdCacheIndex = 0;
-}
-
-MWWorld::Ptr MWWorld::Cells::getPtrAndCache (const std::string& name, CellStore& cellStore)
-{
-    Ptr ptr = getPtr (name, cellStore);
-
-    if (!ptr.isEmpty() && ptr.isInCell())
-    {
-        mIdCache[mIdCacheIndex].first = name;
-        mIdCache[mIdCacheIndex].second = &cellStore;
-        if (++mIdCacheIndex>=mIdCache.size())
-            mIdCacheIndex = 0;
-    }
-
-    return ptr;
+    mRefIdIndex.clear();
 }
 
 void MWWorld::Cells::writeCell (ESM::ESMWriter& writer, CellStore& cell) const
@@ -87,12 +97,10 @@ void MWWorld::Cells::writeCell (ESM::ESMWriter& writer, CellStore& cell) const
 }
 
 MWWorld::Cells::Cells (const MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& reader)
-: mStore (store), mReader (reader),
-  mIdCache (40, std::pair<std::string, CellStore *> ("", (CellStore*)0)), /// \todo make cache size configurable
-  mIdCacheIndex (0)
+: mStore (store), mReader (reader)
 {}
 
-MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y)
+MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y, bool forceLoad)
 {
     std::map<std::pair<int, int>, CellStore>::iterator result =
         mExteriors.find (std::make_pair (x, y));
@@ -120,10 +128,10 @@ MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y)
         }
 
         result = mExteriors.insert (std::make_pair (
-            std::make_pair (x, y), CellStore (cell, mStore, mReader))).first;
+            std::make_pair (x, y), CellStore (cell, mStore, mReader, &mRefIdIndex))).first;
     }
 
-    if (result->second.getState()!=CellStore::State_Loaded)
+    if (forceLoad && result->second.getState()!=CellStore::State_Loaded)
     {
         result->second.load ();
     }
@@ -131,7 +139,7 @@ MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y)
     return &result->second;
 }
 
-MWWorld::CellStore *MWWorld::Cells::getInterior (const std::string& name)
+MWWorld::CellStore *MWWorld::Cells::getInterior (const std::string& name, bool forceLoad)
 {
     std::string lowerName = Misc::StringUtils::lowerCase(name);
     std::map<std::string, CellStore>::iterator result = mInteriors.find (lowerName);
@@ -140,10 +148,10 @@ MWWorld::CellStore *MWWorld::Cells::getInterior (const std::string& name)
     {
         const ESM::Cell *cell = mStore.get<ESM::Cell>().find(lowerName);
 
-        result = mInteriors.insert (std::make_pair (lowerName, CellStore (cell, mStore, mReader))).first;
+        result = mInteriors.insert (std::make_pair (lowerName, CellStore (cell, mStore, mReader, &mRefIdIndex))).first;
     }
 
-    if (result->second.getState()!=CellStore::State_Loaded)
+    if (forceLoad && result->second.getState()!=CellStore::State_Loaded)
     {
         result->second.load ();
     }
@@ -188,33 +196,18 @@ MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name, CellStore& cell,
 
 MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name)
 {
-    // First check the cache
-    for (std::vector<std::pair<std::string, CellStore *> >::iterator iter (mIdCache.begin());
-        iter!=mIdCache.end(); ++iter)
-        if (iter->first==name && iter->second)
+    // First check the loaded cells that hold the reference
+    if (const RefIdIndex::CellList *indexed = mRefIdIndex.search (name))
+    {
+        RefIdIndex::CellList cells (*indexed);
+        std::sort (cells.begin(), cells.end(), SearchOrder());
+
+        for (RefIdIndex::CellList::const_iterator iter (cells.begin()); iter!=cells.end(); ++iter)
         {
-            Ptr ptr = getPtr (name, *iter->second);
+            Ptr ptr = getPtr (name, **iter);
             if (!ptr.isEmpty())
                 return ptr;
         }
-
-    // Then check cells that are already listed
-    // Search in reverse, this is a workaround for an ambiguous chargen_plank reference in the vanilla game.
-    // there is one at -22,16 and one at -2,-9, the latter should be used.
-    for (std::map<std::pair<int, int>, CellStore>::reverse_iterator iter = mExteriors.rbegin();
-        iter!=mExteriors.rend(); ++iter)
-    {
-        Ptr ptr = getPtrAndCache (name, iter->second);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    for (std::map<std::string, CellStore>::iterator iter = mInteriors.begin();
-        iter!=mInteriors.end(); ++iter)
-    {
-        Ptr ptr = getPtrAndCache (name, iter->second);
-        if (!ptr.isEmpty())
-            return ptr;
     }
 
     // Now try the other cells
@@ -225,7 +218,7 @@ MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name)
     {
         CellStore *cellStore = getCellStore (&(*iter));
 
-        Ptr ptr = getPtrAndCache (name, *cellStore);
+        Ptr ptr = getPtr (name, *cellStore);
 
         if (!ptr.isEmpty())
             return ptr;
@@ -235,7 +228,7 @@ MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name)
     {
         CellStore *cellStore = getCellStore (&(*iter));
 
-        Ptr ptr = getPtrAndCache (name, *cellStore);
+        Ptr ptr = getPtr (name, *cellStore);
 
         if (!ptr.isEmpty())
             return ptr;
@@ -245,6 +238,24 @@ MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name)
     return Ptr();
 }
 
+MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name, const std::set<CellStore *>& cells)
+{
+    if (const RefIdIndex::CellList *indexed = mRefIdIndex.search (name))
+    {
+        for (RefIdIndex::CellList::const_iterator iter (indexed->begin()); iter!=indexed->end(); ++iter)
+        {
+            if (cells.find (*iter)==cells.end())
+                continue;
+
+            Ptr ptr = getPtr (name, **iter);
+            if (!ptr.isEmpty())
+                return ptr;
+        }
+    }
+
+    return Ptr();
+}
+
 void MWWorld::Cells::getExteriorPtrs(const std::string &name, std::vector<MWWorld::Ptr> &out)
 {
     const MWWorld::Store<ESM::Cell> &cells = mStore.get<ESM::Cell>();
@@ -252,7 +263,7 @@ void MWWorld::Cells::getExteriorPtrs(const std::string &name, std::vector<MWWorl
     {
         CellStore *cellStore = getCellStore (&(*iter));
 
-        Ptr ptr = getPtrAndCache (name, *cellStore);
+        Ptr ptr = getPtr (name, *cellStore);
 
         if (!ptr.isEmpty())
             out.push_back(ptr);
@@ -266,7 +277,7 @@ void MWWorld::Cells::getInteriorPtrs(const std::string &name, std::vector<MWWorl
     {
         CellStore *cellStore = getCellStore (&(*iter));
 
-        Ptr ptr = getPtrAndCache (name, *cellStore);
+        Ptr ptr = getPtr (name, *cellStore);
 
         if (!ptr.isEmpty())
             out.push_back(ptr);
@@ -3,9 +3,11 @@
 
 #include <map>
 #include <list>
+#include <set>
 #include <string>
 
 #include "ptr.hpp"
+#include "refidindex.hpp"
 
 namespace ESM
 {
@@ -31,16 +33,13 @@ namespace MWWorld
             std::vector<ESM::ESMReader>& mReader;
             mutable std::map<std::string, CellStore> mInteriors;
             mutable std::map<std::pair<int, int>, CellStore> mExteriors;
-            std::vector<std::pair<std::string, CellStore *> > mIdCache;
-            std::size_t mIdCacheIndex;
+            RefIdIndex mRefIdIndex;
 
             Cells (const Cells&);
             Cells& operator= (const Cells&);
 
             CellStore *getCellStore (const ESM::Cell *cell);
 
-            Ptr getPtrAndCache (const std::string& name, CellStore& cellStore);
-
             void writeCell (ESM::ESMWriter& writer, CellStore& cell) const;
 
         public:
@@ -49,9 +48,11 @@ namespace MWWorld
 
             Cells (const MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& reader);
 
-            CellStore *getExterior (int x, int y);
+            CellStore *getExterior (int x, int y, bool forceLoad = true);
+            ///< @param forceLoad Load the references of the cell. If false, the cell may be returned in any state.
 
-            CellStore *getInterior (const std::string& name);
+            CellStore *getInterior (const std::string& name, bool forceLoad = true);
+            ///< @param forceLoad Load the references of the cell. If false, the cell may be returned in any state.
 
             CellStore *getCell (const ESM::CellId& id);
 
@@ -62,6 +63,11 @@ namespace MWWorld
             /// @note name must be lower case
             Ptr getPtr (const std::string& name);
 
+            /// Search the cells of \a cells that hold a reference to \a name. Unlike the other
+            /// getPtr functions, this one only looks at cells the reference index lists for \a name.
+            /// @note name must be lower case
+            Ptr getPtr (const std::string& name, const std::set<CellStore *>& cells);
+
             /// Get all Ptrs referencing \a name in exterior cells
             /// @note Due to the current implementation of getPtr this only supports one Ptr per cell.
             /// @note name must be lower case
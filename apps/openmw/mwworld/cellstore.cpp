@@ -24,6 +24,7 @@
 #include "esmstore.hpp"
 #include "class.hpp"
 #include "containerstore.hpp"
+#include "refidindex.hpp"
 
 namespace
 {
@@ -145,6 +146,62 @@ namespace
         collection.mList.push_back (ref);
     }
 
+    struct RefIdOrder
+    {
+        bool operator() (const MWWorld::LiveCellRefBase *left, const MWWorld::LiveCellRefBase *right) const
+        {
+            return left->mRef.getRefId() < right->mRef.getRefId();
+        }
+
+        bool operator() (const MWWorld::LiveCellRefBase *ref, const std::string& id) const
+        {
+            return ref->mRef.getRefId() < id;
+        }
+
+        bool operator() (const std::string& id, const MWWorld::LiveCellRefBase *ref) const
+        {
+            return id < ref->mRef.getRefId();
+        }
+    };
+
+    /// Call insert() or erase() on \a index for the IDs that differ between two lists sorted by RefIdOrder.
+    void updateRefIdIndex (MWWorld::RefIdIndex& index, MWWorld::CellStore *cell,
+        const std::vector<MWWorld::LiveCellRefBase*>& oldRefs, const std::vector<MWWorld::LiveCellRefBase*>& newRefs)
+    {
+        std::vector<MWWorld::LiveCellRefBase*>::const_iterator oldIter = oldRefs.begin();
+        std::vector<MWWorld::LiveCellRefBase*>::const_iterator newIter = newRefs.begin();
+
+        while (oldIter!=oldRefs.end() || newIter!=newRefs.end())
+        {
+            int compare;
+            if (oldIter==oldRefs.end())
+                compare = 1;
+            else if (newIter==newRefs.end())
+                compare = -1;
+            else
+                compare = (*oldIter)->mRef.getRefId().compare ((*newIter)->mRef.getRefId());
+
+            if (compare<0)
+            {
+                const std::string& id = (*oldIter)->mRef.getRefId();
+                index.erase (id, cell);
+                oldIter = std::upper_bound (oldIter, oldRefs.end(), id, RefIdOrder());
+            }
+            else if (compare>0)
+            {
+                const std::string& id = (*newIter)->mRef.getRefId();
+                index.insert (id, cell);
+                newIter = std::upper_bound (newIter, newRefs.end(), id, RefIdOrder());
+            }
+            else
+            {
+                const std::string& id = (*newIter)->mRef.getRefId();
+                oldIter = std::upper_bound (oldIter, oldRefs.end(), id, RefIdOrder());
+                newIter = std::upper_bound (newIter, newRefs.end(), id, RefIdOrder());
+            }
+        }
+    }
+
     struct SearchByRefNumVisitor
     {
         MWWorld::LiveCellRefBase* mFound;
@@ -221,7 +278,7 @@ namespace MWWorld
         {
             mMovedHere.insert(std::make_pair(object.getBase(), from));
         }
-        updateMergedRefs();
+        addMergedRef(object.getBase());
     }
 
     MWWorld::Ptr CellStore::moveTo(const Ptr &object, CellStore *cellToMoveTo)
@@ -267,14 +324,14 @@ namespace MWWorld
                 originalCell->moveTo(object, cellToMoveTo);
             }
 
-            updateMergedRefs();
+            removeMergedRef(object.getBase());
             return MWWorld::Ptr(object.getBase(), cellToMoveTo);
         }
 
         cellToMoveTo->moveFrom(object, this);
         mMovedToAnotherCell.insert(std::make_pair(object.getBase(), cellToMoveTo));
 
-        updateMergedRefs();
+        removeMergedRef(object.getBase());
         return MWWorld::Ptr(object.getBase(), cellToMoveTo);
     }
 
@@ -315,10 +372,56 @@ namespace MWWorld
         MergeVisitor visitor(mMergedRefs, mMovedHere, mMovedToAnotherCell);
         forEachInternal(visitor);
         visitor.merge();
+
+        std::vector<LiveCellRefBase*> refsById (mMergedRefs);
+        std::stable_sort (refsById.begin(), refsById.end(), RefIdOrder());
+
+        if (mRefIdIndex)
+            updateRefIdIndex (*mRefIdIndex, this, mRefsById, refsById);
+
+        mRefsById.swap (refsById);
+    }
+
+    void CellStore::addMergedRef (LiveCellRefBase *ref)
+    {
+        mMergedRefs.push_back (ref);
+
+        // insert after the refs with the same ID to keep them in the order of mMergedRefs
+        const std::string& id = ref->mRef.getRefId();
+        std::vector<LiveCellRefBase*>::iterator found =
+            std::upper_bound (mRefsById.begin(), mRefsById.end(), id, RefIdOrder());
+
+        if (mRefIdIndex && (found==mRefsById.begin() || (*(found-1))->mRef.getRefId()!=id))
+            mRefIdIndex->insert (id, this);
+
+        mRefsById.insert (found, ref);
+    }
+
+    void CellStore::removeMergedRef (LiveCellRefBase *ref)
+    {
+        std::vector<LiveCellRefBase*>::iterator merged = std::find (mMergedRefs.begin(), mMergedRefs.end(), ref);
+        if (merged==mMergedRefs.end())
+            return;
+        mMergedRefs.erase (merged);
+
+        const std::string& id = ref->mRef.getRefId();
+        typedef std::vector<LiveCellRefBase*>::iterator Iterator;
+        std::pair<Iterator, Iterator> range = std::equal_range (mRefsById.begin(), mRefsById.end(), id, RefIdOrder());
+
+        Iterator found = std::find (range.first, range.second, ref);
+        if (found==range.second)
+            return;
+
+        if (mRefIdIndex && range.second-range.first==1)
+            mRefIdIndex->erase (id, this);
+
+        mRefsById.erase (found);
     }
 
-    CellStore::CellStore (const ESM::Cell *cell, const MWWorld::ESMStore& esmStore, std::vector<ESM::ESMReader>& readerList)
-        : mStore(esmStore), mReader(readerList), mCell (cell), mState (State_Unloaded), mHasState (false), mLastRespawn(0,0)
+    CellStore::CellStore (const ESM::Cell *cell, const MWWorld::ESMStore& esmStore, std::vector<ESM::ESMReader>& readerList,
+        RefIdIndex *refIdIndex)
+        : mStore(esmStore), mReader(readerList), mCell (cell), mState (State_Unloaded), mHasState (false),
+          mRefIdIndex (refIdIndex), mLastRespawn(0,0)
     {
         mWaterLevel = cell->mWater;
     }
@@ -354,36 +457,46 @@ namespace MWWorld
         return searchConst (id).isEmpty();
     }
 
-    template <typename PtrType>
-    struct SearchVisitor
-    {
-        PtrType mFound;
-        std::string mIdToFind;
-        bool operator()(const PtrType& ptr)
-        {
-            if (ptr.getCellRef().getRefId() == mIdToFind)
-            {
-                mFound = ptr;
-                return false;
-            }
-            return true;
-        }
-    };
-
     Ptr CellStore::search (const std::string& id)
     {
-        SearchVisitor<MWWorld::Ptr> searchVisitor;
-        searchVisitor.mIdToFind = id;
-        forEach(searchVisitor);
-        return searchVisitor.mFound;
+        if (mState != State_Loaded)
+            return Ptr();
+
+        if (!mMergedRefs.empty())
+            mHasState = true;
+
+        typedef std::vector<LiveCellRefBase*>::const_iterator Iterator;
+        std::pair<Iterator, Iterator> range = std::equal_range (mRefsById.begin(), mRefsById.end(), id, RefIdOrder());
+
+        for (Iterator iter = range.first; iter!=range.second; ++iter)
+            if (isAccessible ((*iter)->mData, (*iter)->mRef))
+                return Ptr (*iter, this);
+
+        return Ptr();
     }
 
     ConstPtr CellStore::searchConst (const std::string& id) const
     {
-        SearchVisitor<MWWorld::ConstPtr> searchVisitor;
-        searchVisitor.mIdToFind = id;
-        forEachConst(searchVisitor);
-        return searchVisitor.mFound;
+        if (mState != State_Loaded)
+            return ConstPtr();
+
+        typedef std::vector<LiveCellRefBase*>::const_iterator Iterator;
+        std::pair<Iterator, Iterator> range = std::equal_range (mRefsById.begin(), mRefsById.end(), id, RefIdOrder());
+
+        for (Iterator iter = range.first; iter!=range.second; ++iter)
+            if (isAccessible ((*iter)->mData, (*iter)->mRef))
+                return ConstPtr (*iter, this);
+
+        return ConstPtr();
+    }
+
+    bool CellStore::contains (const LiveCellRefBase *ref) const
+    {
+        typedef std::vector<LiveCellRefBase*>::const_iterator Iterator;
+        std::pair<Iterator, Iterator> range =
+            std::equal_range (mRefsById.begin(), mRefsById.end(), ref->mRef.getRefId(), RefIdOrder());
+
+        return std::find (range.first, range.second, ref)!=range.second;
     }
 
     Ptr CellStore::searchViaActorId (int id)
@@ -433,6 +546,7 @@ namespace MWWorld
 
             loadRefs ();
 
+            mRefDecoder = NULL;
             mState = State_Loaded;
 
             // TODO: the pathgrid graph only needs to be loaded for active cells, so move this somewhere else.
@@ -451,6 +565,29 @@ namespace MWWorld
         }
     }
 
+    osg::ref_ptr<CellRefDecoder> CellStore::createRefDecoder()
+    {
+        assert (mState==State_Unloaded);
+
+        if (mCell->mContextList.empty())
+            return NULL;
+
+        mRefDecoder = new CellRefDecoder(mCell, mReader);
+        return mRefDecoder;
+    }
+
+    void CellStore::discardDecodedRefs()
+    {
+        mRefDecoder = NULL;
+    }
+
+    CellRefDecoder* CellStore::getDecodedRefs()
+    {
+        if (!mRefDecoder || !mRefDecoder->isDone() || mRefDecoder->hasFailed())
+            return NULL;
+        return mRefDecoder.get();
+    }
+
     void CellStore::listRefs()
     {
         std::vector<ESM::ESMReader>& esm = mReader;
@@ -460,37 +597,49 @@ namespace MWWorld
         if (mCell->mContextList.empty())
             return; // this is a dynamically generated cell -> skipping.
 
-        // Load references from all plugins that do something with this cell.
-        for (size_t i = 0; i < mCell->mContextList.size(); i++)
+        if (CellRefDecoder* decoded = getDecodedRefs())
         {
-            try
+            const CellRefDecoder::RefList& refs = decoded->getRefs();
+            for (CellRefDecoder::RefList::const_iterator it = refs.begin(); it != refs.end(); ++it)
             {
-                // Reopen the ESM reader and seek to the right position.
-                int index = mCell->mContextList.at(i).index;
-                mCell->restore (esm[index], i);
-
-                ESM::CellRef ref;
-
-                // Get each reference in turn
-                bool deleted = false;
-                while (mCell->getNextRef (esm[index], ref, deleted))
+                if (!it->mDeleted)
+                    mIds.push_back (Misc::StringUtils::lowerCase (it->mRef.mRefID));
+            }
+        }
+        else
+        {
+            // Load references from all plugins that do something with this cell.
+            for (size_t i = 0; i < mCell->mContextList.size(); i++)
+            {
+                try
                 {
-                    if (deleted)
-                        continue;
-
-                    // Don't list reference if it was moved to a different cell.
-                    ESM::MovedCellRefTracker::const_iterator iter =
-                        std::find(mCell->mMovedRefs.begin(), mCell->mMovedRefs.end(), ref.mRefNum);
-                    if (iter != mCell->mMovedRefs.end()) {
-                        continue;
+                    // Reopen the ESM reader and seek to the right position.
+                    int index = mCell->mContextList.at(i).index;
+                    mCell->restore (esm[index], i);
+
+                    ESM::CellRef ref;
+
+                    // Get each reference in turn
+                    bool deleted = false;
+                    while (mCell->getNextRef (esm[index], ref, deleted))
+                    {
+                        if (deleted)
+                            continue;
+
+                        // Don't list reference if it was moved to a different cell.
+                        ESM::MovedCellRefTracker::const_iterator iter =
+                            std::find(mCell->mMovedRefs.begin(), mCell->mMovedRefs.end(), ref.mRefNum);
+                        if (iter != mCell->mMovedRefs.end()) {
+                            continue;
+                        }
+
+                        mIds.push_back (Misc::StringUtils::lowerCase (ref.mRefID));
                     }
-
-                    mIds.push_back (Misc::StringUtils::lowerCase (ref.mRefID));
                 }
-            }
-            catch (std::exception& e)
-            {
-                std::cerr << "An error occurred listing references for cell " << getCell()->getDescription() << ": " << e.what() << std::endl;
+                catch (std::exception& e)
+                {
+                    std::cerr << "An error occurred listing references for cell " << getCell()->getDescription() << ": " << e.what() << std::endl;
+                }
             }
         }
 
@@ -518,35 +667,45 @@ namespace MWWorld
 
         std::map<ESM::RefNum, std::string> refNumToID; // used to detect refID modifications
 
-        // Load references from all plugins that do something with this cell.
-        for (size_t i = 0; i < mCell->mContextList.size(); i++)
+        if (CellRefDecoder* decoded = getDecodedRefs())
         {
-            try
+            // Already read in the background, only needs to be inserted
+            CellRefDecoder::RefList& refs = decoded->getRefs();
+            for (CellRefDecoder::RefList::iterator it = refs.begin(); it != refs.end(); ++it)
+                loadRef (it->mRef, it->mDeleted, refNumToID);
+        }
+        else
+        {
+            // Load references from all plugins that do something with this cell.
+            for (size_t i = 0; i < mCell->mContextList.size(); i++)
             {
-                // Reopen the ESM reader and seek to the right position.
-                int index = mCell->mContextList.at(i).index;
-                mCell->restore (esm[index], i);
-
-                ESM::CellRef ref;
-                ref.mRefNum.mContentFile = ESM::RefNum::RefNum_NoContentFile;
-
-                // Get each reference in turn
-                bool deleted = false;
-                while(mCell->getNextRef(esm[index], ref, deleted))
+                try
                 {
-                    // Don't load reference if it was moved to a different cell.
-                    ESM::MovedCellRefTracker::const_iterator iter =
-                        std::find(mCell->mMovedRefs.begin(), mCell->mMovedRefs.end(), ref.mRefNum);
-                    if (iter != mCell->mMovedRefs.end()) {
-                        continue;
+                    // Reopen the ESM reader and seek to the right position.
+                    int index = mCell->mContextList.at(i).index;
+                    mCell->restore (esm[index], i);
+
+                    ESM::CellRef ref;
+                    ref.mRefNum.mContentFile = ESM::RefNum::RefNum_NoContentFile;
+
+                    // Get each reference in turn
+                    bool deleted = false;
+                    while(mCell->getNextRef(esm[index], ref, deleted))
+                    {
+                        // Don't load reference if it was moved to a different cell.
+                        ESM::MovedCellRefTracker::const_iterator iter =
+                            std::find(mCell->mMovedRefs.begin(), mCell->mMovedRefs.end(), ref.mRefNum);
+                        if (iter != mCell->mMovedRefs.end()) {
+                            continue;
+                        }
+
+                        loadRef (ref, deleted, refNumToID);
                     }
-
-                    loadRef (ref, deleted, refNumToID);
                 }
-            }
-            catch (std::exception& e)
-            {
-                std::cerr << "An error occurred loading references for cell " << getCell()->getDescription() << ": " << e.what() << std::endl;
+                catch (std::exception& e)
+                {
+                    std::cerr << "An error occurred loading references for cell " << getCell()->getDescription() << ": " << e.what() << std::endl;
+                }
             }
         }
 
@@ -931,9 +1090,9 @@ namespace MWWorld
         return mPathgridGraph.isPointConnected(start, end);
     }
 
-    std::list<ESM::Pathgrid::Point> CellStore::aStarSearch(const int start, const int end) const
+    void CellStore::aStarSearch(const int start, const int end, std::vector<ESM::Pathgrid::Point>& path) const
     {
-        return mPathgridGraph.aStarSearch(start, end);
+        mPathgridGraph.aStarSearch(start, end, path);
     }
 
     void CellStore::setFog(ESM::FogState *fog)
@@ -11,6 +11,7 @@
 
 #include "livecellref.hpp"
 #include "cellreflist.hpp"
+#include "cellrefdecoder.hpp"
 
 #include <components/esm/loadacti.hpp>
 #include <components/esm/loadalch.hpp>
@@ -48,6 +49,7 @@ namespace ESM
 namespace MWWorld
 {
     class ESMStore;
+    class RefIdIndex;
 
     /// \brief Mutable state of a cell
     class CellStore
@@ -75,6 +77,9 @@ namespace MWWorld
             std::vector<std::string> mIds;
             float mWaterLevel;
 
+            // References read in the background, see createRefDecoder
+            osg::ref_ptr<CellRefDecoder> mRefDecoder;
+
             MWWorld::TimeStamp mLastRespawn;
 
             // List of refs owned by this cell
@@ -111,12 +116,24 @@ namespace MWWorld
             // Merged list of ref's currently in this cell - i.e. with added refs from mMovedHere, removed refs from mMovedToAnotherCell
             std::vector<LiveCellRefBase*> mMergedRefs;
 
+            // mMergedRefs sorted by ID, refs with the same ID are in the order of mMergedRefs
+            std::vector<LiveCellRefBase*> mRefsById;
+
+            // Index of the cells that hold each ID, may be NULL
+            RefIdIndex *mRefIdIndex;
+
             /// Moves object from the given cell to this cell.
             void moveFrom(const MWWorld::Ptr& object, MWWorld::CellStore* from);
 
             /// Repopulate mMergedRefs.
             void updateMergedRefs();
 
+            /// Add a single reference to mMergedRefs and mRefsById, without repopulating them.
+            void addMergedRef (LiveCellRefBase *ref);
+
+            /// Remove a single reference from mMergedRefs and mRefsById, without repopulating them.
+            void removeMergedRef (LiveCellRefBase *ref);
+
             // helper function for forEachInternal
             template<class Visitor, class List>
             bool forEachImp (Visitor& visitor, List& list)
@@ -191,14 +208,16 @@ namespace MWWorld
                 mHasState = true;
                 CellRefList<T>& list = get<T>();
                 LiveCellRefBase* ret = &list.insert(*ref);
-                updateMergedRefs();
+                addMergedRef(ret);
                 return ret;
             }
 
             /// @param readerList The readers to use for loading of the cell on-demand.
+            /// @param refIdIndex Index to keep up to date with the IDs of the references in this cell (optional)
             CellStore (const ESM::Cell *cell_,
                        const MWWorld::ESMStore& store,
-                       std::vector<ESM::ESMReader>& readerList);
+                       std::vector<ESM::ESMReader>& readerList,
+                       RefIdIndex *refIdIndex = 0);
 
             const ESM::Cell *getCell() const;
 
@@ -228,6 +247,10 @@ namespace MWWorld
             Ptr searchViaActorId (int id);
             ///< Will return an empty Ptr if cell is not loaded.
 
+            bool contains (const LiveCellRefBase *ref) const;
+            ///< Is \a ref currently in this cell (including references moved here)? Does not check
+            /// whether the reference is accessible.
+
             float getWaterLevel() const;
 
             void setWaterLevel (float level);
@@ -246,6 +269,15 @@ namespace MWWorld
             void preload ();
             ///< Build ID list from content file.
 
+            osg::ref_ptr<CellRefDecoder> createRefDecoder();
+            ///< Create a work item that reads the references of this cell in the background. Once the work item is
+            /// done, preload() and load() use its result instead of reading the content files on the calling thread.
+            /// Returns NULL if the cell has no references in content files.
+            /// @note Only valid in State_Unloaded.
+
+            void discardDecodedRefs();
+            ///< Free references read in the background that have not been inserted by load() yet.
+
             /// Call visitor (MWWorld::Ptr) for each reference. visitor must return a bool. Returning
             /// false will abort the iteration.
             /// \note Prefer using forEachConst when possible.
@@ -376,7 +408,7 @@ namespace MWWorld
 
             bool isPointConnected(const int start, const int end) const;
 
-            std::list<ESM::Pathgrid::Point> aStarSearch(const int start, const int end) const;
+            void aStarSearch(const int start, const int end, std::vector<ESM::Pathgrid::Point>& path) const;
 
         private:
 
@@ -385,6 +417,9 @@ namespace MWWorld
 
             void loadRefs();
 
+            /// Return the references read in the background, or NULL if they are not available (yet).
+            CellRefDecoder* getDecodedRefs();
+
             void loadRef (ESM::CellRef& ref, bool deleted, std::map<ESM::RefNum, std::string>& refNumToID);
             ///< Make case-adjustments to \a ref and insert it into the respective container.
             ///
@@ -21,6 +21,11 @@ struct ContentLoader
     {
     }
 
+    /// Optionally start loading the given content file in the background, ahead of the load() call for it.
+    virtual void preload(const boost::filesystem::path& filepath, int index)
+    {
+    }
+
     virtual void load(const boost::filesystem::path& filepath, int& index)
     {
       std::cout << "Loading content file " << filepath.string() << std::endl;
@@ -1,18 +1,91 @@
 #include "esmloader.hpp"
 #include "esmstore.hpp"
 
+#include <iostream>
+#include <memory>
+
 #include <components/esm/esmreader.hpp>
+#include <components/sceneutil/workqueue.hpp>
+#include <components/to_utf8/to_utf8.hpp>
 
 namespace MWWorld
 {
 
+/// Decodes the independent records of a content file on a worker thread, see ESMStore::decode.
+class DecodeContentFileWorkItem : public SceneUtil::WorkItem
+{
+public:
+    DecodeContentFileWorkItem(const MWWorld::ESMStore& store, const std::string& filename, const ToUTF8::Utf8Encoder* encoder)
+        : mStore(store)
+        , mFilename(filename)
+        , mFailed(false)
+    {
+        // The encoder keeps an internal conversion buffer, so each worker needs its own copy
+        if (encoder)
+            mEncoder.reset(new ToUTF8::Utf8Encoder(*encoder));
+    }
+
+    ~DecodeContentFileWorkItem()
+    {
+        for (std::deque<DecodedRecord*>::iterator it = mDecoded.begin(); it != mDecoded.end(); ++it)
+            delete *it;
+    }
+
+    virtual void doWork()
+    {
+        try
+        {
+            ESM::ESMReader esm;
+            esm.setEncoder(mEncoder.get());
+            esm.open(mFilename);
+            mStore.decode(esm, mDecoded);
+        }
+        catch (std::exception& e)
+        {
+            // Loading the file on the main thread will report the error
+            std::cerr << "Failed to decode content file " << mFilename << " in the background: " << e.what() << std::endl;
+            mFailed = true;
+        }
+    }
+
+    /// @note Only valid once the work item is done.
+    std::deque<DecodedRecord*>* getDecoded()
+    {
+        return mFailed ? NULL : &mDecoded;
+    }
+
+private:
+    const MWWorld::ESMStore& mStore;
+    std::string mFilename;
+    std::auto_ptr<ToUTF8::Utf8Encoder> mEncoder;
+
+    std::deque<DecodedRecord*> mDecoded;
+    bool mFailed;
+};
+
 EsmLoader::EsmLoader(MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& readers,
-  ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener)
+  ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener, int numThreads)
   : ContentLoader(listener)
   , mEsm(readers)
   , mStore(store)
   , mEncoder(encoder)
 {
+    if (numThreads > 0)
+        mWorkQueue = new SceneUtil::WorkQueue(numThreads);
+}
+
+EsmLoader::~EsmLoader()
+{
+}
+
+void EsmLoader::preload(const boost::filesystem::path& filepath, int index)
+{
+  if (!mWorkQueue)
+      return;
+
+  osg::ref_ptr<DecodeContentFileWorkItem> item (new DecodeContentFileWorkItem(mStore, filepath.string(), mEncoder));
+  mPreloaded[index] = item;
+  mWorkQueue->addWorkItem(item);
 }
 
 void EsmLoader::load(const boost::filesystem::path& filepath, int& index)
@@ -25,7 +98,18 @@ void EsmLoader::load(const boost::filesystem::path& filepath, int& index)
   lEsm.setGlobalReaderList(&mEsm);
   lEsm.open(filepath.string());
   mEsm[index] = lEsm;
-  mStore.load(mEsm[index], &mListener);
+
+  std::map<int, osg::ref_ptr<DecodeContentFileWorkItem> >::iterator preloaded = mPreloaded.find(index);
+  if (preloaded != mPreloaded.end())
+  {
+      osg::ref_ptr<DecodeContentFileWorkItem> item = preloaded->second;
+      mPreloaded.erase(preloaded);
+
+      item->waitTillDone();
+      mStore.load(mEsm[index], &mListener, item->getDecoded());
+  }
+  else
+      mStore.load(mEsm[index], &mListener);
 }
 
 } /* namespace MWWorld */
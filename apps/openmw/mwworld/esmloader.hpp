@@ -2,6 +2,9 @@
 #define ESMLOADER_HPP
 
 #include <vector>
+#include <map>
+
+#include <osg/ref_ptr>
 
 #include "contentloader.hpp"
 
@@ -15,15 +18,26 @@ namespace ESM
     class ESMReader;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWWorld
 {
 
 class ESMStore;
+class DecodeContentFileWorkItem;
 
 struct EsmLoader : public ContentLoader
 {
+    /// @param numThreads Number of worker threads decoding content files ahead of them being loaded,
+    /// see preload(). If 0, content files are loaded on the calling thread only.
     EsmLoader(MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& readers,
-      ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener);
+      ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener, int numThreads = 0);
+    ~EsmLoader();
+
+    void preload(const boost::filesystem::path& filepath, int index);
 
     void load(const boost::filesystem::path& filepath, int& index);
 
@@ -31,6 +45,9 @@ struct EsmLoader : public ContentLoader
       std::vector<ESM::ESMReader>& mEsm;
       MWWorld::ESMStore& mStore;
       ToUTF8::Utf8Encoder* mEncoder;
+
+      std::map<int, osg::ref_ptr<DecodeContentFileWorkItem> > mPreloaded;
+      osg::ref_ptr<SceneUtil::WorkQueue> mWorkQueue;
 };
 
 } /* namespace MWWorld */
@@ -2,6 +2,7 @@
 
 #include <set>
 #include <iostream>
+#include <memory>
 
 #include <boost/filesystem/operations.hpp>
 
@@ -27,7 +28,30 @@ static bool isCacheableRecord(int id)
     return false;
 }
 
-void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
+void ESMStore::decode(ESM::ESMReader &esm, std::deque<DecodedRecord*>& decoded) const
+{
+    for (size_t index = 0; esm.hasMoreRecs(); ++index)
+    {
+        ESM::NAME n = esm.getRecName();
+        esm.getRecHeader();
+
+        DecodedRecord* record = NULL;
+
+        std::map<int, StoreBase *>::const_iterator it = mStores.find(n.intval);
+        if (it != mStores.end())
+            record = it->second->decode(esm);
+
+        if (record)
+        {
+            record->mIndex = index;
+            decoded.push_back(record);
+        }
+        else
+            esm.skipRecord();
+    }
+}
+
+void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener, std::deque<DecodedRecord*>* decoded)
 {
     listener->setProgressRange(1000);
 
@@ -68,11 +92,31 @@ void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
     }
 
     // Loop through all records
-    while(esm.hasMoreRecs())
+    for (size_t index = 0; esm.hasMoreRecs(); ++index)
     {
         ESM::NAME n = esm.getRecName();
         esm.getRecHeader();
 
+        if (decoded && !decoded->empty() && decoded->front()->mIndex == index)
+        {
+            // Decoded in advance, just needs to be inserted
+            std::auto_ptr<DecodedRecord> record (decoded->front());
+            decoded->pop_front();
+            esm.skipRecord();
+
+            StoreBase* store = mStores.find(n.intval)->second;
+            RecordId id = store->insertDecoded(*record);
+            if (id.mIsDeleted)
+            {
+                store->eraseStatic(id.mId);
+                continue;
+            }
+
+            dialogue = 0;
+            listener->setProgress(static_cast<size_t>(esm.getFileOffset() / (float)esm.getFileSize() * 1000));
+            continue;
+        }
+
         // Look up the record type.
         std::map<int, StoreBase *>::iterator it = mStores.find(n.intval);
 
@@ -3,6 +3,7 @@
 
 #include <sstream>
 #include <stdexcept>
+#include <deque>
 
 #include <components/esm/records.hpp>
 #include "store.hpp"
@@ -158,7 +159,16 @@ namespace MWWorld
             mNpcs.insert(mPlayerTemplate);
         }
 
-        void load(ESM::ESMReader &esm, Loading::Listener* listener);
+        /// Decode the records of a content file that do not depend on previously loaded records,
+        /// so that loading the file with load() only needs to insert them.
+        /// @param decoded Receives the decoded records, in file order.
+        /// @note Does not modify the store. Thread safe, may run on a worker thread while other files are being loaded.
+        void decode(ESM::ESMReader &esm, std::deque<DecodedRecord*>& decoded) const;
+
+        /// Load a content file.
+        /// @param decoded Records previously decoded from this file with decode(), or NULL to decode all records now.
+        /// Records are removed from the container and deleted as they are inserted.
+        void load(ESM::ESMReader &esm, Loading::Listener* listener, std::deque<DecodedRecord*>* decoded = NULL);
 
         template <class T>
         const Store<T> &get() const {
@@ -0,0 +1,262 @@
+#ifndef OPENMW_MWWORLD_RECORDMAP_H
+#define OPENMW_MWWORLD_RECORDMAP_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+
+#include <components/misc/stringops.hpp>
+
+namespace MWWorld
+{
+    /// \brief Maps case-insensitive record IDs to records.
+    ///
+    /// Lookups go through an open addressing hash index and do not allocate. The records themselves are kept
+    /// in chunked storage and never move, so pointers to them stay valid until the record is erased.
+    template <class T>
+    class RecordMap
+    {
+        struct Slot
+        {
+            Slot() : mHash(0), mUsed(false) {}
+
+            std::string mKey;
+            size_t mHash;
+            T mRecord;
+            bool mUsed;
+        };
+        typedef std::deque<Slot> SlotList;
+
+        struct Bucket
+        {
+            size_t mHash;
+            size_t mSlot;
+        };
+
+        static const size_t sEmpty = static_cast<size_t>(-1);
+
+        SlotList mSlots;
+        std::vector<size_t> mFreeSlots;
+        std::vector<Bucket> mBuckets;
+        size_t mSize;
+
+        template <class Value, class Slots>
+        class IteratorT
+        {
+            Slots* mSlots;
+            size_t mIndex;
+
+            void skipUnused()
+            {
+                while (mIndex < mSlots->size() && !(*mSlots)[mIndex].mUsed)
+                    ++mIndex;
+            }
+
+        public:
+            IteratorT() : mSlots(NULL), mIndex(0) {}
+
+            IteratorT(Slots* slots, size_t index)
+                : mSlots(slots), mIndex(index)
+            {
+                skipUnused();
+            }
+
+            IteratorT& operator++()
+            {
+                ++mIndex;
+                skipUnused();
+                return *this;
+            }
+
+            bool operator==(const IteratorT& other) const { return mIndex == other.mIndex; }
+            bool operator!=(const IteratorT& other) const { return mIndex != other.mIndex; }
+
+            Value& operator*() const { return (*mSlots)[mIndex].mRecord; }
+            Value* operator->() const { return &(*mSlots)[mIndex].mRecord; }
+
+            /// The case-smashed ID the record was inserted with.
+            const std::string& key() const { return (*mSlots)[mIndex].mKey; }
+        };
+
+        /// Compares the stored key against an ID of any letter case.
+        struct CaseInsensitive
+        {
+            bool operator()(const std::string& key, const std::string& id) const
+            {
+                if (key.size() != id.size())
+                    return false;
+                for (size_t i = 0; i < key.size(); ++i)
+                    if (key[i] != Misc::StringUtils::toLower(id[i]))
+                        return false;
+                return true;
+            }
+        };
+
+        /// Case-insensitive hash, i.e. the same for all letter cases of an ID.
+        static size_t hash(const std::string& id)
+        {
+            return Misc::StringUtils::ciHash(id);
+        }
+
+        /// Return the bucket holding the given ID, or sEmpty.
+        size_t findBucket(const std::string& id, size_t idHash) const
+        {
+            if (mBuckets.empty())
+                return sEmpty;
+
+            const size_t mask = mBuckets.size() - 1;
+            for (size_t i = idHash & mask; mBuckets[i].mSlot != sEmpty; i = (i + 1) & mask)
+            {
+                const Bucket& bucket = mBuckets[i];
+                if (bucket.mHash == idHash && CaseInsensitive()(mSlots[bucket.mSlot].mKey, id))
+                    return i;
+            }
+            return sEmpty;
+        }
+
+        void insertBucket(size_t idHash, size_t slot)
+        {
+            const size_t mask = mBuckets.size() - 1;
+            size_t i = idHash & mask;
+            while (mBuckets[i].mSlot != sEmpty)
+                i = (i + 1) & mask;
+            mBuckets[i].mHash = idHash;
+            mBuckets[i].mSlot = slot;
+        }
+
+        void rehash(size_t numBuckets)
+        {
+            Bucket empty;
+            empty.mHash = 0;
+            empty.mSlot = sEmpty;
+            mBuckets.assign(numBuckets, empty);
+
+            for (size_t i = 0; i < mSlots.size(); ++i)
+                if (mSlots[i].mUsed)
+                    insertBucket(mSlots[i].mHash, i);
+        }
+
+        /// Remove a bucket, moving following entries of the probe sequence back so no tombstones are needed.
+        void eraseBucket(size_t i)
+        {
+            const size_t mask = mBuckets.size() - 1;
+            size_t j = i;
+            while (true)
+            {
+                j = (j + 1) & mask;
+                if (mBuckets[j].mSlot == sEmpty)
+                    break;
+
+                size_t home = mBuckets[j].mHash & mask;
+                // Move the entry back unless its home bucket lies cyclically in (i, j]
+                bool inRange = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+                if (!inRange)
+                {
+                    mBuckets[i] = mBuckets[j];
+                    i = j;
+                }
+            }
+            mBuckets[i].mSlot = sEmpty;
+        }
+
+    public:
+        typedef IteratorT<T, SlotList> iterator;
+        typedef IteratorT<const T, const SlotList> const_iterator;
+
+        RecordMap() : mSize(0) {}
+
+        iterator begin() { return iterator(&mSlots, 0); }
+        iterator end() { return iterator(&mSlots, mSlots.size()); }
+        const_iterator begin() const { return const_iterator(&mSlots, 0); }
+        const_iterator end() const { return const_iterator(&mSlots, mSlots.size()); }
+
+        size_t size() const { return mSize; }
+        bool empty() const { return mSize == 0; }
+
+        void clear()
+        {
+            mSlots.clear();
+            mFreeSlots.clear();
+            mBuckets.clear();
+            mSize = 0;
+        }
+
+        /// @param id ID in any letter case
+        /// @return the record, or NULL if there is none with this ID
+        T* search(const std::string& id)
+        {
+            size_t bucket = findBucket(id, hash(id));
+            return bucket == sEmpty ? NULL : &mSlots[mBuckets[bucket].mSlot].mRecord;
+        }
+
+        const T* search(const std::string& id) const
+        {
+            return const_cast<RecordMap*>(this)->search(id);
+        }
+
+        /// Insert a record, or overwrite the record already stored with this ID.
+        /// @param id ID in any letter case
+        /// @return the stored record, and whether it was newly inserted
+        std::pair<T*, bool> insert(const std::string& id, const T& record)
+        {
+            size_t idHash = hash(id);
+            size_t bucket = findBucket(id, idHash);
+            if (bucket != sEmpty)
+            {
+                T* stored = &mSlots[mBuckets[bucket].mSlot].mRecord;
+                *stored = record;
+                return std::make_pair(stored, false);
+            }
+
+            size_t slot;
+            if (!mFreeSlots.empty())
+            {
+                slot = mFreeSlots.back();
+                mFreeSlots.pop_back();
+            }
+            else
+            {
+                slot = mSlots.size();
+                mSlots.push_back(Slot());
+            }
+
+            Slot& stored = mSlots[slot];
+            stored.mKey = Misc::StringUtils::lowerCase(id);
+            stored.mHash = idHash;
+            stored.mRecord = record;
+            stored.mUsed = true;
+            ++mSize;
+
+            // keep the load factor at or below 0.5
+            if (mSize * 2 > mBuckets.size())
+                rehash(mBuckets.empty() ? 64 : mBuckets.size() * 2);
+            else
+                insertBucket(idHash, slot);
+
+            return std::make_pair(&stored.mRecord, true);
+        }
+
+        /// @param id ID in any letter case
+        /// @return was there a record with this ID?
+        bool erase(const std::string& id)
+        {
+            size_t bucket = findBucket(id, hash(id));
+            if (bucket == sEmpty)
+                return false;
+
+            size_t slot = mBuckets[bucket].mSlot;
+            eraseBucket(bucket);
+
+            Slot& erased = mSlots[slot];
+            erased.mKey.clear();
+            erased.mRecord = T();
+            erased.mUsed = false;
+            mFreeSlots.push_back(slot);
+            --mSize;
+            return true;
+        }
+    };
+}
+
+#endif
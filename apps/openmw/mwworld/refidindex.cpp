@@ -0,0 +1,42 @@
+#include "refidindex.hpp"
+
+#include <algorithm>
+
+namespace MWWorld
+{
+    void RefIdIndex::insert (const std::string& id, CellStore *cell)
+    {
+        CellList& cells = mCells[id];
+
+        if (std::find (cells.begin(), cells.end(), cell)==cells.end())
+            cells.push_back (cell);
+    }
+
+    void RefIdIndex::erase (const std::string& id, CellStore *cell)
+    {
+        std::map<std::string, CellList>::iterator iter = mCells.find (id);
+
+        if (iter==mCells.end())
+            return;
+
+        iter->second.erase (std::remove (iter->second.begin(), iter->second.end(), cell), iter->second.end());
+
+        if (iter->second.empty())
+            mCells.erase (iter);
+    }
+
+    const RefIdIndex::CellList *RefIdIndex::search (const std::string& id) const
+    {
+        std::map<std::string, CellList>::const_iterator iter = mCells.find (id);
+
+        if (iter==mCells.end())
+            return 0;
+
+        return &iter->second;
+    }
+
+    void RefIdIndex::clear()
+    {
+        mCells.clear();
+    }
+}
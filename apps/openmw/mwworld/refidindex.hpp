@@ -0,0 +1,39 @@
+#ifndef GAME_MWWORLD_REFIDINDEX_H
+#define GAME_MWWORLD_REFIDINDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace MWWorld
+{
+    class CellStore;
+
+    /// \brief Lists the loaded cells that hold references with a given ID
+    ///
+    /// Each CellStore keeps its entries up to date whenever its list of references changes (loading,
+    /// inserting and moving references). References that were deleted stay listed until that happens,
+    /// so the cells found here must still be searched for an accessible reference.
+    class RefIdIndex
+    {
+        public:
+
+            typedef std::vector<CellStore *> CellList;
+
+            void insert (const std::string& id, CellStore *cell);
+
+            void erase (const std::string& id, CellStore *cell);
+
+            const CellList *search (const std::string& id) const;
+            ///< Return the cells holding a reference to \a id, or NULL if there are none.
+            /// @note id must be lower case
+
+            void clear();
+
+        private:
+
+            std::map<std::string, CellList> mCells;
+    };
+}
+
+#endif
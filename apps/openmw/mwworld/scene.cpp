@@ -14,6 +14,8 @@
 #include "../mwbase/mechanicsmanager.hpp"
 #include "../mwbase/windowmanager.hpp"
 
+#include "../mwmechanics/creaturestats.hpp"
+
 #include "../mwrender/renderingmanager.hpp"
 
 #include "../mwphysics/physicssystem.hpp"
@@ -239,6 +241,15 @@ namespace MWWorld
         MWBase::Environment::get().getWorld()->getLocalScripts().clearCell (*iter);
 
         MWBase::Environment::get().getSoundManager()->stopSound (*iter);
+
+        for (std::map<int, Ptr>::iterator actorIter (mActorIds.begin()); actorIter!=mActorIds.end();)
+        {
+            if (actorIter->second.getCell()==*iter)
+                mActorIds.erase (actorIter++);
+            else
+                ++actorIter;
+        }
+
         mActiveCells.erase(*iter);
     }
 
@@ -634,10 +645,27 @@ namespace MWWorld
 
     Ptr Scene::searchPtrViaActorId (int actorId)
     {
+        std::map<int, Ptr>::iterator found = mActorIds.find (actorId);
+        if (found!=mActorIds.end())
+        {
+            const Ptr& ptr = found->second;
+
+            // the actor may have been moved to another cell or deleted since it was found
+            if (mActiveCells.find (ptr.getCell())!=mActiveCells.end() && ptr.getCell()->contains (ptr.getBase())
+                && ptr.getRefData().getCount() > 0
+                && ptr.getClass().getCreatureStats (ptr).matchesActorId (actorId))
+                return ptr;
+
+            mActorIds.erase (found);
+        }
+
         for (CellStoreCollection::const_iterator iter (mActiveCells.begin());
             iter!=mActiveCells.end(); ++iter)
             if (Ptr ptr = (*iter)->searchViaActorId (actorId))
+            {
+                mActorIds[actorId] = ptr;
                 return ptr;
+            }
 
         return Ptr();
     }
@@ -681,12 +709,12 @@ namespace MWWorld
                 try
                 {
                     if (!door.getCellRef().getDestCell().empty())
-                        preloadCell(MWBase::Environment::get().getWorld()->getInterior(door.getCellRef().getDestCell()));
+                        preloadCell(MWBase::Environment::get().getWorld()->getInterior(door.getCellRef().getDestCell(), false));
                     else
                     {
                         int x,y;
                         MWBase::Environment::get().getWorld()->positionToIndex (door.getCellRef().getDoorDest().pos[0], door.getCellRef().getDoorDest().pos[1], x, y);
-                        preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y), true);
+                        preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y,false), true);
                     }
                 }
                 catch (std::exception& e)
@@ -727,7 +755,7 @@ namespace MWWorld
                 float loadDist = 8192/2 + 8192 - mCellLoadingThreshold + mPreloadDistance;
 
                 if (dist < loadDist)
-                    preloadCell(MWBase::Environment::get().getWorld()->getExterior(cellX+dx, cellY+dy));
+                    preloadCell(MWBase::Environment::get().getWorld()->getExterior(cellX+dx, cellY+dy, false));
             }
         }
     }
@@ -743,7 +771,7 @@ namespace MWWorld
             {
                 for (int dy = -mHalfGridSize; dy <= mHalfGridSize; ++dy)
                 {
-                    mPreloader->preload(MWBase::Environment::get().getWorld()->getExterior(x+dx, y+dy), mRendering.getReferenceTime());
+                    mPreloader->preload(MWBase::Environment::get().getWorld()->getExterior(x+dx, y+dy, false), mRendering.getReferenceTime());
                     if (++numpreloaded >= mPreloader->getMaxCacheSize())
                         break;
                 }
@@ -798,12 +826,12 @@ namespace MWWorld
         for (std::vector<ESM::Transport::Dest>::const_iterator it = listVisitor.mList.begin(); it != listVisitor.mList.end(); ++it)
         {
             if (!it->mCellName.empty())
-                preloadCell(MWBase::Environment::get().getWorld()->getInterior(it->mCellName));
+                preloadCell(MWBase::Environment::get().getWorld()->getInterior(it->mCellName, false));
             else
             {
                 int x,y;
                 MWBase::Environment::get().getWorld()->positionToIndex( it->mPos.pos[0], it->mPos.pos[1], x, y);
-                preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y), true);
+                preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y,false), true);
             }
         }
     }
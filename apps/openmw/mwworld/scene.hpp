@@ -5,6 +5,7 @@
 #include "globals.hpp"
 
 #include <set>
+#include <map>
 #include <memory>
 
 namespace osg
@@ -68,6 +69,9 @@ namespace MWWorld
             bool mPreloadDoors;
             bool mPreloadFastTravel;
 
+            // Actors found by searchPtrViaActorId, valid while they stay in the active cell they were found in
+            std::map<int, Ptr> mActorIds;
+
             void insertCell (CellStore &cell, bool rescale, Loading::Listener* loadingListener);
 
             // Load and unload cells as necessary to create a cell grid with "X" and "Y" in the center
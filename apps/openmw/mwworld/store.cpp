@@ -9,6 +9,7 @@
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 
 namespace
 {
@@ -30,6 +31,14 @@ namespace
         }
     };
 
+    struct DialogueCmp
+    {
+        bool operator()(const ESM::Dialogue *x, const ESM::Dialogue *y) const
+        {
+            return Misc::StringUtils::ciLess(x->mId, y->mId);
+        }
+    };
+
     struct Compare
     {
         bool operator()(const ESM::Land *x, const ESM::Land *y) {
@@ -130,27 +139,15 @@ namespace MWWorld
     template<typename T>
     const T *Store<T>::search(const std::string &id) const
     {
-        T item;
-        item.mId = Misc::StringUtils::lowerCase(id);
-
-        typename Dynamic::const_iterator dit = mDynamic.find(item.mId);
-        if (dit != mDynamic.end()) {
-            return &dit->second;
-        }
-
-        typename std::map<std::string, T>::const_iterator it = mStatic.find(item.mId);
-
-        if (it != mStatic.end() && Misc::StringUtils::ciEqual(it->second.mId, id)) {
-            return &(it->second);
-        }
+        if (const T *ptr = mDynamic.search(id))
+            return ptr;
 
-        return 0;
+        return mStatic.search(id);
     }
     template<typename T>
     bool Store<T>::isDynamic(const std::string &id) const
     {
-        typename Dynamic::const_iterator dit = mDynamic.find(id);
-        return (dit != mDynamic.end());
+        return mDynamic.search(id) != NULL;
     }
     template<typename T>
     const T *Store<T>::searchRandom(const std::string &id) const
@@ -193,11 +190,36 @@ namespace MWWorld
         record.load(esm, isDeleted);
         Misc::StringUtils::lowerCaseInPlace(record.mId);
 
-        std::pair<typename Static::iterator, bool> inserted = mStatic.insert(std::make_pair(record.mId, record));
+        return insertLoaded(record, isDeleted);
+    }
+    template<typename T>
+    DecodedRecord *Store<T>::decode(ESM::ESMReader &esm) const
+    {
+        DecodedRecordT<T>* decoded = new DecodedRecordT<T>;
+        try
+        {
+            decoded->mRecord.load(esm, decoded->mIsDeleted);
+        }
+        catch (...)
+        {
+            delete decoded;
+            throw;
+        }
+        Misc::StringUtils::lowerCaseInPlace(decoded->mRecord.mId);
+        return decoded;
+    }
+    template<typename T>
+    RecordId Store<T>::insertDecoded(DecodedRecord &record)
+    {
+        DecodedRecordT<T>& decoded = static_cast<DecodedRecordT<T>&>(record);
+        return insertLoaded(decoded.mRecord, decoded.mIsDeleted);
+    }
+    template<typename T>
+    RecordId Store<T>::insertLoaded(const T &record, bool isDeleted)
+    {
+        std::pair<T*, bool> inserted = mStatic.insert(record.mId, record);
         if (inserted.second)
-            mShared.push_back(&inserted.first->second);
-        else
-            inserted.first->second = record;
+            mShared.push_back(inserted.first);
 
         return RecordId(record.mId, isDeleted);
     }
@@ -240,52 +262,37 @@ namespace MWWorld
     template<typename T>
     T *Store<T>::insert(const T &item)
     {
-        std::string id = Misc::StringUtils::lowerCase(item.mId);
-        std::pair<typename Dynamic::iterator, bool> result =
-            mDynamic.insert(std::pair<std::string, T>(id, item));
-        T *ptr = &result.first->second;
-        if (result.second) {
-            mShared.push_back(ptr);
-        } else {
-            *ptr = item;
-        }
-        return ptr;
+        std::pair<T*, bool> result = mDynamic.insert(item.mId, item);
+        if (result.second)
+            mShared.push_back(result.first);
+        return result.first;
     }
     template<typename T>
     T *Store<T>::insertStatic(const T &item)
     {
-        std::string id = Misc::StringUtils::lowerCase(item.mId);
-        std::pair<typename Static::iterator, bool> result =
-            mStatic.insert(std::pair<std::string, T>(id, item));
-        T *ptr = &result.first->second;
-        if (result.second) {
-            mShared.push_back(ptr);
-        } else {
-            *ptr = item;
-        }
-        return ptr;
+        std::pair<T*, bool> result = mStatic.insert(item.mId, item);
+        if (result.second)
+            mShared.push_back(result.first);
+        return result.first;
     }
     template<typename T>
     bool Store<T>::eraseStatic(const std::string &id)
     {
-        T item;
-        item.mId = Misc::StringUtils::lowerCase(id);
+        T *ptr = mStatic.search(id);
 
-        typename std::map<std::string, T>::iterator it = mStatic.find(item.mId);
-
-        if (it != mStatic.end() && Misc::StringUtils::ciEqual(it->second.mId, id)) {
+        if (ptr) {
             // delete from the static part of mShared
             typename std::vector<T *>::iterator sharedIter = mShared.begin();
             typename std::vector<T *>::iterator end = sharedIter + mStatic.size();
 
             while (sharedIter != mShared.end() && sharedIter != end) {
-                if((*sharedIter)->mId == item.mId) {
+                if (*sharedIter == ptr) {
                     mShared.erase(sharedIter);
                     break;
                 }
                 ++sharedIter;
             }
-            mStatic.erase(it);
+            mStatic.erase(id);
         }
 
         return true;
@@ -294,19 +301,19 @@ namespace MWWorld
     template<typename T>
     bool Store<T>::erase(const std::string &id)
     {
-        std::string key = Misc::StringUtils::lowerCase(id);
-        typename Dynamic::iterator it = mDynamic.find(key);
-        if (it == mDynamic.end()) {
+        T *ptr = mDynamic.search(id);
+        if (!ptr) {
             return false;
         }
-        mDynamic.erase(it);
 
-        // have to reinit the whole shared part
+        // delete from the dynamic part of mShared
         assert(mShared.size() >= mStatic.size());
-        mShared.erase(mShared.begin() + mStatic.size(), mShared.end());
-        for (it = mDynamic.begin(); it != mDynamic.end(); ++it) {
-            mShared.push_back(&it->second);
-        }
+        typename std::vector<T *>::iterator sharedIter =
+            std::find(mShared.begin() + mStatic.size(), mShared.end(), ptr);
+        if (sharedIter != mShared.end())
+            mShared.erase(sharedIter);
+
+        mDynamic.erase(id);
         return true;
     }
     template<typename T>
@@ -321,7 +328,7 @@ namespace MWWorld
              ++iter)
         {
             writer.startRecord (T::sRecordId);
-            iter->second.save (writer);
+            iter->save (writer);
             writer.endRecord (T::sRecordId);
         }
     }
@@ -1033,16 +1040,24 @@ namespace MWWorld
         // structure is kept intact for inserting further INFOs. Delete them now that loading is done.
         for (Static::iterator it = mStatic.begin(); it != mStatic.end(); ++it)
         {
-            ESM::Dialogue& dial = it->second;
+            ESM::Dialogue& dial = *it;
             dial.clearDeletedInfos();
         }
 
         mShared.clear();
         mShared.reserve(mStatic.size());
-        std::map<std::string, ESM::Dialogue>::iterator it = mStatic.begin();
-        for (; it != mStatic.end(); ++it) {
-            mShared.push_back(&(it->second));
+        for (Static::iterator it = mStatic.begin(); it != mStatic.end(); ++it) {
+            mShared.push_back(&*it);
         }
+        // dialogues are listed in alphabetical order
+        std::sort(mShared.begin(), mShared.end(), DialogueCmp());
+    }
+
+    template <>
+    DecodedRecord *Store<ESM::Dialogue>::decode(ESM::ESMReader &esm) const
+    {
+        // Dialogue records merge into previously loaded ones, see load()
+        return NULL;
     }
 
     template <>
@@ -1053,17 +1068,16 @@ namespace MWWorld
 
         dialogue.loadId(esm);
 
-        std::string idLower = Misc::StringUtils::lowerCase(dialogue.mId);
-        std::map<std::string, ESM::Dialogue>::iterator found = mStatic.find(idLower);
-        if (found == mStatic.end())
+        ESM::Dialogue* found = mStatic.search(dialogue.mId);
+        if (!found)
         {
             dialogue.loadData(esm, isDeleted);
-            mStatic.insert(std::make_pair(idLower, dialogue));
+            mStatic.insert(dialogue.mId, dialogue);
         }
         else
         {
-            found->second.loadData(esm, isDeleted);
-            dialogue = found->second;
+            found->loadData(esm, isDeleted);
+            dialogue = *found;
         }
 
         return RecordId(dialogue.mId, isDeleted);
@@ -6,6 +6,7 @@
 #include <map>
 
 #include "recordcmp.hpp"
+#include "recordmap.hpp"
 
 namespace ESM
 {
@@ -27,6 +28,25 @@ namespace MWWorld
         RecordId(const std::string &id = "", bool isDeleted = false);
     };
 
+    /// A record decoded ahead of being inserted into its store, see StoreBase::decode.
+    struct DecodedRecord
+    {
+        /// Position of the record within its content file
+        size_t mIndex;
+
+        DecodedRecord() : mIndex(0) {}
+        virtual ~DecodedRecord() {}
+    };
+
+    template <class T>
+    struct DecodedRecordT : public DecodedRecord
+    {
+        T mRecord;
+        bool mIsDeleted;
+
+        DecodedRecordT() : mIsDeleted(false) {}
+    };
+
     class StoreBase
     {
     public:
@@ -41,6 +61,14 @@ namespace MWWorld
         virtual int getDynamicSize() const { return 0; }
         virtual RecordId load(ESM::ESMReader &esm) = 0;
 
+        /// Decode a record without touching the store, so that it can be inserted later on with insertDecoded().
+        /// Returns NULL, without reading anything, for stores whose records depend on the previously loaded records.
+        /// @note Must be thread safe, may be called from worker threads while other content files are being loaded.
+        virtual DecodedRecord* decode(ESM::ESMReader &esm) const { return NULL; }
+
+        /// Insert a record previously returned by decode(). Equivalent to load() on the same record.
+        virtual RecordId insertDecoded(DecodedRecord &record) { return RecordId(); }
+
         virtual bool eraseStatic(const std::string &id) {return false;}
         virtual void clearDynamic() {}
 
@@ -138,14 +166,14 @@ namespace MWWorld
     template <class T>
     class Store : public StoreBase
     {
-        std::map<std::string, T>      mStatic;
+        RecordMap<T>        mStatic;
         std::vector<T *>    mShared; // Preserves the record order as it came from the content files (this
                                      // is relevant for the spell autocalc code and selection order
                                      // for heads/hairs in the character creation)
-        std::map<std::string, T> mDynamic;
+        RecordMap<T>        mDynamic;
 
-        typedef std::map<std::string, T> Dynamic;
-        typedef std::map<std::string, T> Static;
+        typedef RecordMap<T> Dynamic;
+        typedef RecordMap<T> Static;
 
         friend class ESMStore;
 
@@ -192,8 +220,13 @@ namespace MWWorld
         bool erase(const T &item);
 
         RecordId load(ESM::ESMReader &esm);
+        DecodedRecord* decode(ESM::ESMReader &esm) const;
+        RecordId insertDecoded(DecodedRecord &record);
         void write(ESM::ESMWriter& writer, Loading::Listener& progress) const;
         RecordId read(ESM::ESMReader& reader);
+
+    private:
+        RecordId insertLoaded(const T &record, bool isDeleted);
     };
 
     template <>
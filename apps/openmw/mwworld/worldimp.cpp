@@ -15,6 +15,8 @@
 
 #include <components/sceneutil/positionattitudetransform.hpp>
 
+#include <components/settings/settings.hpp>
+
 #include "../mwbase/environment.hpp"
 #include "../mwbase/soundmanager.hpp"
 #include "../mwbase/mechanicsmanager.hpp"
@@ -28,6 +30,7 @@
 #include "../mwmechanics/levelledlist.hpp"
 #include "../mwmechanics/combat.hpp"
 #include "../mwmechanics/aiavoiddoor.hpp" //Used to tell actors to avoid doors
+#include "../mwmechanics/exteriorpathgrid.hpp"
 
 #include "../mwrender/animation.hpp"
 #include "../mwrender/renderingmanager.hpp"
@@ -84,6 +87,13 @@ namespace MWWorld
             return mLoaders.insert(std::make_pair(extension, loader)).second;
         }
 
+        void preload(const boost::filesystem::path& filepath, int index)
+        {
+            LoadersContainer::iterator it(mLoaders.find(Misc::StringUtils::lowerCase(filepath.extension().string())));
+            if (it != mLoaders.end())
+                it->second->preload(filepath, index);
+        }
+
         void load(const boost::filesystem::path& filepath, int& index)
         {
             LoadersContainer::iterator it(mLoaders.find(Misc::StringUtils::lowerCase(filepath.extension().string())));
@@ -162,7 +172,7 @@ namespace MWWorld
         listener->loadingOn();
 
         GameContentLoader gameContentLoader(*listener);
-        EsmLoader esmLoader(mStore, mEsm, encoder, *listener);
+        EsmLoader esmLoader(mStore, mEsm, encoder, *listener, Settings::Manager::getInt("content loading threads", "General"));
 
         gameContentLoader.addLoader(".esm", &esmLoader);
         gameContentLoader.addLoader(".esp", &esmLoader);
@@ -183,6 +193,8 @@ namespace MWWorld
         mStore.setUp();
         mStore.movePlayerRecord();
 
+        mExteriorPathgridGraph.reset(new MWMechanics::ExteriorPathgridGraph(mStore));
+
         mSwimHeightScale = mStore.get<ESM::GameSetting>().find("fSwimHeightScale")->getFloat();
 
         mWeatherManager = new MWWorld::WeatherManager(*mRendering, mFallback, mStore);
@@ -508,14 +520,14 @@ namespace MWWorld
         return &mFallback;
     }
 
-    CellStore *World::getExterior (int x, int y)
+    CellStore *World::getExterior (int x, int y, bool forceLoad)
     {
-        return mCells.getExterior (x, y);
+        return mCells.getExterior (x, y, forceLoad);
     }
 
-    CellStore *World::getInterior (const std::string& name)
+    CellStore *World::getInterior (const std::string& name, bool forceLoad)
     {
-        return mCells.getInterior (name);
+        return mCells.getInterior (name, forceLoad);
     }
 
     CellStore *World::getCell (const ESM::CellId& id)
@@ -547,6 +559,11 @@ namespace MWWorld
         return mStore;
     }
 
+    const MWMechanics::ExteriorPathgridGraph& World::getExteriorPathgridGraph() const
+    {
+        return *mExteriorPathgridGraph;
+    }
+
     std::vector<ESM::ESMReader>& World::getEsmReader()
     {
         return mEsm;
@@ -631,16 +648,10 @@ namespace MWWorld
 
         std::string lowerCaseName = Misc::StringUtils::lowerCase(name);
 
-        for (Scene::CellStoreCollection::const_iterator iter (mWorldScene->getActiveCells().begin());
-            iter!=mWorldScene->getActiveCells().end(); ++iter)
-        {
-            // TODO: caching still doesn't work efficiently here (only works for the one CellStore that the reference is in)
-            CellStore* cellstore = *iter;
-            Ptr ptr = mCells.getPtr (lowerCaseName, *cellstore, false);
-
-            if (!ptr.isEmpty())
-                return ptr;
-        }
+        // only the active cells the reference index lists for this ID are searched
+        ret = mCells.getPtr (lowerCaseName, mWorldScene->getActiveCells());
+        if (!ret.isEmpty())
+            return ret;
 
         if (!activeOnly)
         {
@@ -2561,6 +2572,16 @@ namespace MWWorld
     void World::loadContentFiles(const Files::Collections& fileCollections,
         const std::vector<std::string>& content, ContentLoader& contentLoader)
     {
+        // Give the loaders a chance to start working on all files in the background
+        int preloadIdx = 0;
+        for (std::vector<std::string>::const_iterator it = content.begin(); it != content.end(); ++it, ++preloadIdx)
+        {
+            boost::filesystem::path filename(*it);
+            const Files::MultiDirCollection& col = fileCollections.getCollection(filename.extension().string());
+            if (col.doesExist(*it))
+                contentLoader.preload(col.getPath(*it), preloadIdx);
+        }
+
         std::vector<std::string>::const_iterator it(content.begin());
         std::vector<std::string>::const_iterator end(content.end());
         for (int idx = 0; it != end; ++it, ++idx)
@@ -97,6 +97,8 @@ namespace MWWorld
 
             boost::shared_ptr<ProjectileManager> mProjectileManager;
 
+            boost::shared_ptr<MWMechanics::ExteriorPathgridGraph> mExteriorPathgridGraph;
+
             bool mGodMode;
             bool mScriptsEnabled;
             std::vector<std::string> mContentFiles;
@@ -200,9 +202,9 @@ namespace MWWorld
             virtual void readRecord (ESM::ESMReader& reader, uint32_t type,
                 const std::map<int, int>& contentFileMap);
 
-            virtual CellStore *getExterior (int x, int y);
+            virtual CellStore *getExterior (int x, int y, bool forceLoad = true);
 
-            virtual CellStore *getInterior (const std::string& name);
+            virtual CellStore *getInterior (const std::string& name, bool forceLoad = true);
 
             virtual CellStore *getCell (const ESM::CellId& id);
 
@@ -223,6 +225,9 @@ namespace MWWorld
 
             virtual const MWWorld::ESMStore& getStore() const;
 
+            virtual const MWMechanics::ExteriorPathgridGraph& getExteriorPathgridGraph() const;
+            ///< Routes between the pathgrids of exterior cells.
+
             virtual std::vector<ESM::ESMReader>& getEsmReader();
 
             virtual LocalScripts& getLocalScripts();
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "components/esm/esmcommon.hpp"
+#include "components/esm/refid.hpp"
 
 TEST(EsmFixedString, operator__eq_ne)
 {
@@ -73,3 +74,36 @@ TEST(EsmFixedString, DISABLED_is_pod)
      * ASSERT_TRUE(std::is_pod<ESM::NAME256>::value);
      */
 }
+
+TEST(EsmRefId, interning)
+{
+    ESM::RefId id ("Fargoth");
+    EXPECT_TRUE(id == ESM::RefId("fargoth"));
+    EXPECT_TRUE(id == ESM::RefId("FARGOTH"));
+    EXPECT_TRUE(id != ESM::RefId("fargoth_"));
+    EXPECT_EQ(id.getHash(), ESM::RefId("fArGoTh").getHash());
+    EXPECT_EQ("fargoth", id.toString());
+
+    // equal IDs share one pool entry, so the order is consistent too
+    EXPECT_FALSE(id < ESM::RefId("FarGoth"));
+    EXPECT_FALSE(ESM::RefId("FarGoth") < id);
+}
+
+TEST(EsmRefId, empty)
+{
+    EXPECT_TRUE(ESM::RefId().empty());
+    EXPECT_TRUE(ESM::RefId("").empty());
+    EXPECT_TRUE(ESM::RefId() == ESM::RefId(""));
+    EXPECT_TRUE(ESM::RefId() != ESM::RefId("a"));
+    EXPECT_EQ("", ESM::RefId().toString());
+}
+
+TEST(EsmRefId, equals)
+{
+    ESM::RefId id ("Fargoth");
+    EXPECT_TRUE(id.equals("fargoth"));
+    EXPECT_TRUE(id.equals("FARGOTH"));
+    EXPECT_FALSE(id.equals("fargot"));
+    EXPECT_TRUE(ESM::RefId().equals(""));
+    EXPECT_FALSE(ESM::RefId().equals("fargoth"));
+}
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <sstream>
+
 #include <boost/filesystem/fstream.hpp>
 
 #include <components/files/configurationmanager.hpp>
@@ -313,3 +315,69 @@ TEST_F(StoreTest, overwrite_test)
 
     ASSERT_TRUE (overwrittenRec && overwrittenRec->mModel == "the_new_model");
 }
+
+/// Tests case-insensitive lookup of records.
+TEST(RecordStoreTest, search_test)
+{
+    typedef ESM::Apparatus RecordType;
+
+    RecordType record;
+    record.blank();
+    record.mId = "Foobar";
+
+    MWWorld::Store<RecordType> store;
+    const RecordType* inserted = store.insertStatic(record);
+
+    ASSERT_TRUE (store.search("foobar") == inserted);
+    ASSERT_TRUE (store.search("FOOBAR") == inserted);
+    ASSERT_TRUE (store.search("fooba") == NULL);
+
+    // dynamic records take precedence
+    record.mModel = "dynamic";
+    const RecordType* dynamic = store.insert(record);
+    ASSERT_TRUE (store.search("FooBar") == dynamic);
+    ASSERT_TRUE (store.isDynamic("foobar"));
+
+    ASSERT_TRUE (store.erase("FOOBAR"));
+    ASSERT_TRUE (store.search("foobar") == inserted);
+    ASSERT_TRUE (store.getSize() == 1);
+}
+
+/// Tests that records stay in place while other records are inserted and erased.
+TEST(RecordStoreTest, pointer_stability_test)
+{
+    typedef ESM::Apparatus RecordType;
+
+    MWWorld::Store<RecordType> store;
+
+    std::vector<const RecordType*> records;
+    for (int i=0; i<1000; ++i)
+    {
+        RecordType record;
+        record.blank();
+        std::ostringstream id;
+        id << "Record_" << i;
+        record.mId = id.str();
+        records.push_back(store.insertStatic(record));
+    }
+
+    for (int i=0; i<1000; i+=2)
+    {
+        std::ostringstream id;
+        id << "record_" << i;
+        store.eraseStatic(id.str());
+    }
+
+    ASSERT_TRUE (store.getSize() == 500);
+
+    for (int i=0; i<1000; ++i)
+    {
+        std::ostringstream id;
+        id << "RECORD_" << i;
+        const RecordType* found = store.search(id.str());
+        if (i % 2 == 0)
+            ASSERT_TRUE (found == NULL);
+        else
+            ASSERT_TRUE (found == records[i]);
+    }
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <components/files/memorystream.hpp>
+#include <components/vfs/archive.hpp>
+#include <components/vfs/manager.hpp>
+
+namespace
+{
+    struct TestFile : public VFS::File
+    {
+        TestFile(const std::string& contents) : mContents(contents) {}
+
+        virtual Files::IStreamPtr open()
+        {
+            return Files::IStreamPtr(new Files::IMemStream(mContents.data(), mContents.size()));
+        }
+
+        std::string mContents;
+    };
+
+    struct TestArchive : public VFS::Archive
+    {
+        ~TestArchive()
+        {
+            for (std::map<std::string, TestFile*>::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+                delete it->second;
+        }
+
+        void add(const std::string& name, const std::string& contents)
+        {
+            mFiles[name] = new TestFile(contents);
+        }
+
+        virtual void listResources(std::map<std::string, VFS::File*>& out, char (*normalize_function) (char))
+        {
+            for (std::map<std::string, TestFile*>::iterator it = mFiles.begin(); it != mFiles.end(); ++it)
+            {
+                std::string name = it->first;
+                std::transform(name.begin(), name.end(), name.begin(), normalize_function);
+                out[name] = it->second;
+            }
+        }
+
+        std::map<std::string, TestFile*> mFiles;
+    };
+
+    std::string readAll(Files::IStreamPtr stream)
+    {
+        return std::string(std::istreambuf_iterator<char>(*stream), std::istreambuf_iterator<char>());
+    }
+
+    struct VFSManagerTest : public ::testing::Test
+    {
+        VFSManagerTest()
+            : mManager(false)
+        {
+            TestArchive* first = new TestArchive;
+            first->add("Meshes\\Foo.nif", "first");
+            first->add("textures/bar.dds", "bar");
+            for (int i=0; i<100; ++i)
+            {
+                std::ostringstream stream;
+                stream << "meshes\\generated" << i << ".NIF";
+                first->add(stream.str(), stream.str());
+            }
+            TestArchive* second = new TestArchive;
+            second->add("meshes/foo.nif", "second");
+
+            mManager.addArchive(first);
+            mManager.addArchive(second);
+            mManager.buildIndex();
+        }
+
+        VFS::Manager mManager;
+    };
+}
+
+TEST_F(VFSManagerTest, lookup_should_be_case_and_separator_insensitive)
+{
+    EXPECT_TRUE(mManager.exists("MESHES\\FOO.NIF"));
+    EXPECT_TRUE(mManager.exists("Textures/Bar.dds"));
+    EXPECT_TRUE(mManager.exists("meshes/generated42.nif"));
+    EXPECT_FALSE(mManager.exists("meshes/foo.ni"));
+    EXPECT_FALSE(mManager.exists("meshes/generated100.nif"));
+    EXPECT_FALSE(mManager.exists(""));
+}
+
+TEST_F(VFSManagerTest, later_archives_should_take_priority)
+{
+    EXPECT_EQ("second", readAll(mManager.get("Meshes\\Foo.nif")));
+    EXPECT_EQ("second", readAll(mManager.getNormalized("meshes/foo.nif")));
+}
+
+TEST_F(VFSManagerTest, getNormalized_should_not_normalize)
+{
+    EXPECT_THROW(mManager.getNormalized("Meshes/foo.nif"), std::runtime_error);
+}
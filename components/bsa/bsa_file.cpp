@@ -24,10 +24,13 @@
 #include "bsa_file.hpp"
 
 #include <stdexcept>
+#include <iostream>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/fstream.hpp>
 
+#include <components/files/memorystream.hpp>
+
 using namespace std;
 using namespace Bsa;
 
@@ -160,10 +163,41 @@ int BSAFile::getIndex(const char *str) const
 }
 
 /// Open an archive file.
-void BSAFile::open(const string &file)
+void BSAFile::open(const string &file, bool memoryMapped)
 {
     filename = file;
     readHeader();
+
+    if (memoryMapped)
+    {
+        try
+        {
+            mappedFile.open(filename.c_str());
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Warning: " << e.what() << ", falling back to regular file access" << std::endl;
+            return;
+        }
+
+        // the archive may have been modified in between
+        for (FileList::const_iterator it = files.begin(); it != files.end(); ++it)
+        {
+            if (it->offset + it->fileSize > mappedFile.getSize())
+            {
+                mappedFile.close();
+                fail("Archive contains offsets outside itself");
+            }
+        }
+    }
+}
+
+Files::IStreamPtr BSAFile::openStream(const FileStruct &file) const
+{
+    if (mappedFile.isOpen())
+        return Files::IStreamPtr(new Files::IMemStream(mappedFile.getData() + file.offset, file.fileSize));
+
+    return Files::openConstrainedFileStream (filename.c_str (), file.offset, file.fileSize);
 }
 
 Files::IStreamPtr BSAFile::getFile(const char *file)
@@ -173,12 +207,10 @@ Files::IStreamPtr BSAFile::getFile(const char *file)
     if(i == -1)
         fail("File not found: " + string(file));
 
-    const FileStruct &fs = files[i];
-
-    return Files::openConstrainedFileStream (filename.c_str (), fs.offset, fs.fileSize);
+    return openStream(files[i]);
 }
 
 Files::IStreamPtr BSAFile::getFile(const FileStruct *file)
 {
-    return Files::openConstrainedFileStream (filename.c_str (), file->offset, file->fileSize);
+    return openStream(*file);
 }
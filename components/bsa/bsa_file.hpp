@@ -32,6 +32,7 @@
 #include <components/misc/stringops.hpp>
 
 #include <components/files/constrainedfilestream.hpp>
+#include <components/files/memorymappedfile.hpp>
 
 
 namespace Bsa
@@ -69,6 +70,9 @@ private:
     /// Used for error messages
     std::string filename;
 
+    /// Mapping of the whole archive, if memory mapping was requested and is available
+    Files::MemoryMappedFile mappedFile;
+
     /// Case insensitive string comparison
     struct iltstr
     {
@@ -93,6 +97,10 @@ private:
     /// @note Thread safe.
     int getIndex(const char *str) const;
 
+    /// Open a stream over the given file's data
+    /// @note Thread safe.
+    Files::IStreamPtr openStream(const FileStruct &file) const;
+
 public:
     /* -----------------------------------
      * BSA management methods
@@ -104,7 +112,14 @@ public:
     { }
 
     /// Open an archive file.
-    void open(const std::string &file);
+    /// @param memoryMapped Map the archive into memory once and serve the contained files from the mapping,
+    /// instead of opening a new file handle for each of them. Falls back to regular file streams if the
+    /// archive can not be mapped.
+    void open(const std::string &file, bool memoryMapped=false);
+
+    /// Is the archive served from a memory mapping?
+    bool isMemoryMapped() const
+    { return mappedFile.isOpen(); }
 
     /* -----------------------------------
      * Archive file routines
@@ -3,6 +3,10 @@
 
 namespace Compiler
 {
+    /// Version of the code generated for scripts, including the opcode numbers below. Increase it whenever
+    /// generated code changes, so compiled scripts cached by an older build are not used anymore.
+    const int sCodeVersion = 1;
+
     namespace Ai
     {
         const int opcodeAiTravel = 0x20000;
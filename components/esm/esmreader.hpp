@@ -262,6 +262,7 @@ public:
 
   /// Sets font encoder for ESM strings
   void setEncoder(ToUTF8::Utf8Encoder* encoder);
+  ToUTF8::Utf8Encoder* getEncoder() const { return mEncoder; }
 
   /// Get record flags of last record
   unsigned int getRecordFlags() { return mRecordFlags; }
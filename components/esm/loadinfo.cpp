@@ -63,6 +63,8 @@ namespace ESM
                     SelectStruct ss;
                     ss.mSelectRule = esm.getHString();
                     ss.mValue.read(esm, Variant::Format_Info);
+                    if (ss.mSelectRule.size() > 5)
+                        ss.mName = RefId(ss.mSelectRule.substr(5));
                     mSelects.push_back(ss);
                     break;
                 }
@@ -90,6 +92,11 @@ namespace ESM
                     break;
             }
         }
+
+        mActorId = RefId(mActor);
+        mRaceId = RefId(mRace);
+        mClassId = RefId(mClass);
+        mFactionId = RefId(mFaction);
     }
 
     void DialInfo::save(ESMWriter &esm, bool isDeleted) const
@@ -149,6 +156,10 @@ namespace ESM
         mFaction.clear();
         mPcFaction.clear();
         mCell.clear();
+        mActorId = RefId();
+        mRaceId = RefId();
+        mClassId = RefId();
+        mFactionId = RefId();
         mSound.clear();
         mResponse.clear();
         mResultScript.clear();
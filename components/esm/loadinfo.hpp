@@ -6,6 +6,7 @@
 
 #include "defs.hpp"
 #include "variant.hpp"
+#include "refid.hpp"
 
 namespace ESM
 {
@@ -51,6 +52,8 @@ struct DialInfo
     {
         std::string mSelectRule; // This has a complicated format
         Variant mValue;
+
+        RefId mName; // Interned name part of mSelectRule, set by load()
     };
 
     // Journal quest indices (introduced with the quest system in Tribunal)
@@ -72,6 +75,9 @@ struct DialInfo
     // Various references used in determining when to select this item.
     std::string mActor, mRace, mClass, mFaction, mPcFaction, mCell;
 
+    // Interned versions of the above, set by load() for fast matching
+    RefId mActorId, mRaceId, mClassId, mFactionId;
+
     // Sound and text associated with this item
     std::string mSound, mResponse;
 
@@ -0,0 +1,60 @@
+#include "refid.hpp"
+
+#include <map>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <components/misc/stringops.hpp>
+
+namespace
+{
+    typedef std::map<std::string, ESM::RefId::Entry> Pool;
+
+    // Entries are stored in the map nodes, which never move
+    Pool sPool;
+    OpenThreads::Mutex sPoolMutex;
+
+    const std::string sEmpty;
+}
+
+namespace ESM
+{
+    RefId::RefId()
+        : mEntry(NULL)
+    {
+    }
+
+    RefId::RefId(const std::string& id)
+        : mEntry(NULL)
+    {
+        if (id.empty())
+            return;
+
+        std::string key = Misc::StringUtils::lowerCase(id);
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(sPoolMutex);
+        std::pair<Pool::iterator, bool> inserted = sPool.insert(std::make_pair(key, Entry()));
+        if (inserted.second)
+        {
+            inserted.first->second.mId = &inserted.first->first;
+            inserted.first->second.mHash = Misc::StringUtils::ciHash(key);
+        }
+        mEntry = &inserted.first->second;
+    }
+
+    const std::string& RefId::toString() const
+    {
+        return mEntry ? *mEntry->mId : sEmpty;
+    }
+
+    size_t RefId::getHash() const
+    {
+        return mEntry ? mEntry->mHash : 0;
+    }
+
+    bool RefId::equals(const std::string& id) const
+    {
+        return Misc::StringUtils::ciEqual(toString(), id);
+    }
+}
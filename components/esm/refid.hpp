@@ -0,0 +1,50 @@
+#ifndef OPENMW_ESM_REFID_H
+#define OPENMW_ESM_REFID_H
+
+#include <string>
+
+namespace ESM
+{
+    /// \brief Case-insensitive record identifier, interned in a global pool.
+    ///
+    /// All RefIds created from strings that only differ in letter case share one pool entry, so comparing RefIds
+    /// is a pointer comparison and the hash comes for free. Interning takes a lock and a lookup, so RefIds should
+    /// be created once (e.g. when loading a record) rather than for every comparison.
+    /// @note Pool entries are never freed.
+    class RefId
+    {
+    public:
+        /// The empty ID.
+        RefId();
+
+        /// Intern the given ID. Thread safe.
+        explicit RefId(const std::string& id);
+
+        bool empty() const { return mEntry == NULL; }
+
+        /// The case-smashed ID.
+        const std::string& toString() const;
+
+        size_t getHash() const;
+
+        bool operator==(const RefId& other) const { return mEntry == other.mEntry; }
+        bool operator!=(const RefId& other) const { return mEntry != other.mEntry; }
+
+        /// Consistent order for use in ordered containers. This is not the alphabetical order.
+        bool operator<(const RefId& other) const { return mEntry < other.mEntry; }
+
+        /// Case-insensitive comparison with an ID that has not been interned.
+        bool equals(const std::string& id) const;
+
+        struct Entry
+        {
+            const std::string* mId;
+            size_t mHash;
+        };
+
+    private:
+        const Entry* mEntry;
+    };
+}
+
+#endif
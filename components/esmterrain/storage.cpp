@@ -199,6 +199,9 @@ namespace ESMTerrain
                 colStart += (origin.y() - startCellY) * ESM::Land::LAND_SIZE;
                 int rowEnd = rowStart + std::min(1.f, size) * (ESM::Land::LAND_SIZE-1) + 1;
                 int colEnd = colStart + std::min(1.f, size) * (ESM::Land::LAND_SIZE-1) + 1;
+                // The skipped first row / column of a chunk spanning multiple cells would otherwise push the end past the cell
+                rowEnd = std::min(rowEnd, static_cast<int>(ESM::Land::LAND_SIZE));
+                colEnd = std::min(colEnd, static_cast<int>(ESM::Land::LAND_SIZE));
 
                 vertY = vertY_;
                 for (int col=colStart; col<colEnd; col += increment)
@@ -416,6 +419,40 @@ namespace ESMTerrain
         }
     }
 
+    void Storage::getLayerIndices(float size, const osg::Vec2f &center, int resolution,
+        std::vector<unsigned short> &layerIndices, std::vector<Terrain::LayerInfo> &layerList)
+    {
+        osg::Vec2f origin = center - osg::Vec2f(size/2.f, size/2.f);
+
+        std::map<UniqueTextureId, unsigned short> textureIndicesMap;
+
+        layerIndices.resize(resolution*resolution);
+        for (int y=0; y<resolution; ++y)
+        {
+            for (int x=0; x<resolution; ++x)
+            {
+                // the texel of the whole landscape at the center of this sample
+                int texelX = static_cast<int>(std::floor((origin.x() + (x + 0.5f) / resolution * size) * ESM::Land::LAND_TEXTURE_SIZE));
+                int texelY = static_cast<int>(std::floor((origin.y() + (y + 0.5f) / resolution * size) * ESM::Land::LAND_TEXTURE_SIZE));
+
+                int cellX = static_cast<int>(std::floor(texelX / static_cast<float>(ESM::Land::LAND_TEXTURE_SIZE)));
+                int cellY = static_cast<int>(std::floor(texelY / static_cast<float>(ESM::Land::LAND_TEXTURE_SIZE)));
+
+                // getVtexIndexAt expects the column shifted by one, like the blendmaps use it
+                UniqueTextureId id = getVtexIndexAt(cellX, cellY, texelX - cellX * ESM::Land::LAND_TEXTURE_SIZE + 1,
+                                                    texelY - cellY * ESM::Land::LAND_TEXTURE_SIZE);
+
+                std::map<UniqueTextureId, unsigned short>::const_iterator found = textureIndicesMap.find(id);
+                if (found == textureIndicesMap.end())
+                {
+                    found = textureIndicesMap.insert(std::make_pair(id, static_cast<unsigned short>(layerList.size()))).first;
+                    layerList.push_back(getLayerInfo(getTextureName(id)));
+                }
+                layerIndices[y*resolution + x] = found->second;
+            }
+        }
+    }
+
     float Storage::getHeightAt(const osg::Vec3f &worldPos)
     {
         int cellX = static_cast<int>(std::floor(worldPos.x() / 8192.f));
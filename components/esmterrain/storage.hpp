@@ -78,6 +78,18 @@ namespace ESMTerrain
                            ImageVector& blendmaps,
                            std::vector<Terrain::LayerInfo>& layerList);
 
+        /// Sample which texture layer covers each point of a terrain region, e.g. to create a composite map of it.
+        /// @note May be called from background threads.
+        /// @param size size of the region in cell units
+        /// @param center center of the region in cell units
+        /// @param resolution number of samples along each side. The samples are evenly spaced and written row by row,
+        ///        starting at the minimum x / y.
+        /// @param layerIndices index into \a layerList of each sample will be written here
+        /// @param layerList the layers used will be written here
+        virtual void getLayerIndices (float size, const osg::Vec2f& center, int resolution,
+                              std::vector<unsigned short>& layerIndices,
+                              std::vector<Terrain::LayerInfo>& layerList);
+
         virtual float getHeightAt (const osg::Vec3f& worldPos);
 
         virtual Terrain::LayerInfo getDefaultLayer();
@@ -0,0 +1,170 @@
+#include "memorymappedfile.hpp"
+
+#include <stdexcept>
+#include <sstream>
+#include <cassert>
+
+#if FILE_API == FILE_API_POSIX
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#elif FILE_API == FILE_API_WIN32
+#include <boost/locale.hpp>
+#endif
+
+namespace Files
+{
+
+MemoryMappedFile::MemoryMappedFile()
+    : mData(NULL)
+    , mSize(0)
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (mData != NULL)
+        close();
+}
+
+bool MemoryMappedFile::isOpen() const
+{
+    return mData != NULL;
+}
+
+const char* MemoryMappedFile::getData() const
+{
+    return mData;
+}
+
+size_t MemoryMappedFile::getSize() const
+{
+    return mSize;
+}
+
+#if FILE_API == FILE_API_POSIX
+
+void MemoryMappedFile::open(const char *filename)
+{
+    assert (mData == NULL);
+
+    int handle = ::open (filename, O_RDONLY);
+    if (handle == -1)
+    {
+        std::ostringstream os;
+        os << "Failed to open '" << filename << "' for reading: " << strerror(errno);
+        throw std::runtime_error (os.str ());
+    }
+
+    struct stat info;
+    if (::fstat (handle, &info) == -1 || info.st_size <= 0)
+    {
+        ::close (handle);
+        std::ostringstream os;
+        os << "Failed to query the size of '" << filename << "'";
+        throw std::runtime_error (os.str ());
+    }
+
+    void* data = ::mmap (NULL, info.st_size, PROT_READ, MAP_PRIVATE, handle, 0);
+    // the mapping stays valid after the descriptor is closed
+    ::close (handle);
+
+    if (data == MAP_FAILED)
+    {
+        std::ostringstream os;
+        os << "Failed to map '" << filename << "': " << strerror(errno);
+        throw std::runtime_error (os.str ());
+    }
+
+    mData = static_cast<const char*>(data);
+    mSize = info.st_size;
+}
+
+void MemoryMappedFile::close()
+{
+    assert (mData != NULL);
+
+    ::munmap (const_cast<char*>(mData), mSize);
+
+    mData = NULL;
+    mSize = 0;
+}
+
+#elif FILE_API == FILE_API_WIN32
+
+void MemoryMappedFile::open(const char *filename)
+{
+    assert (mData == NULL);
+
+    std::wstring wname = boost::locale::conv::utf_to_utf<wchar_t>(filename);
+    HANDLE handle = CreateFileW (wname.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        std::ostringstream os;
+        os << "Failed to open '" << filename << "' for reading.";
+        throw std::runtime_error (os.str ());
+    }
+
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileInformationByHandle (handle, &info) || info.nFileSizeHigh != 0 || info.nFileSizeLow == 0)
+    {
+        CloseHandle (handle);
+        std::ostringstream os;
+        os << "Failed to query the size of '" << filename << "'";
+        throw std::runtime_error (os.str ());
+    }
+
+    HANDLE mapping = CreateFileMappingW (handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* data = NULL;
+    if (mapping != NULL)
+    {
+        data = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+        // the view keeps a reference to the mapping object
+        CloseHandle (mapping);
+    }
+    CloseHandle (handle);
+
+    if (data == NULL)
+    {
+        std::ostringstream os;
+        os << "Failed to map '" << filename << "'";
+        throw std::runtime_error (os.str ());
+    }
+
+    mData = static_cast<const char*>(data);
+    mSize = info.nFileSizeLow;
+}
+
+void MemoryMappedFile::close()
+{
+    assert (mData != NULL);
+
+    UnmapViewOfFile (mData);
+
+    mData = NULL;
+    mSize = 0;
+}
+
+#else
+
+void MemoryMappedFile::open(const char *filename)
+{
+    std::ostringstream os;
+    os << "Failed to map '" << filename << "': memory mapping is not supported on this platform";
+    throw std::runtime_error (os.str ());
+}
+
+void MemoryMappedFile::close()
+{
+    mData = NULL;
+    mSize = 0;
+}
+
+#endif
+
+}
@@ -0,0 +1,39 @@
+#ifndef COMPONENTS_FILES_MEMORYMAPPEDFILE_HPP
+#define COMPONENTS_FILES_MEMORYMAPPEDFILE_HPP
+
+#include <cstdlib>
+
+#include "lowlevelfile.hpp"
+
+namespace Files
+{
+
+    /// @brief Read-only view of a whole file mapped into the address space of the process.
+    /// @note Once opened, the data may be accessed from any thread.
+    class MemoryMappedFile
+    {
+    public:
+        MemoryMappedFile();
+        ~MemoryMappedFile();
+
+        /// Map the given file. Throws an exception on failure, or if memory mapping is not supported on this platform.
+        void open(const char* filename);
+        void close();
+
+        bool isOpen() const;
+
+        const char* getData() const;
+        size_t getSize() const;
+
+    private:
+        // not copyable
+        MemoryMappedFile(const MemoryMappedFile&);
+        MemoryMappedFile& operator=(const MemoryMappedFile&);
+
+        const char* mData;
+        size_t mSize;
+    };
+
+}
+
+#endif
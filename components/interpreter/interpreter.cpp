@@ -19,12 +19,12 @@ namespace Interpreter
                 int opcode = code>>24;
                 unsigned int arg0 = code & 0xffffff;
 
-                std::map<int, Opcode1 *>::iterator iter = mSegment0.find (opcode);
+                Opcode1 *op = mSegment0.find (opcode);
 
-                if (iter==mSegment0.end())
+                if (!op)
                     abortUnknownCode (0, opcode);
 
-                iter->second->execute (mRuntime, arg0);
+                op->execute (mRuntime, arg0);
 
                 return;
             }
@@ -35,12 +35,12 @@ namespace Interpreter
                 unsigned int arg0 = (code>>16) & 0xfff;
                 unsigned int arg1 = code & 0xfff;
 
-                std::map<int, Opcode2 *>::iterator iter = mSegment1.find (opcode);
+                Opcode2 *op = mSegment1.find (opcode);
 
-                if (iter==mSegment1.end())
+                if (!op)
                     abortUnknownCode (1, opcode);
 
-                iter->second->execute (mRuntime, arg0, arg1);
+                op->execute (mRuntime, arg0, arg1);
 
                 return;
             }
@@ -50,12 +50,12 @@ namespace Interpreter
                 int opcode = (code>>20) & 0x3ff;
                 unsigned int arg0 = code & 0xfffff;
 
-                std::map<int, Opcode1 *>::iterator iter = mSegment2.find (opcode);
+                Opcode1 *op = mSegment2.find (opcode);
 
-                if (iter==mSegment2.end())
+                if (!op)
                     abortUnknownCode (2, opcode);
 
-                iter->second->execute (mRuntime, arg0);
+                op->execute (mRuntime, arg0);
 
                 return;
             }
@@ -70,12 +70,12 @@ namespace Interpreter
                 int opcode = (code>>8) & 0x3ffff;
                 unsigned int arg0 = code & 0xff;
 
-                std::map<int, Opcode1 *>::iterator iter = mSegment3.find (opcode);
+                Opcode1 *op = mSegment3.find (opcode);
 
-                if (iter==mSegment3.end())
+                if (!op)
                     abortUnknownCode (3, opcode);
 
-                iter->second->execute (mRuntime, arg0);
+                op->execute (mRuntime, arg0);
 
                 return;
             }
@@ -86,12 +86,12 @@ namespace Interpreter
                 unsigned int arg0 = (code>>8) & 0xff;
                 unsigned int arg1 = code & 0xff;
 
-                std::map<int, Opcode2 *>::iterator iter = mSegment4.find (opcode);
+                Opcode2 *op = mSegment4.find (opcode);
 
-                if (iter==mSegment4.end())
+                if (!op)
                     abortUnknownCode (4, opcode);
 
-                iter->second->execute (mRuntime, arg0, arg1);
+                op->execute (mRuntime, arg0, arg1);
 
                 return;
             }
@@ -100,12 +100,12 @@ namespace Interpreter
             {
                 int opcode = code & 0x3ffffff;
 
-                std::map<int, Opcode0 *>::iterator iter = mSegment5.find (opcode);
+                Opcode0 *op = mSegment5.find (opcode);
 
-                if (iter==mSegment5.end())
+                if (!op)
                     abortUnknownCode (5, opcode);
 
-                iter->second->execute (mRuntime);
+                op->execute (mRuntime);
 
                 return;
             }
@@ -159,70 +159,55 @@ namespace Interpreter
         }
     }
 
-    Interpreter::Interpreter() : mRunning (false)
+    // extension opcodes start in the upper half of each segment (see docs/vmformat.txt)
+    Interpreter::Interpreter()
+    : mRunning (false), mSegment0 (32), mSegment1 (32), mSegment2 (512), mSegment3 (131072), mSegment4 (512),
+      mSegment5 (33554432)
     {}
 
     Interpreter::~Interpreter()
-    {
-        for (std::map<int, Opcode1 *>::iterator iter (mSegment0.begin());
-            iter!=mSegment0.end(); ++iter)
-            delete iter->second;
-
-        for (std::map<int, Opcode2 *>::iterator iter (mSegment1.begin());
-            iter!=mSegment1.end(); ++iter)
-            delete iter->second;
-
-        for (std::map<int, Opcode1 *>::iterator iter (mSegment2.begin());
-            iter!=mSegment2.end(); ++iter)
-            delete iter->second;
-
-        for (std::map<int, Opcode1 *>::iterator iter (mSegment3.begin());
-            iter!=mSegment3.end(); ++iter)
-            delete iter->second;
-
-        for (std::map<int, Opcode2 *>::iterator iter (mSegment4.begin());
-            iter!=mSegment4.end(); ++iter)
-            delete iter->second;
-
-        for (std::map<int, Opcode0 *>::iterator iter (mSegment5.begin());
-            iter!=mSegment5.end(); ++iter)
-            delete iter->second;
-    }
+    {}
 
     void Interpreter::installSegment0 (int code, Opcode1 *opcode)
     {
-        assert(mSegment0.find(code) == mSegment0.end());
-        mSegment0.insert (std::make_pair (code, opcode));
+        bool installed = mSegment0.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::installSegment1 (int code, Opcode2 *opcode)
     {
-        assert(mSegment1.find(code) == mSegment1.end());
-        mSegment1.insert (std::make_pair (code, opcode));
+        bool installed = mSegment1.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::installSegment2 (int code, Opcode1 *opcode)
     {
-        assert(mSegment2.find(code) == mSegment2.end());
-        mSegment2.insert (std::make_pair (code, opcode));
+        bool installed = mSegment2.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::installSegment3 (int code, Opcode1 *opcode)
     {
-        assert(mSegment3.find(code) == mSegment3.end());
-        mSegment3.insert (std::make_pair (code, opcode));
+        bool installed = mSegment3.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::installSegment4 (int code, Opcode2 *opcode)
     {
-        assert(mSegment4.find(code) == mSegment4.end());
-        mSegment4.insert (std::make_pair (code, opcode));
+        bool installed = mSegment4.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::installSegment5 (int code, Opcode0 *opcode)
     {
-        assert(mSegment5.find(code) == mSegment5.end());
-        mSegment5.insert (std::make_pair (code, opcode));
+        bool installed = mSegment5.install (code, opcode);
+        assert (installed);
+        (void)installed;
     }
 
     void Interpreter::run (const Type_Code *code, int codeSize, Context& context)
@@ -1,8 +1,8 @@
 #ifndef INTERPRETER_INTERPRETER_H_INCLUDED
 #define INTERPRETER_INTERPRETER_H_INCLUDED
 
-#include <map>
 #include <stack>
+#include <vector>
 
 #include "runtime.hpp"
 #include "types.hpp"
@@ -13,17 +13,72 @@ namespace Interpreter
     class Opcode1;
     class Opcode2;
 
+    /// \brief Opcodes of one segment, indexed directly by opcode number.
+    ///
+    /// A segment is split into built-in opcodes (counted from 0) and extension opcodes (counted from the
+    /// extension base of the segment). Both ranges are allocated densely, so the tables stay small even for
+    /// the huge segments 3 and 5.
+    template<class Op>
+    class OpcodeTable
+    {
+            std::vector<Op *> mBuiltIn;
+            std::vector<Op *> mExtensions;
+            unsigned int mExtensionBase;
+
+            // not implemented
+            OpcodeTable (const OpcodeTable&);
+            OpcodeTable& operator= (const OpcodeTable&);
+
+        public:
+
+            explicit OpcodeTable (unsigned int extensionBase) : mExtensionBase (extensionBase) {}
+
+            ~OpcodeTable()
+            {
+                for (typename std::vector<Op *>::iterator iter (mBuiltIn.begin()); iter!=mBuiltIn.end(); ++iter)
+                    delete *iter;
+
+                for (typename std::vector<Op *>::iterator iter (mExtensions.begin()); iter!=mExtensions.end(); ++iter)
+                    delete *iter;
+            }
+
+            /// \return Was \a code still free? If not, \a opcode is not installed.
+            bool install (unsigned int code, Op *opcode)
+            {
+                std::vector<Op *>& table = code<mExtensionBase ? mBuiltIn : mExtensions;
+                unsigned int index = code<mExtensionBase ? code : code - mExtensionBase;
+
+                if (index>=table.size())
+                    table.resize (index+1, 0);
+                else if (table[index])
+                    return false;
+
+                table[index] = opcode;
+                return true;
+            }
+
+            /// \return opcode or a null pointer, if \a code is not installed.
+            Op *find (unsigned int code) const
+            {
+                if (code<mExtensionBase)
+                    return code<mBuiltIn.size() ? mBuiltIn[code] : 0;
+
+                code -= mExtensionBase;
+                return code<mExtensions.size() ? mExtensions[code] : 0;
+            }
+    };
+
     class Interpreter
     {
             std::stack<Runtime> mCallstack;
             bool mRunning;
             Runtime mRuntime;
-            std::map<int, Opcode1 *> mSegment0;
-            std::map<int, Opcode2 *> mSegment1;
-            std::map<int, Opcode1 *> mSegment2;
-            std::map<int, Opcode1 *> mSegment3;
-            std::map<int, Opcode2 *> mSegment4;
-            std::map<int, Opcode0 *> mSegment5;
+            OpcodeTable<Opcode1> mSegment0;
+            OpcodeTable<Opcode2> mSegment1;
+            OpcodeTable<Opcode1> mSegment2;
+            OpcodeTable<Opcode1> mSegment3;
+            OpcodeTable<Opcode2> mSegment4;
+            OpcodeTable<Opcode0> mSegment5;
 
             // not implemented
             Interpreter (const Interpreter&);
@@ -1,6 +1,5 @@
 #include "runtime.hpp"
 
-#include <stdexcept>
 #include <cassert>
 #include <cstring>
 
@@ -8,11 +7,6 @@ namespace Interpreter
 {
     Runtime::Runtime() : mContext (0), mCode (0), mCodeSize(0), mPC (0) {}
 
-    int Runtime::getPC() const
-    {
-        return mPC;
-    }
-
     int Runtime::getIntegerLiteral (int index) const
     {
         assert (index>=0 && index<static_cast<int> (mCode[1]));
@@ -67,46 +61,6 @@ namespace Interpreter
         mStack.clear();
     }
 
-    void Runtime::setPC (int PC)
-    {
-        mPC = PC;
-    }
-
-    void Runtime::push (const Data& data)
-    {
-        mStack.push_back (data);
-    }
-
-    void Runtime::push (Type_Integer value)
-    {
-        Data data;
-        data.mInteger = value;
-        push (data);
-    }
-
-    void Runtime::push (Type_Float value)
-    {
-        Data data;
-        data.mFloat = value;
-        push (data);
-    }
-
-    void Runtime::pop()
-    {
-        if (mStack.empty())
-            throw std::runtime_error ("stack underflow");
-
-        mStack.resize (mStack.size()-1);
-    }
-
-    Data& Runtime::operator[] (int Index)
-    {
-        if (Index<0 || Index>=static_cast<int> (mStack.size()))
-            throw std::runtime_error ("stack index out of range");
-
-        return mStack[mStack.size()-Index-1];
-    }
-
     Context& Runtime::getContext()
     {
         assert (mContext);
@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <stdexcept>
 
 #include "types.hpp"
 
@@ -59,6 +60,54 @@ namespace Interpreter
 
             Context& getContext();
     };
+
+    // The accessors below are used by nearly every opcode and are defined inline, so that the built-in
+    // opcodes (which are header-only) compile down to direct stack and program counter accesses.
+
+    inline int Runtime::getPC() const
+    {
+        return mPC;
+    }
+
+    inline void Runtime::setPC (int PC)
+    {
+        mPC = PC;
+    }
+
+    inline void Runtime::push (const Data& data)
+    {
+        mStack.push_back (data);
+    }
+
+    inline void Runtime::push (Type_Integer value)
+    {
+        Data data;
+        data.mInteger = value;
+        push (data);
+    }
+
+    inline void Runtime::push (Type_Float value)
+    {
+        Data data;
+        data.mFloat = value;
+        push (data);
+    }
+
+    inline void Runtime::pop()
+    {
+        if (mStack.empty())
+            throw std::runtime_error ("stack underflow");
+
+        mStack.pop_back();
+    }
+
+    inline Data& Runtime::operator[] (int Index)
+    {
+        if (Index<0 || Index>=static_cast<int> (mStack.size()))
+            throw std::runtime_error ("stack index out of range");
+
+        return mStack[mStack.size()-Index-1];
+    }
 }
 
 #endif
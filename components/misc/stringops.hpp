@@ -106,6 +106,18 @@ public:
         lowerCaseInPlace(out);
         return out;
     }
+
+    /// Case-insensitive FNV-1a hash, i.e. the same for all letter cases of a string
+    static size_t ciHash(const std::string &in)
+    {
+        size_t hash = 2166136261u;
+        for (std::string::const_iterator it = in.begin(); it != in.end(); ++it)
+        {
+            hash ^= static_cast<unsigned char>(toLower(*it));
+            hash *= 16777619u;
+        }
+        return hash;
+    }
 };
 
 }
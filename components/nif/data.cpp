@@ -183,9 +183,7 @@ void NiPixelData::read(NIFStream *nif)
 
     // Read the data
     unsigned int dataSize = nif->getInt();
-    data.reserve(dataSize);
-    for (unsigned i=0; i<dataSize; ++i)
-        data.push_back((unsigned char)nif->getChar());
+    nif->getUChars(data, dataSize);
 }
 
 void NiColorData::read(NIFStream *nif)
@@ -215,6 +213,7 @@ void NiSkinData::read(NIFStream *nif)
     nif->getInt(); // -1
 
     bones.resize(boneNum);
+    std::vector<unsigned char> buffer;
     for(int i=0;i<boneNum;i++)
     {
         BoneInfo &bi = bones[i];
@@ -227,10 +226,20 @@ void NiSkinData::read(NIFStream *nif)
 
         // Number of vertex weights
         bi.weights.resize(nif->getUShort());
+
+        // Stored as tightly packed (unsigned short vertex, float weight) pairs
+        const size_t weightSize = 6;
+        nif->getUChars(buffer, bi.weights.size() * weightSize);
         for(size_t j = 0;j < bi.weights.size();j++)
         {
-            bi.weights[j].vertex = nif->getUShort();
-            bi.weights[j].weight = nif->getFloat();
+            const unsigned char* weight = &buffer[j * weightSize];
+            bi.weights[j].vertex = weight[0] | (weight[1]<<8);
+
+            union {
+                uint32_t i;
+                float f;
+            } u = { uint32_t(weight[2] | (weight[3]<<8) | (weight[4]<<16) | (weight[5]<<24)) };
+            bi.weights[j].weight = u.f;
         }
     }
 }
@@ -4,6 +4,8 @@
 #include <map>
 #include <sstream>
 
+#include <components/files/memorystream.hpp>
+
 namespace Nif
 {
 
@@ -132,9 +134,42 @@ std::string NIFFile::printVersion(unsigned int version)
     return stream.str();
 }
 
+/// Read the whole stream into the given buffer and return a stream over that buffer.
+/// Returns the original stream if it is already in memory, or if its size can not be determined.
+static Files::IStreamPtr readIntoMemory(const NIFFile& file, Files::IStreamPtr stream, std::vector<char>& buffer)
+{
+    // e.g. files of memory mapped archives, copying them would gain nothing
+    if (dynamic_cast<Files::IMemStream*>(stream.get()))
+        return stream;
+
+    std::streamoff size = 0;
+    if (stream->seekg(0, std::ios_base::end))
+    {
+        size = stream->tellg();
+        stream->seekg(0);
+    }
+    if (!stream->good() || size <= 0)
+    {
+        // unknown size, parse from the stream directly
+        stream->clear();
+        stream->seekg(0);
+        return stream;
+    }
+
+    buffer.resize(static_cast<size_t>(size));
+    stream->read(&buffer[0], buffer.size());
+    if (stream->gcount() != size)
+        file.fail("Failed to read file contents");
+
+    return Files::IStreamPtr(new Files::IMemStream(&buffer[0], buffer.size()));
+}
+
 void NIFFile::parse(Files::IStreamPtr stream)
 {
-    NIFStream nif (this, stream);
+    // Fetch the whole file with a single bulk read (unless it is in memory already), then parse it from memory.
+    // Going through the underlying file stream for every value is considerably slower.
+    std::vector<char> buffer;
+    NIFStream nif (this, readIntoMemory(*this, stream, buffer));
 
     // Check the header string
     std::string head = nif.getVersionString();
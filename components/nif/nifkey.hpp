@@ -5,8 +5,9 @@
 
 #include "nifstream.hpp"
 
+#include <algorithm>
 #include <sstream>
-#include <map>
+#include <vector>
 
 #include <boost/shared_ptr.hpp>
 
@@ -15,30 +16,53 @@
 namespace Nif
 {
 
-template<typename T>
-struct KeyT {
-    T mValue;
-
-    // FIXME: Implement Quadratic and TBC interpolation
-    /*
-    T mForwardValue;  // Only for Quadratic interpolation, and never for QuaternionKeyList
-    T mBackwardValue; // Only for Quadratic interpolation, and never for QuaternionKeyList
-    float mTension;    // Only for TBC interpolation
-    float mBias;       // Only for TBC interpolation
-    float mContinuity; // Only for TBC interpolation
-    */
+/// Describes how key values are laid out in the file and how they are stored in a KeyMapT.
+/// All key data is made of floats, so values are stored as floats, too.
+template <typename T>
+struct KeyValueTraits;
+
+template <>
+struct KeyValueTraits<float>
+{
+    typedef float StorageType;
+    static const size_t sNumFloats = 1;
+    static float make(const float* data) { return data[0]; }
+    static float get(float value) { return value; }
 };
-typedef KeyT<float> FloatKey;
-typedef KeyT<osg::Vec3f> Vector3Key;
-typedef KeyT<osg::Vec4f> Vector4Key;
-typedef KeyT<osg::Quat> QuaternionKey;
 
-template<typename T, T (NIFStream::*getValue)()>
-struct KeyMapT {
-    typedef std::map< float, KeyT<T> > MapType;
+template <>
+struct KeyValueTraits<osg::Vec3f>
+{
+    typedef osg::Vec3f StorageType;
+    static const size_t sNumFloats = 3;
+    static osg::Vec3f make(const float* data) { return osg::Vec3f(data[0], data[1], data[2]); }
+    static const osg::Vec3f& get(const osg::Vec3f& value) { return value; }
+};
 
+template <>
+struct KeyValueTraits<osg::Vec4f>
+{
+    typedef osg::Vec4f StorageType;
+    static const size_t sNumFloats = 4;
+    static osg::Vec4f make(const float* data) { return osg::Vec4f(data[0], data[1], data[2], data[3]); }
+    static const osg::Vec4f& get(const osg::Vec4f& value) { return value; }
+};
+
+/// osg::Quat is made of doubles, store the keys at the precision of the file instead (x, y, z, w).
+template <>
+struct KeyValueTraits<osg::Quat>
+{
+    typedef osg::Vec4f StorageType;
+    static const size_t sNumFloats = 4;
+    static osg::Vec4f make(const float* data) { return osg::Vec4f(data[1], data[2], data[3], data[0]); }
+    static osg::Quat get(const osg::Vec4f& value) { return osg::Quat(value.x(), value.y(), value.z(), value.w()); }
+};
+
+/// Keyframes of a value, stored as parallel arrays of key times and values.
+template<typename T>
+struct KeyMapT {
     typedef T ValueType;
-    typedef KeyT<T> KeyType;
+    typedef typename KeyValueTraits<T>::StorageType StorageType;
 
     static const unsigned int sLinearInterpolation = 1;
     static const unsigned int sQuadraticInterpolation = 2;
@@ -46,10 +70,21 @@ struct KeyMapT {
     static const unsigned int sXYZInterpolation = 4;
 
     unsigned int mInterpolationType;
-    MapType mKeys;
+
+    /// Key times in ascending order, each time appears only once
+    std::vector<float> mTimes;
+
+    /// Key values, mValues[i] belongs to mTimes[i]. Use getValue() to get them as ValueType.
+    // FIXME: Implement Quadratic and TBC interpolation. Their forward/backward values and
+    // tension/bias/continuity are skipped when reading.
+    std::vector<StorageType> mValues;
 
     KeyMapT() : mInterpolationType(sLinearInterpolation) {}
 
+    bool empty() const { return mTimes.empty(); }
+
+    ValueType getValue(size_t index) const { return KeyValueTraits<T>::get(mValues[index]); }
+
     //Read in a KeyGroup (see http://niftools.sourceforge.net/doc/nif/NiKeyframeData.html)
     void read(NIFStream *nif, bool force=false)
     {
@@ -61,39 +96,46 @@ struct KeyMapT {
         if(count == 0 && !force)
             return;
 
-        mKeys.clear();
+        mTimes.clear();
+        mValues.clear();
 
         mInterpolationType = nif->getUInt();
 
-        KeyT<T> key;
-        NIFStream &nifReference = *nif;
-
-        if(mInterpolationType == sLinearInterpolation)
-        {
-            for(size_t i = 0;i < count;i++)
-            {
-                float time = nif->getFloat();
-                readValue(nifReference, key);
-                mKeys[time] = key;
-            }
-        }
-        else if(mInterpolationType == sQuadraticInterpolation)
-        {
-            for(size_t i = 0;i < count;i++)
-            {
-                float time = nif->getFloat();
-                readQuadratic(nifReference, key);
-                mKeys[time] = key;
-            }
-        }
-        else if(mInterpolationType == sTBCInterpolation)
+        if(mInterpolationType == sLinearInterpolation
+                || mInterpolationType == sQuadraticInterpolation
+                || mInterpolationType == sTBCInterpolation)
         {
+            // Each key is made of the time followed by the value and any interpolation parameters, all floats.
+            // Fetch all keys with one bulk read, then decode them.
+            const size_t keySize = 1 + getKeySize(mInterpolationType, T());
+
+            std::vector<float> data;
+            nif->getFloats(data, count * keySize);
+
+            mTimes.reserve(count);
+            mValues.reserve(count);
+
+            bool sorted = true;
             for(size_t i = 0;i < count;i++)
             {
-                float time = nif->getFloat();
-                readTBC(nifReference, key);
-                mKeys[time] = key;
+                const float* keyData = &data[i * keySize];
+                const float time = keyData[0];
+                if (!mTimes.empty() && time <= mTimes.back())
+                {
+                    // of several keys with the same time, the last one is used
+                    if (time == mTimes.back())
+                    {
+                        mValues.back() = KeyValueTraits<T>::make(keyData + 1);
+                        continue;
+                    }
+                    sorted = false;
+                }
+                mTimes.push_back(time);
+                mValues.push_back(KeyValueTraits<T>::make(keyData + 1));
             }
+
+            if (!sorted)
+                sortKeys();
         }
         //XYZ keys aren't actually read here.
         //data.hpp sees that the last type read was sXYZInterpolation and:
@@ -125,36 +167,58 @@ struct KeyMapT {
     }
 
 private:
-    static void readValue(NIFStream &nif, KeyT<T> &key)
+    /// Bring keys that were not in order in the file into order, removing all but the last key of each time
+    void sortKeys()
     {
-        key.mValue = (nif.*getValue)();
-    }
+        std::vector<std::pair<float, size_t> > order;
+        order.reserve(mTimes.size());
+        for (size_t i = 0; i < mTimes.size(); ++i)
+            order.push_back(std::make_pair(mTimes[i], i));
+        std::sort(order.begin(), order.end());
+
+        std::vector<float> times;
+        std::vector<StorageType> values;
+        times.reserve(order.size());
+        values.reserve(order.size());
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            if (!times.empty() && order[i].first == times.back())
+            {
+                values.back() = mValues[order[i].second];
+                continue;
+            }
+            times.push_back(order[i].first);
+            values.push_back(mValues[order[i].second]);
+        }
 
-    template <typename U>
-    static void readQuadratic(NIFStream &nif, KeyT<U> &key)
-    {
-        readValue(nif, key);
-        /*key.mForwardValue = */(nif.*getValue)();
-        /*key.mBackwardValue = */(nif.*getValue)();
+        mTimes.swap(times);
+        mValues.swap(values);
     }
 
-    static void readQuadratic(NIFStream &nif, KeyT<osg::Quat> &key)
+    /// Number of floats in a key, not counting the time
+    template <typename U>
+    static size_t getKeySize(unsigned int interpolationType, const U&)
     {
-        readValue(nif, key);
+        const size_t valueSize = KeyValueTraits<U>::sNumFloats;
+        if (interpolationType == sQuadraticInterpolation)
+            return valueSize * 3; // value, forward value, backward value
+        if (interpolationType == sTBCInterpolation)
+            return valueSize + 3; // value, tension, bias, continuity
+        return valueSize;
     }
 
-    static void readTBC(NIFStream &nif, KeyT<T> &key)
+    static size_t getKeySize(unsigned int interpolationType, const osg::Quat&)
     {
-        readValue(nif, key);
-        /*key.mTension = */nif.getFloat();
-        /*key.mBias = */nif.getFloat();
-        /*key.mContinuity = */nif.getFloat();
+        // quadratic quaternion keys have no forward/backward values
+        if (interpolationType == sTBCInterpolation)
+            return KeyValueTraits<osg::Quat>::sNumFloats + 3;
+        return KeyValueTraits<osg::Quat>::sNumFloats;
     }
 };
-typedef KeyMapT<float,&NIFStream::getFloat> FloatKeyMap;
-typedef KeyMapT<osg::Vec3f,&NIFStream::getVector3> Vector3KeyMap;
-typedef KeyMapT<osg::Vec4f,&NIFStream::getVector4> Vector4KeyMap;
-typedef KeyMapT<osg::Quat,&NIFStream::getQuaternion> QuaternionKeyMap;
+typedef KeyMapT<float> FloatKeyMap;
+typedef KeyMapT<osg::Vec3f> Vector3KeyMap;
+typedef KeyMapT<osg::Vec4f> Vector4KeyMap;
+typedef KeyMapT<osg::Quat> QuaternionKeyMap;
 
 typedef boost::shared_ptr<FloatKeyMap> FloatKeyMapPtr;
 typedef boost::shared_ptr<Vector3KeyMap> Vector3KeyMapPtr;
@@ -2,6 +2,32 @@
 //For error reporting
 #include "niffile.hpp"
 
+#include <algorithm>
+
+namespace
+{
+
+    bool isLittleEndian()
+    {
+        const uint16_t value = 1;
+        return *reinterpret_cast<const uint8_t*>(&value) == 1;
+    }
+
+    const bool sIsLittleEndian = isLittleEndian();
+
+    /// Reverse the byte order of each value in the buffer. A plain loop over the whole buffer, so the compiler may vectorize it.
+    template <size_t valueSize>
+    void swapBytes(char* data, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            char* value = data + i * valueSize;
+            std::reverse(value, value + valueSize);
+        }
+    }
+
+}
+
 namespace Nif
 {
 
@@ -32,6 +58,22 @@ float NIFStream::read_le32f()
     } u = { read_le32() };
     return u.f;
 }
+void NIFStream::read_le_buffer(void *dest, size_t count, size_t valueSize)
+{
+    if (count == 0)
+        return;
+
+    char* data = static_cast<char*>(dest);
+    inp->read(data, count * valueSize);
+
+    if (!sIsLittleEndian)
+    {
+        if (valueSize == 2)
+            swapBytes<2>(data, count);
+        else if (valueSize == 4)
+            swapBytes<4>(data, count);
+    }
+}
 
 //Public functions
 osg::Vec2f NIFStream::getVector2()
@@ -103,41 +145,54 @@ std::string NIFStream::getVersionString()
     return result;
 }
 
+void NIFStream::getUChars(std::vector<unsigned char> &vec, size_t size)
+{
+    vec.resize(size);
+    if (size)
+        inp->read(reinterpret_cast<char*>(&vec[0]), size);
+}
 void NIFStream::getUShorts(osg::VectorGLushort* vec, size_t size)
 {
-    vec->reserve(size);
-    for(size_t i = 0;i < size;i++)
-        vec->push_back(getUShort());
+    vec->resize(size);
+    if (size)
+        read_le_buffer(&(*vec)[0], size, sizeof(GLushort));
 }
 void NIFStream::getFloats(std::vector<float> &vec, size_t size)
 {
     vec.resize(size);
-    for(size_t i = 0;i < vec.size();i++)
-        vec[i] = getFloat();
+    if (size)
+        read_le_buffer(&vec[0], size, sizeof(float));
 }
 void NIFStream::getVector2s(osg::Vec2Array* vec, size_t size)
 {
-    vec->reserve(size);
-    for(size_t i = 0;i < size;i++)
-        vec->push_back(getVector2());
+    vec->resize(size);
+    if (size)
+        read_le_buffer(&(*vec)[0], size*2, sizeof(float));
 }
 void NIFStream::getVector3s(osg::Vec3Array* vec, size_t size)
 {
-    vec->reserve(size);
-    for(size_t i = 0;i < size;i++)
-        vec->push_back(getVector3());
+    vec->resize(size);
+    if (size)
+        read_le_buffer(&(*vec)[0], size*3, sizeof(float));
 }
 void NIFStream::getVector4s(osg::Vec4Array* vec, size_t size)
 {
-    vec->reserve(size);
-    for(size_t i = 0;i < size;i++)
-        vec->push_back(getVector4());
+    vec->resize(size);
+    if (size)
+        read_le_buffer(&(*vec)[0], size*4, sizeof(float));
 }
 void NIFStream::getQuaternions(std::vector<osg::Quat> &quat, size_t size)
 {
+    // osg::Quat is stored as doubles, so read the floats into a temporary buffer first
+    std::vector<float> values;
+    getFloats(values, size*4);
+
     quat.resize(size);
     for(size_t i = 0;i < quat.size();i++)
-        quat[i] = getQuaternion();
+    {
+        const float* value = &values[i*4];
+        quat[i] = osg::Quat(value[1], value[2], value[3], value[0]);
+    }
 }
 
 }
@@ -33,6 +33,9 @@ class NIFStream {
     uint32_t read_le32();
     float read_le32f();
 
+    /// Read @a count little endian values of @a valueSize (2 or 4) bytes each into @a dest using a single read.
+    void read_le_buffer(void* dest, size_t count, size_t valueSize);
+
 public:
 
     NIFFile * const file;
@@ -62,12 +65,17 @@ public:
     ///This is special since the version string doesn't start with a number, and ends with "\n"
     std::string getVersionString();
 
+    /// @name Bulk reads
+    /// Read whole arrays with a single read directly into the destination storage.
+    //@{
+    void getUChars(std::vector<unsigned char> &vec, size_t size);
     void getUShorts(osg::VectorGLushort* vec, size_t size);
     void getFloats(std::vector<float> &vec, size_t size);
     void getVector2s(osg::Vec2Array* vec, size_t size);
     void getVector3s(osg::Vec3Array* vec, size_t size);
     void getVector4s(osg::Vec4Array* vec, size_t size);
     void getQuaternions(std::vector<osg::Quat> &quat, size_t size);
+    //@}
 };
 
 }
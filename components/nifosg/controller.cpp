@@ -11,6 +11,7 @@
 #include <osgParticle/Emitter>
 
 #include <components/nif/data.hpp>
+#include <components/sceneutil/skeleton.hpp>
 
 #include "userdata.hpp"
 
@@ -118,7 +119,7 @@ osg::Vec3f KeyframeController::getTranslation(float time) const
 
 void KeyframeController::operator() (osg::Node* node, osg::NodeVisitor* nv)
 {
-    if (hasInput())
+    if (hasInput() && SceneUtil::Skeleton::animateBones())
     {
         osg::MatrixTransform* trans = static_cast<osg::MatrixTransform*>(node);
         osg::Matrix mat = trans->getMatrix();
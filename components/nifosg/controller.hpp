@@ -11,6 +11,7 @@
 
 #include <boost/shared_ptr.hpp>
 
+#include <algorithm>
 #include <set> //UVController
 
 // FlipController
@@ -49,19 +50,16 @@ namespace NifOsg
         typedef typename MapT::ValueType ValueT;
 
         ValueInterpolator()
-            : mDefaultVal(ValueT())
+            : mLastHighKey(0)
+            , mDefaultVal(ValueT())
         {
         }
 
         ValueInterpolator(boost::shared_ptr<const MapT> keys, ValueT defaultVal = ValueT())
-            : mKeys(keys)
+            : mLastHighKey(0)
+            , mKeys(keys)
             , mDefaultVal(defaultVal)
         {
-            if (keys)
-            {
-                mLastLowKey = mKeys->mKeys.end();
-                mLastHighKey = mKeys->mKeys.end();
-            }
         }
 
         ValueT interpKey(float time) const
@@ -69,61 +67,43 @@ namespace NifOsg
             if (empty())
                 return mDefaultVal;
 
-            const typename MapT::MapType & keys = mKeys->mKeys;
+            const std::vector<float>& times = mKeys->mTimes;
 
-            if(time <= keys.begin()->first)
-                return keys.begin()->second.mValue;
+            if(time <= times.front())
+                return mKeys->getValue(0);
+            if(time >= times.back())
+                return mKeys->getValue(times.size()-1);
 
-            // retrieve the current position in the map, optimized for the most common case
+            // find the first key at or after time, optimized for the most common case
             // where time moves linearly along the keyframe track
-            typename MapT::MapType::const_iterator it = mLastHighKey;
-            if (mLastHighKey != keys.end())
+            size_t high = mLastHighKey;
+            if (high == 0 || high >= times.size() || time <= times[high-1] || time > times[high])
             {
-                if (time > mLastHighKey->first)
-                {
-                    // try if we're there by incrementing one
-                    ++mLastLowKey;
-                    ++mLastHighKey;
-                    it = mLastHighKey;
-                }
-                if (mLastHighKey == keys.end() || (time < mLastLowKey->first || time > mLastHighKey->first))
-                    it = keys.lower_bound(time); // still not there, reorient by performing lower_bound check on the whole map
+                // try if we're there by incrementing one
+                if (high > 0 && high+1 < times.size() && time > times[high] && time <= times[high+1])
+                    ++high;
+                else // still not there, reorient by performing a binary search on the whole track
+                    high = std::lower_bound(times.begin(), times.end(), time) - times.begin();
             }
-            else
-                it = keys.lower_bound(time);
-
-            // now do the actual interpolation
-            if (it != keys.end())
-            {
-                float aTime = it->first;
-                const typename MapT::KeyType* aKey = &it->second;
-
-                // cache for next time
-                mLastHighKey = it;
 
-                assert (it != keys.begin()); // Shouldn't happen, was checked at beginning of this function
+            // cache for next time
+            mLastHighKey = high;
 
-                typename MapT::MapType::const_iterator last = --it;
-                mLastLowKey = last;
-                float aLastTime = last->first;
-                const typename MapT::KeyType* aLastKey = &last->second;
+            // the first and last keys were checked at the beginning of this function
+            const size_t low = high-1;
 
-                float a = (time - aLastTime) / (aTime - aLastTime);
+            float a = (time - times[low]) / (times[high] - times[low]);
 
-                return InterpolationFunc()(aLastKey->mValue, aKey->mValue, a);
-            }
-            else
-                return keys.rbegin()->second.mValue;
+            return InterpolationFunc()(mKeys->getValue(low), mKeys->getValue(high), a);
         }
 
         bool empty() const
         {
-            return !mKeys || mKeys->mKeys.empty();
+            return !mKeys || mKeys->empty();
         }
 
     private:
-        mutable typename MapT::MapType::const_iterator mLastLowKey;
-        mutable typename MapT::MapType::const_iterator mLastHighKey;
+        mutable size_t mLastHighKey;
 
         boost::shared_ptr<const MapT> mKeys;
 
@@ -91,7 +91,7 @@ namespace Resource
             Files::IStreamPtr stream;
             try
             {
-                stream = mVFS->get(normalized.c_str());
+                stream = mVFS->getNormalized(normalized);
             }
             catch (std::exception& e)
             {
@@ -349,7 +349,7 @@ namespace Resource
             osg::ref_ptr<osg::Node> loaded;
             try
             {
-                Files::IStreamPtr file = mVFS->get(normalized);
+                Files::IStreamPtr file = mVFS->getNormalized(normalized);
 
                 loaded = load(file, normalized, mImageManager, mNifFileManager);
             }
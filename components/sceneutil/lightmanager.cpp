@@ -1,6 +1,9 @@
 #include "lightmanager.hpp"
 
 #include <stdexcept>
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
 
 #include <osg/NodeVisitor>
 
@@ -238,15 +241,111 @@ namespace SceneUtil
         return mLights;
     }
 
-    const std::vector<LightManager::LightSourceViewBound>& LightManager::getLightsInViewSpace(osg::Camera *camera, const osg::RefMatrix* viewMatrix)
+    // Minimum number of lights to bin into a LightGrid, below that testing every light is faster
+    static const unsigned int sMinGridLights = 16;
+
+    // Maximum number of grid cells along each axis
+    static const int sMaxGridSize = 32;
+
+    void LightManager::LightGrid::build(const LightSourceViewBoundCollection& lights)
+    {
+        mCellStart.clear();
+        mCellLights.clear();
+
+        osg::Vec2f minBound (FLT_MAX, FLT_MAX);
+        osg::Vec2f maxBound (-FLT_MAX, -FLT_MAX);
+        for (unsigned int i=0; i<lights.size(); ++i)
+        {
+            const osg::BoundingSphere& bound = lights[i].mViewBound;
+            minBound.x() = std::min(minBound.x(), bound.center().x() - bound.radius());
+            minBound.y() = std::min(minBound.y(), bound.center().y() - bound.radius());
+            maxBound.x() = std::max(maxBound.x(), bound.center().x() + bound.radius());
+            maxBound.y() = std::max(maxBound.y(), bound.center().y() + bound.radius());
+        }
+
+        // aim for a few lights per cell
+        int size = static_cast<int>(std::ceil(std::sqrt(lights.size() / 2.f)));
+        size = std::max(1, std::min(size, sMaxGridSize));
+
+        mOrigin = minBound;
+        mSizeX = size;
+        mSizeY = size;
+        osg::Vec2f extent = maxBound - minBound;
+        mInvCellSizeX = extent.x() > 0.f ? mSizeX / extent.x() : 0.f;
+        mInvCellSizeY = extent.y() > 0.f ? mSizeY / extent.y() : 0.f;
+
+        // two passes, counting and then filling, to store the cells contiguously
+        mCellStart.assign(mSizeX * mSizeY + 1, 0);
+        for (int pass=0; pass<2; ++pass)
+        {
+            if (pass == 1)
+            {
+                for (unsigned int i=1; i<mCellStart.size(); ++i)
+                    mCellStart[i] += mCellStart[i-1];
+                mCellLights.resize(mCellStart.back());
+            }
+
+            for (unsigned int i=0; i<lights.size(); ++i)
+            {
+                int minX, minY, maxX, maxY;
+                getCellRange(lights[i].mViewBound, minX, minY, maxX, maxY);
+                for (int y=minY; y<=maxY; ++y)
+                {
+                    for (int x=minX; x<=maxX; ++x)
+                    {
+                        int cell = y*mSizeX + x;
+                        if (pass == 0)
+                            ++mCellStart[cell+1];
+                        else
+                            mCellLights[mCellStart[cell]++] = i;
+                    }
+                }
+            }
+        }
+
+        // the fill pass advanced each start to the start of the next cell
+        for (unsigned int i=mCellStart.size()-1; i>0; --i)
+            mCellStart[i] = mCellStart[i-1];
+        mCellStart[0] = 0;
+    }
+
+    /// Convert a grid coordinate to a cell index in [-1, size+1]. Clamps before converting, since huge or infinite
+    /// coordinates do not fit into an int. NaN maps to -1.
+    static int toGridCell(float coord, int size)
+    {
+        coord = std::max(-1.f, std::min(coord, static_cast<float>(size + 1)));
+        return static_cast<int>(std::floor(coord));
+    }
+
+    bool LightManager::LightGrid::getCellRange(const osg::BoundingSphere& bound, int& minX, int& minY, int& maxX, int& maxY) const
+    {
+        minX = toGridCell((bound.center().x() - bound.radius() - mOrigin.x()) * mInvCellSizeX, mSizeX);
+        minY = toGridCell((bound.center().y() - bound.radius() - mOrigin.y()) * mInvCellSizeY, mSizeY);
+        maxX = toGridCell((bound.center().x() + bound.radius() - mOrigin.x()) * mInvCellSizeX, mSizeX);
+        maxY = toGridCell((bound.center().y() + bound.radius() - mOrigin.y()) * mInvCellSizeY, mSizeY);
+
+        // bounds touching the far edge of the grid map to one past the last cell
+        if (maxX < 0 || maxY < 0 || minX > mSizeX || minY > mSizeY)
+            return false;
+
+        minX = std::max(0, std::min(minX, mSizeX-1));
+        minY = std::max(0, std::min(minY, mSizeY-1));
+        maxX = std::min(maxX, mSizeX-1);
+        maxY = std::min(maxY, mSizeY-1);
+        return true;
+    }
+
+    LightManager::LightsInViewSpace& LightManager::getLightsInViewSpaceData(osg::Camera *camera, const osg::RefMatrix* viewMatrix)
     {
         osg::observer_ptr<osg::Camera> camPtr (camera);
-        std::map<osg::observer_ptr<osg::Camera>, LightSourceViewBoundCollection>::iterator it = mLightsInViewSpace.find(camPtr);
+        std::map<osg::observer_ptr<osg::Camera>, LightsInViewSpace>::iterator it = mLightsInViewSpace.find(camPtr);
 
         if (it == mLightsInViewSpace.end())
         {
-            it = mLightsInViewSpace.insert(std::make_pair(camPtr, LightSourceViewBoundCollection())).first;
+            it = mLightsInViewSpace.insert(std::make_pair(camPtr, LightsInViewSpace())).first;
 
+            LightSourceViewBoundCollection& lights = it->second.mLights;
+            lights.reserve(mLights.size());
             for (std::vector<LightSourceTransform>::iterator lightIt = mLights.begin(); lightIt != mLights.end(); ++lightIt)
             {
                 osg::Matrixf worldViewMat = lightIt->mWorldMatrix * (*viewMatrix);
@@ -256,12 +355,65 @@ namespace SceneUtil
                 LightSourceViewBound l;
                 l.mLightSource = lightIt->mLightSource;
                 l.mViewBound = viewBound;
-                it->second.push_back(l);
+                lights.push_back(l);
             }
+
+            if (lights.size() >= sMinGridLights)
+                it->second.mGrid.build(lights);
         }
         return it->second;
     }
 
+    const std::vector<LightManager::LightSourceViewBound>& LightManager::getLightsInViewSpace(osg::Camera *camera, const osg::RefMatrix* viewMatrix)
+    {
+        return getLightsInViewSpaceData(camera, viewMatrix).mLights;
+    }
+
+    void LightManager::getLightsIntersecting(osg::Camera *camera, const osg::RefMatrix *viewMatrix, const osg::BoundingSphere &viewBound, LightList &lightList)
+    {
+        LightsInViewSpace& data = getLightsInViewSpaceData(camera, viewMatrix);
+        const LightSourceViewBoundCollection& lights = data.mLights;
+
+        if (!viewBound.valid())
+            return;
+
+        if (data.mGrid.empty())
+        {
+            for (unsigned int i=0; i<lights.size(); ++i)
+            {
+                if (lights[i].mViewBound.intersects(viewBound))
+                    lightList.push_back(&lights[i]);
+            }
+            return;
+        }
+
+        int minX, minY, maxX, maxY;
+        if (!data.mGrid.getCellRange(viewBound, minX, minY, maxX, maxY))
+            return;
+
+        std::vector<unsigned int>& candidates = data.mCandidates;
+        candidates.clear();
+        for (int y=minY; y<=maxY; ++y)
+        {
+            for (int x=minX; x<=maxX; ++x)
+            {
+                int cell = y*data.mGrid.mSizeX + x;
+                candidates.insert(candidates.end(), data.mGrid.mCellLights.begin() + data.mGrid.mCellStart[cell],
+                                  data.mGrid.mCellLights.begin() + data.mGrid.mCellStart[cell+1]);
+            }
+        }
+
+        // lights overlapping several cells are found more than once, and the original order must be kept
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        for (std::vector<unsigned int>::const_iterator it = candidates.begin(); it != candidates.end(); ++it)
+        {
+            if (lights[*it].mViewBound.intersects(viewBound))
+                lightList.push_back(&lights[*it]);
+        }
+    }
+
     void LightManager::setStartLight(int start)
     {
         mStartLight = start;
@@ -330,7 +482,6 @@ namespace SceneUtil
 
         // Possible optimizations:
         // - cull list of lights by the camera frustum
-        // - organize lights in a quad tree
 
 
         // update light list if necessary
@@ -341,7 +492,6 @@ namespace SceneUtil
 
             // Don't use Camera::getViewMatrix, that one might be relative to another camera!
             const osg::RefMatrix* viewMatrix = cv->getCurrentRenderStage()->getInitialViewMatrix();
-            const std::vector<LightManager::LightSourceViewBound>& lights = mLightManager->getLightsInViewSpace(cv->getCurrentCamera(), viewMatrix);
 
             // get the node bounds in view space
             // NB do not node->getBound() * modelView, that would apply the node's transformation twice
@@ -356,12 +506,7 @@ namespace SceneUtil
             transformBoundingSphere(mat, nodeBound);
 
             mLightList.clear();
-            for (unsigned int i=0; i<lights.size(); ++i)
-            {
-                const LightManager::LightSourceViewBound& l = lights[i];
-                if (l.mViewBound.intersects(nodeBound))
-                    mLightList.push_back(&l);
-            }
+            mLightManager->getLightsIntersecting(cv->getCurrentCamera(), viewMatrix, nodeBound, mLightList);
         }
         if (!mLightList.empty())
         {
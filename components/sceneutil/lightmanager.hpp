@@ -6,6 +6,7 @@
 #include <osg/Group>
 #include <osg/NodeVisitor>
 #include <osg/observer_ptr>
+#include <osg/Vec2f>
 
 namespace SceneUtil
 {
@@ -120,6 +121,9 @@ namespace SceneUtil
 
         typedef std::vector<const LightSourceViewBound*> LightList;
 
+        /// Get the lights whose view space bounds intersect \a viewBound, in the order of getLightsInViewSpace.
+        void getLightsIntersecting(osg::Camera* camera, const osg::RefMatrix* viewMatrix, const osg::BoundingSphere& viewBound, LightList& lightList);
+
         osg::ref_ptr<osg::StateSet> getLightListStateSet(const LightList& lightList, unsigned int frameNum);
 
     private:
@@ -127,7 +131,45 @@ namespace SceneUtil
         std::vector<LightSourceTransform> mLights;
 
         typedef std::vector<LightSourceViewBound> LightSourceViewBoundCollection;
-        std::map<osg::observer_ptr<osg::Camera>, LightSourceViewBoundCollection> mLightsInViewSpace;
+
+        /// Grid over the view space XY plane, with each cell listing the lights whose bounds overlap it.
+        /// Only built when there are enough lights for the binning to pay off.
+        struct LightGrid
+        {
+            LightGrid() : mSizeX(0), mSizeY(0), mInvCellSizeX(0.f), mInvCellSizeY(0.f) {}
+
+            osg::Vec2f mOrigin;
+            int mSizeX;
+            int mSizeY;
+            float mInvCellSizeX;
+            float mInvCellSizeY;
+
+            // Indices of the lights in cell i are mCellLights[mCellStart[i]] to mCellLights[mCellStart[i+1]-1]
+            std::vector<unsigned int> mCellStart;
+            std::vector<unsigned int> mCellLights;
+
+            void build(const LightSourceViewBoundCollection& lights);
+
+            bool empty() const { return mCellStart.empty(); }
+
+            /// Get the cell range overlapped by \a bound, clamped to the grid.
+            /// @return false if \a bound lies outside the grid entirely.
+            bool getCellRange(const osg::BoundingSphere& bound, int& minX, int& minY, int& maxX, int& maxY) const;
+        };
+
+        struct LightsInViewSpace
+        {
+            LightSourceViewBoundCollection mLights;
+            LightGrid mGrid;
+
+            // Scratch space for getLightsIntersecting. Kept per camera rather than per LightManager, so cameras
+            // culled at the same time do not share it.
+            std::vector<unsigned int> mCandidates;
+        };
+
+        LightsInViewSpace& getLightsInViewSpaceData(osg::Camera* camera, const osg::RefMatrix* viewMatrix);
+
+        std::map<osg::observer_ptr<osg::Camera>, LightsInViewSpace> mLightsInViewSpace;
 
         // < Light list hash , StateSet >
         typedef std::map<size_t, osg::ref_ptr<osg::StateSet> > LightStateSetMap;
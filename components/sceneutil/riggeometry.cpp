@@ -6,10 +6,51 @@
 
 #include "skeleton.hpp"
 #include "util.hpp"
+#include "workqueue.hpp"
 
 namespace SceneUtil
 {
 
+namespace
+{
+    WorkQueue* sWorkQueue = NULL;
+}
+
+/// Skins a RigGeometry on a worker thread. Whoever claims the item first does the skinning: the worker thread,
+/// or the draw thread if it reaches the geometry before the worker got to it.
+class SkinningWorkItem : public WorkItem
+{
+public:
+    SkinningWorkItem(RigGeometry* rig)
+        : mRig(rig)
+    {
+    }
+
+    virtual void doWork()
+    {
+        if (claim())
+            mRig->skin();
+    }
+
+    bool claim()
+    {
+        return ++mClaimed == 1;
+    }
+
+    /// Prepare the item to be queued again.
+    /// @note Only call once the item is done, a worker thread may still hold it in its queue otherwise.
+    void reset()
+    {
+        mClaimed.exchange(0);
+        mDone.exchange(0);
+    }
+
+private:
+    // not a ref_ptr, the RigGeometry finishes the item before it is destroyed
+    RigGeometry* mRig;
+    OpenThreads::Atomic mClaimed;
+};
+
 class UpdateRigBounds : public osg::Drawable::UpdateCallback
 {
 public:
@@ -65,7 +106,9 @@ public:
 
 RigGeometry::RigGeometry()
     : mSkeleton(NULL)
+    , mSkinningPending(false)
     , mLastFrameNumber(0)
+    , mLastPoseNumber(0)
     , mBoundsFirstFrame(true)
 {
     setCullCallback(new UpdateRigGeometry);
@@ -79,12 +122,21 @@ RigGeometry::RigGeometry(const RigGeometry &copy, const osg::CopyOp &copyop)
     : osg::Geometry(copy, copyop)
     , mSkeleton(NULL)
     , mInfluenceMap(copy.mInfluenceMap)
+    , mSkinningPending(false)
     , mLastFrameNumber(0)
+    , mLastPoseNumber(0)
     , mBoundsFirstFrame(true)
 {
     setSourceGeometry(copy.mSourceGeometry);
 }
 
+RigGeometry::~RigGeometry()
+{
+    // nobody will draw the result, so only wait if a worker thread is already skinning
+    if (mSkinningPending && !mSkinningWork->claim())
+        mSkinningWork->waitTillDone();
+}
+
 void RigGeometry::setSourceGeometry(osg::ref_ptr<osg::Geometry> sourceGeometry)
 {
     mSourceGeometry = sourceGeometry;
@@ -183,29 +235,45 @@ bool RigGeometry::initFromParentSkeleton(osg::NodeVisitor* nv)
 
         const BoneInfluence& bi = it->second;
 
+        unsigned int boneIndex = mBones.size();
+        mBones.push_back(std::make_pair(bone, bi.mInvBindMatrix));
+
         const std::map<unsigned short, float>& weights = it->second.mWeights;
         for (std::map<unsigned short, float>::const_iterator weightIt = weights.begin(); weightIt != weights.end(); ++weightIt)
         {
             std::vector<BoneWeight>& vec = vertex2BoneMap[weightIt->first];
 
-            BoneWeight b = std::make_pair(std::make_pair(bone, bi.mInvBindMatrix), weightIt->second);
-
-            vec.push_back(b);
+            vec.push_back(std::make_pair(boneIndex, weightIt->second));
         }
     }
+    mSkinningMatrices.resize(mBones.size());
 
+    typedef std::map<std::vector<BoneWeight>, std::vector<unsigned short> > Bone2VertexMap;
+    Bone2VertexMap bone2VertexMap;
     for (Vertex2BoneMap::iterator it = vertex2BoneMap.begin(); it != vertex2BoneMap.end(); ++it)
     {
-        mBone2VertexMap[it->second].push_back(it->first);
+        bone2VertexMap[it->second].push_back(it->first);
+    }
+
+    for (Bone2VertexMap::const_iterator it = bone2VertexMap.begin(); it != bone2VertexMap.end(); ++it)
+    {
+        InfluenceGroup group;
+        group.mFirstWeight = mWeights.size();
+        group.mNumWeights = it->first.size();
+        group.mFirstVertex = mVertices.size();
+        group.mNumVertices = it->second.size();
+        mInfluenceGroups.push_back(group);
+
+        mWeights.insert(mWeights.end(), it->first.begin(), it->first.end());
+        mVertices.insert(mVertices.end(), it->second.begin(), it->second.end());
     }
 
     return true;
 }
 
-void accumulateMatrix(const osg::Matrixf& invBindMatrix, const osg::Matrixf& matrix, float weight, osg::Matrixf& result)
+void accumulateMatrix(const osg::Matrixf& matrix, float weight, osg::Matrixf& result)
 {
-    osg::Matrixf m = invBindMatrix * matrix;
-    float* ptr = m.ptr();
+    const float* ptr = matrix.ptr();
     float* ptrresult = result.ptr();
     ptrresult[0] += ptr[0] * weight;
     ptrresult[1] += ptr[1] * weight;
@@ -241,52 +309,128 @@ void RigGeometry::update(osg::NodeVisitor* nv)
         return;
     mLastFrameNumber = nv->getTraversalNumber();
 
+    // the skeleton was not animated since this buffer was last skinned
+    if (mLastPoseNumber == mSkeleton->getPoseNumber())
+        return;
+    mLastPoseNumber = mSkeleton->getPoseNumber();
+
+    // the skinning of the last frame that used this geometry still reads the matrices
+    finishSkinning();
+
     mSkeleton->updateBoneMatrices(nv->getTraversalNumber());
 
-    // skinning
-    osg::Vec3Array* positionSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getVertexArray());
-    osg::Vec3Array* normalSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getNormalArray());
-    osg::Vec4Array* tangentSrc = mSourceTangents;
+    for (unsigned int i=0; i<mBones.size(); ++i)
+        mSkinningMatrices[i] = mBones[i].second * mBones[i].first->mMatrixInSkeletonSpace;
+    mSkinningGeomToSkelMatrix = mGeomToSkelMatrix;
 
-    osg::Vec3Array* positionDst = static_cast<osg::Vec3Array*>(getVertexArray());
-    osg::Vec3Array* normalDst = static_cast<osg::Vec3Array*>(getNormalArray());
-    osg::Vec4Array* tangentDst = static_cast<osg::Vec4Array*>(getTexCoordArray(7));
+    if (sWorkQueue)
+    {
+        // if the draw thread claimed the last item, it may still be waiting in the queue
+        if (mSkinningWork && mSkinningWork->isDone())
+            mSkinningWork->reset();
+        else
+            mSkinningWork = new SkinningWorkItem(this);
 
-    for (Bone2VertexMap::const_iterator it = mBone2VertexMap.begin(); it != mBone2VertexMap.end(); ++it)
+        mSkinningPending = true;
+        sWorkQueue->addWorkItem(mSkinningWork);
+    }
+    else
+        skin();
+}
+
+void RigGeometry::skin()
+{
+    if (mInfluenceGroups.empty())
+        return;
+
+    const osg::Vec3f* positionSrc = &static_cast<osg::Vec3Array*>(mSourceGeometry->getVertexArray())->front();
+    const osg::Vec3f* normalSrc = &static_cast<osg::Vec3Array*>(mSourceGeometry->getNormalArray())->front();
+    const osg::Vec4f* tangentSrc = mSourceTangents ? &mSourceTangents->front() : NULL;
+
+    osg::Vec3Array* positionArray = static_cast<osg::Vec3Array*>(getVertexArray());
+    osg::Vec3Array* normalArray = static_cast<osg::Vec3Array*>(getNormalArray());
+    osg::Vec4Array* tangentArray = static_cast<osg::Vec4Array*>(getTexCoordArray(7));
+
+    osg::Vec3f* positionDst = &positionArray->front();
+    osg::Vec3f* normalDst = &normalArray->front();
+    osg::Vec4f* tangentDst = tangentArray ? &tangentArray->front() : NULL;
+
+    for (std::vector<InfluenceGroup>::const_iterator it = mInfluenceGroups.begin(); it != mInfluenceGroups.end(); ++it)
     {
         osg::Matrixf resultMat  (0, 0, 0, 0,
                                 0, 0, 0, 0,
                                 0, 0, 0, 0,
                                 0, 0, 0, 1);
 
-        for (std::vector<BoneWeight>::const_iterator weightIt = it->first.begin(); weightIt != it->first.end(); ++weightIt)
-        {
-            Bone* bone = weightIt->first.first;
-            const osg::Matrix& invBindMatrix = weightIt->first.second;
-            float weight = weightIt->second;
-            const osg::Matrixf& boneMatrix = bone->mMatrixInSkeletonSpace;
-            accumulateMatrix(invBindMatrix, boneMatrix, weight, resultMat);
-        }
-        resultMat = resultMat * mGeomToSkelMatrix;
+        const BoneWeight* weights = &mWeights[it->mFirstWeight];
+        for (unsigned int i=0; i<it->mNumWeights; ++i)
+            accumulateMatrix(mSkinningMatrices[weights[i].first], weights[i].second, resultMat);
 
-        for (std::vector<unsigned short>::const_iterator vertexIt = it->second.begin(); vertexIt != it->second.end(); ++vertexIt)
+        resultMat = resultMat * mSkinningGeomToSkelMatrix;
+
+        // the matrix is affine, so transforming a position needs no division by w.
+        // written out on plain floats, so the compiler can keep the matrix in registers.
+        const float* m = resultMat.ptr();
+        const float m0 = m[0], m1 = m[1], m2 = m[2];
+        const float m4 = m[4], m5 = m[5], m6 = m[6];
+        const float m8 = m[8], m9 = m[9], m10 = m[10];
+        const float m12 = m[12], m13 = m[13], m14 = m[14];
+
+        const unsigned short* vertices = &mVertices[it->mFirstVertex];
+        for (unsigned int i=0; i<it->mNumVertices; ++i)
         {
-            unsigned short vertex = *vertexIt;
-            (*positionDst)[vertex] = resultMat.preMult((*positionSrc)[vertex]);
-            (*normalDst)[vertex] = osg::Matrix::transform3x3((*normalSrc)[vertex], resultMat);
+            const unsigned short vertex = vertices[i];
+
+            const osg::Vec3f& p = positionSrc[vertex];
+            positionDst[vertex].set(p.x()*m0 + p.y()*m4 + p.z()*m8 + m12,
+                                    p.x()*m1 + p.y()*m5 + p.z()*m9 + m13,
+                                    p.x()*m2 + p.y()*m6 + p.z()*m10 + m14);
+
+            const osg::Vec3f& n = normalSrc[vertex];
+            normalDst[vertex].set(n.x()*m0 + n.y()*m4 + n.z()*m8,
+                                  n.x()*m1 + n.y()*m5 + n.z()*m9,
+                                  n.x()*m2 + n.y()*m6 + n.z()*m10);
+
             if (tangentDst)
             {
-                osg::Vec4f srcTangent = (*tangentSrc)[vertex];
-                osg::Vec3f transformedTangent = osg::Matrix::transform3x3(osg::Vec3f(srcTangent.x(), srcTangent.y(), srcTangent.z()), resultMat);
-                (*tangentDst)[vertex] = osg::Vec4f(transformedTangent, srcTangent.w());
+                const osg::Vec4f& t = tangentSrc[vertex];
+                tangentDst[vertex].set(t.x()*m0 + t.y()*m4 + t.z()*m8,
+                                       t.x()*m1 + t.y()*m5 + t.z()*m9,
+                                       t.x()*m2 + t.y()*m6 + t.z()*m10,
+                                       t.w());
             }
         }
     }
 
-    positionDst->dirty();
-    normalDst->dirty();
-    if (tangentDst)
-        tangentDst->dirty();
+    positionArray->dirty();
+    normalArray->dirty();
+    if (tangentArray)
+        tangentArray->dirty();
+}
+
+void RigGeometry::finishSkinning() const
+{
+    if (!mSkinningPending)
+        return;
+
+    if (mSkinningWork->claim())
+        const_cast<RigGeometry*>(this)->skin();
+    else
+        mSkinningWork->waitTillDone();
+
+    mSkinningPending = false;
+}
+
+void RigGeometry::drawImplementation(osg::RenderInfo &renderInfo) const
+{
+    finishSkinning();
+
+    osg::Geometry::drawImplementation(renderInfo);
+}
+
+void RigGeometry::setWorkQueue(WorkQueue *workQueue)
+{
+    sWorkQueue = workQueue;
 }
 
 void RigGeometry::updateBounds(osg::NodeVisitor *nv)
@@ -297,7 +441,8 @@ void RigGeometry::updateBounds(osg::NodeVisitor *nv)
             return;
     }
 
-    if (!mSkeleton->getActive() && !mBoundsFirstFrame)
+    // the bones did not move
+    if ((!mSkeleton->getActive() || !mSkeleton->getAnimated()) && !mBoundsFirstFrame)
         return;
     mBoundsFirstFrame = false;
 
@@ -9,6 +9,8 @@ namespace SceneUtil
 
     class Skeleton;
     class Bone;
+    class WorkQueue;
+    class SkinningWorkItem;
 
     /// @brief Mesh skinning implementation.
     /// @note A RigGeometry may be attached directly to a Skeleton, or somewhere below a Skeleton.
@@ -16,11 +18,14 @@ namespace SceneUtil
     /// @note To avoid race conditions, the rig geometry needs to be double buffered. This can be done
     /// using a FrameSwitch node that has two RigGeometry children. In the future we may want to consider implementing
     /// the double buffering inside RigGeometry.
+    /// @note The skinning of a frame may run on a background thread, see setWorkQueue. It only reads the bone matrices
+    /// copied during the cull traversal, and is finished when the geometry is drawn.
     class RigGeometry : public osg::Geometry
     {
     public:
         RigGeometry();
         RigGeometry(const RigGeometry& copy, const osg::CopyOp& copyop);
+        ~RigGeometry();
 
         META_Object(SceneUtil, RigGeometry)
 
@@ -51,7 +56,16 @@ namespace SceneUtil
         // Called automatically by our UpdateCallback
         void updateBounds(osg::NodeVisitor* nv);
 
+        /// Finishes the skinning of this frame before drawing.
+        virtual void drawImplementation(osg::RenderInfo& renderInfo) const;
+
+        /// Skin all RigGeometries on the threads of \a workQueue, instead of in the cull traversal. Pass NULL to skin in the cull traversal.
+        /// @note The caller keeps ownership of the queue, and has to reset it before the queue is destroyed.
+        static void setWorkQueue(WorkQueue* workQueue);
+
     private:
+        friend class SkinningWorkItem;
+
         osg::ref_ptr<osg::Geometry> mSourceGeometry;
         osg::ref_ptr<osg::Vec4Array> mSourceTangents;
         Skeleton* mSkeleton;
@@ -63,24 +77,53 @@ namespace SceneUtil
 
         typedef std::pair<Bone*, osg::Matrixf> BoneBindMatrixPair;
 
-        typedef std::pair<BoneBindMatrixPair, float> BoneWeight;
+        // bones that influence any vertex, with their inverse bind matrix
+        std::vector<BoneBindMatrixPair> mBones;
 
-        typedef std::vector<unsigned short> VertexList;
+        // <index in mBones, weight>
+        typedef std::pair<unsigned int, float> BoneWeight;
 
-        typedef std::map<std::vector<BoneWeight>, VertexList> Bone2VertexMap;
+        /// Vertices that are influenced by the same bones with the same weights, so they share one skinning matrix.
+        struct InfluenceGroup
+        {
+            unsigned int mFirstWeight;
+            unsigned int mNumWeights;
+            unsigned int mFirstVertex;
+            unsigned int mNumVertices;
+        };
 
-        Bone2VertexMap mBone2VertexMap;
+        // the weights and vertices of all groups, stored back to back
+        std::vector<InfluenceGroup> mInfluenceGroups;
+        std::vector<BoneWeight> mWeights;
+        std::vector<unsigned short> mVertices;
+
+        // copied during the cull traversal, so the skinning does not depend on the skeleton
+        std::vector<osg::Matrixf> mSkinningMatrices; // invBindMatrix * bone matrix of each bone in mBones
+        osg::Matrixf mSkinningGeomToSkelMatrix;
+
+        // reused for every frame once the worker thread is done with it
+        mutable osg::ref_ptr<SkinningWorkItem> mSkinningWork;
+        // the last update() queued mSkinningWork and it was not finished yet
+        mutable bool mSkinningPending;
 
         typedef std::map<Bone*, osg::BoundingSpheref> BoneSphereMap;
 
         BoneSphereMap mBoneSphereMap;
 
         unsigned int mLastFrameNumber;
+        unsigned int mLastPoseNumber;
         bool mBoundsFirstFrame;
 
         bool initFromParentSkeleton(osg::NodeVisitor* nv);
 
         void updateGeomToSkelMatrix(const osg::NodePath& nodePath);
+
+        /// Transform the vertices with the bone matrices copied in the last update().
+        /// @par Possibly called from a background thread.
+        void skin();
+
+        // wait for or take over the skinning queued by the last update()
+        void finishSkinning() const;
     };
 
 }
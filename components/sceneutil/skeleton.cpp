@@ -3,10 +3,24 @@
 #include <osg/Transform>
 #include <osg/MatrixTransform>
 
+#include <OpenThreads/Atomic>
+
 #include <components/misc/stringops.hpp>
 
+#include <algorithm>
 #include <iostream>
 
+namespace
+{
+    float sLodDistance = 0.f;
+    unsigned int sLodMaxInterval = 1;
+
+    OpenThreads::Atomic sNextLodPhase;
+
+    // the innermost Skeleton whose update traversal is running
+    const SceneUtil::Skeleton* sUpdatingSkeleton = NULL;
+}
+
 namespace SceneUtil
 {
 
@@ -40,6 +54,12 @@ Skeleton::Skeleton()
     , mLastFrameNumber(0)
     , mTraversedEvenFrame(false)
     , mTraversedOddFrame(false)
+    , mPoseNumber(0)
+    , mAnimated(true)
+    , mLastCullFrameNumber(0)
+    , mCullDistance(0.f)
+    , mLastPoseFrameNumber(0)
+    , mLodPhase(++sNextLodPhase)
 {
 
 }
@@ -52,6 +72,12 @@ Skeleton::Skeleton(const Skeleton &copy, const osg::CopyOp &copyop)
     , mLastFrameNumber(0)
     , mTraversedEvenFrame(false)
     , mTraversedOddFrame(false)
+    , mPoseNumber(0)
+    , mAnimated(true)
+    , mLastCullFrameNumber(0)
+    , mCullDistance(0.f)
+    , mLastPoseFrameNumber(0)
+    , mLodPhase(++sNextLodPhase)
 {
 
 }
@@ -150,13 +176,80 @@ void Skeleton::markDirty()
     mTraversedOddFrame = false;
 }
 
+unsigned int Skeleton::getPoseNumber() const
+{
+    return mPoseNumber;
+}
+
+bool Skeleton::getAnimated() const
+{
+    return mAnimated;
+}
+
+bool Skeleton::animateBones()
+{
+    return !sUpdatingSkeleton || sUpdatingSkeleton->mAnimated;
+}
+
+void Skeleton::setLodSettings(float distance, unsigned int maxInterval)
+{
+    sLodDistance = distance;
+    sLodMaxInterval = std::max(1u, maxInterval);
+}
+
+bool Skeleton::needsUpdate(unsigned int traversalNumber) const
+{
+    if (sLodDistance <= 0.f || sLodMaxInterval == 1)
+        return true;
+
+    unsigned int interval = sLodMaxInterval;
+    // the cull traversal of the last frame runs after the update traversal of this frame starts
+    if (mLastCullFrameNumber + 1 >= traversalNumber)
+    {
+        interval = 1;
+        for (float distance = mCullDistance; distance >= sLodDistance && interval < sLodMaxInterval; distance -= sLodDistance)
+            interval *= 2;
+        interval = std::min(interval, sLodMaxInterval);
+    }
+
+    // catch up right away if the interval got shorter, e.g. when the skeleton comes into view
+    return (traversalNumber + mLodPhase) % interval == 0 || traversalNumber - mLastPoseFrameNumber >= interval;
+}
+
 void Skeleton::traverse(osg::NodeVisitor& nv)
 {
-    if (!getActive() && nv.getVisitorType() == osg::NodeVisitor::UPDATE_VISITOR
-            // need to process at least 2 frames before shutting off update, since we need to have both frame-alternating RigGeometries initialized
-            // this would be more naturally handled if the double-buffering was implemented in RigGeometry itself rather than in a FrameSwitch decorator node
-            && mLastFrameNumber != 0 && mTraversedEvenFrame && mTraversedOddFrame)
+    if (nv.getVisitorType() == osg::NodeVisitor::UPDATE_VISITOR)
+    {
+        // need to process at least 2 frames before shutting off update, since we need to have both frame-alternating RigGeometries initialized
+        // this would be more naturally handled if the double-buffering was implemented in RigGeometry itself rather than in a FrameSwitch decorator node
+        bool initialized = mLastFrameNumber != 0 && mTraversedEvenFrame && mTraversedOddFrame;
+        if (initialized && !getActive())
+            return;
+
+        // frames skipped by the level of detail only leave the bones alone, see animateBones()
+        mAnimated = !initialized || needsUpdate(nv.getTraversalNumber());
+        if (mAnimated)
+        {
+            ++mPoseNumber;
+            mLastPoseFrameNumber = nv.getTraversalNumber();
+        }
+
+        const Skeleton* parent = sUpdatingSkeleton;
+        sUpdatingSkeleton = this;
+        osg::Group::traverse(nv);
+        sUpdatingSkeleton = parent;
         return;
+    }
+    else if (nv.getVisitorType() == osg::NodeVisitor::CULL_VISITOR)
+    {
+        // the closest of all cameras that see the skeleton in this frame
+        float distance = nv.getDistanceToEyePoint(getBound().center(), true);
+        if (mLastCullFrameNumber != nv.getTraversalNumber())
+            mCullDistance = distance;
+        else
+            mCullDistance = std::min(mCullDistance, distance);
+        mLastCullFrameNumber = nv.getTraversalNumber();
+    }
     osg::Group::traverse(nv);
 }
 
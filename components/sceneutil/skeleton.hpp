@@ -56,6 +56,22 @@ namespace SceneUtil
         /// If a new RigGeometry is added after the Skeleton has already been rendered, you must call markDirty().
         void markDirty();
 
+        /// Incremented whenever the bones are animated. Child rigs only need to be skinned again when this has changed.
+        unsigned int getPoseNumber() const;
+
+        /// Are the bones animated in the current update traversal? False on the frames skipped by the level of detail.
+        bool getAnimated() const;
+
+        /// Should controllers that move bones run in the current update traversal? False below a Skeleton that is not
+        /// animated in this frame. The rest of its subtree, e.g. particles and material controllers, is still updated.
+        /// @note Only valid during the update traversal, which must not run on several threads at once.
+        static bool animateBones();
+
+        /// Update the bones of distant skeletons less often. The update interval doubles with every multiple of
+        /// \a distance from the eye point, up to \a maxInterval frames. Skeletons that were not visible in the last
+        /// frame use \a maxInterval. A \a distance of 0 updates all skeletons every frame.
+        static void setLodSettings(float distance, unsigned int maxInterval);
+
         void traverse(osg::NodeVisitor& nv);
 
     private:
@@ -74,6 +90,17 @@ namespace SceneUtil
         unsigned int mLastFrameNumber;
         bool mTraversedEvenFrame;
         bool mTraversedOddFrame;
+
+        unsigned int mPoseNumber;
+        bool mAnimated;
+
+        // level of detail, measured by the cull traversal
+        unsigned int mLastCullFrameNumber;
+        float mCullDistance;
+        unsigned int mLastPoseFrameNumber;
+        unsigned int mLodPhase; // spreads the updates of skeletons with the same interval over different frames
+
+        bool needsUpdate(unsigned int traversalNumber) const;
     };
 
 }
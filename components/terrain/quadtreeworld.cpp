@@ -0,0 +1,453 @@
+#include "quadtreeworld.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <OpenThreads/ScopedLock>
+
+#include <osg/Geometry>
+#include <osg/Image>
+#include <osg/Texture2D>
+
+#include <osgUtil/CullVisitor>
+#include <osgUtil/IncrementalCompileOperation>
+
+#include <components/resource/resourcesystem.hpp>
+#include <components/resource/imagemanager.hpp>
+#include <components/resource/scenemanager.hpp>
+
+#include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+#include "storage.hpp"
+
+namespace
+{
+    // Chunks that were not needed for this many frames are dropped
+    const unsigned int sChunkExpiryFrames = 600;
+
+    // Texels of the composite map per cell, and the largest composite map of a chunk
+    const int sCompositeMapTexelsPerCell = 32;
+    const int sMaxCompositeMapSize = 128;
+
+    // Number of samples along each side of a layer texture to find its average colour
+    const int sLayerColourSamples = 8;
+
+    // The heights of a chunk are not known before it is built, so its bounds span this far up and down to test them
+    // against the view frustum
+    const float sChunkHeightBound = 16384.f;
+}
+
+namespace Terrain
+{
+
+class QuadTreeNode : public osg::Referenced
+{
+public:
+    QuadTreeNode(float size, const osg::Vec2f& center)
+        : mSize(size)
+        , mCenter(center)
+        , mBuilding(false)
+        , mLastUsedFrame(0)
+    {
+    }
+
+    // in cell units
+    float mSize;
+    osg::Vec2f mCenter;
+
+    // NULL where the node lies outside of the terrain bounds, all NULL for leafs
+    osg::ref_ptr<QuadTreeNode> mChildren[4];
+
+    // guarded by QuadTreeWorld::mMutex
+    osg::ref_ptr<osg::Node> mChunk;
+    bool mBuilding;
+    unsigned int mLastUsedFrame;
+};
+
+class BuildChunkWorkItem : public SceneUtil::WorkItem
+{
+public:
+    BuildChunkWorkItem(QuadTreeWorld* world, QuadTreeNode* node)
+        : mWorld(world)
+        , mNode(node)
+    {
+    }
+
+    virtual void doWork()
+    {
+        mWorld->buildChunk(mNode);
+    }
+
+private:
+    QuadTreeWorld* mWorld;
+    osg::ref_ptr<QuadTreeNode> mNode;
+};
+
+/// Root of the distant terrain in the scene graph. The chunks are not attached to it, but selected and culled anew for every camera.
+class DistantTerrainNode : public osg::Node
+{
+public:
+    DistantTerrainNode(QuadTreeWorld* world)
+        : mWorld(world)
+    {
+        // the bounds are not known, the chunks are culled individually
+        setCullingActive(false);
+    }
+
+    virtual void traverse(osg::NodeVisitor& nv)
+    {
+        if (nv.getVisitorType() == osg::NodeVisitor::CULL_VISITOR)
+            mWorld->cullDistantTerrain(static_cast<osgUtil::CullVisitor&>(nv));
+    }
+
+private:
+    QuadTreeWorld* mWorld;
+};
+
+QuadTreeWorld::QuadTreeWorld(osg::Group* parent, Resource::ResourceSystem* resourceSystem, osgUtil::IncrementalCompileOperation* ico, Storage* storage, int nodeMask,
+                             SceneUtil::WorkQueue* workQueue, float lodFactor, Shader::ShaderManager* shaderManager, SceneUtil::UnrefQueue* unrefQueue)
+    : TerrainGrid(parent, resourceSystem, ico, storage, nodeMask, shaderManager, unrefQueue)
+    , mWorkQueue(workQueue)
+    , mLodFactor(lodFactor)
+    , mViewDistance(std::numeric_limits<float>::max())
+    , mMaxChunkSize(static_cast<float>(storage->getCellVertices()-1))
+    , mChunkCache(storage->getCellVertices())
+    , mFrameNumber(0)
+{
+    const unsigned int numVerts = storage->getCellVertices();
+    for (unsigned int i=0; i<numVerts; ++i)
+        mEdgeVertices.push_back(i); // x = 0
+    for (unsigned int i=0; i<numVerts; ++i)
+        mEdgeVertices.push_back((numVerts-1)*numVerts + i); // x = max
+    for (unsigned int i=0; i<numVerts; ++i)
+        mEdgeVertices.push_back(i*numVerts); // y = 0
+    for (unsigned int i=0; i<numVerts; ++i)
+        mEdgeVertices.push_back(i*numVerts + numVerts-1); // y = max
+
+    // the skirt vertices follow the regular vertices, in the order of mEdgeVertices
+    mChunkUVs = new osg::Vec2Array(*mChunkCache.getUVBuffer(), osg::CopyOp::DEEP_COPY_ALL);
+    for (std::vector<unsigned int>::const_iterator it = mEdgeVertices.begin(); it != mEdgeVertices.end(); ++it)
+        mChunkUVs->push_back((*mChunkUVs)[*it]);
+    mChunkUVs->setVertexBufferObject(new osg::VertexBufferObject);
+
+    // Skirts hide the cracks between chunks of different detail. They are drawn from both sides, so their winding does not matter.
+    osg::ref_ptr<osg::DrawElementsUShort> skirtIndices (new osg::DrawElementsUShort(osg::PrimitiveSet::TRIANGLES));
+    for (unsigned int edge=0; edge<4; ++edge)
+    {
+        for (unsigned int i=0; i<numVerts-1; ++i)
+        {
+            unsigned int top = mEdgeVertices[edge*numVerts + i];
+            unsigned int nextTop = mEdgeVertices[edge*numVerts + i+1];
+            unsigned int bottom = numVerts*numVerts + edge*numVerts + i;
+            unsigned int nextBottom = bottom+1;
+
+            skirtIndices->push_back(top); skirtIndices->push_back(nextTop); skirtIndices->push_back(bottom);
+            skirtIndices->push_back(nextTop); skirtIndices->push_back(nextBottom); skirtIndices->push_back(bottom);
+
+            skirtIndices->push_back(top); skirtIndices->push_back(bottom); skirtIndices->push_back(nextTop);
+            skirtIndices->push_back(nextTop); skirtIndices->push_back(bottom); skirtIndices->push_back(nextBottom);
+        }
+    }
+    mSkirtIndices = skirtIndices;
+
+    mDistantRoot = new DistantTerrainNode(this);
+    mTerrainRoot->addChild(mDistantRoot);
+}
+
+QuadTreeWorld::~QuadTreeWorld()
+{
+    mTerrainRoot->removeChild(mDistantRoot);
+}
+
+void QuadTreeWorld::buildQuadTree()
+{
+    float minX, maxX, minY, maxY;
+    mStorage->getBounds(minX, maxX, minY, maxY);
+
+    float size = 1.f;
+    while (size < maxX - minX || size < maxY - minY)
+        size *= 2.f;
+    mRootNode = createNode(size, osg::Vec2f(minX + size/2.f, minY + size/2.f), minX, maxX, minY, maxY);
+}
+
+osg::ref_ptr<QuadTreeNode> QuadTreeWorld::createNode(float size, const osg::Vec2f& center, float minX, float maxX, float minY, float maxY)
+{
+    if (center.x() + size/2.f <= minX || center.x() - size/2.f >= maxX
+            || center.y() + size/2.f <= minY || center.y() - size/2.f >= maxY)
+        return NULL;
+
+    osg::ref_ptr<QuadTreeNode> node (new QuadTreeNode(size, center));
+    if (size > 1.f)
+    {
+        float childSize = size/2.f;
+        node->mChildren[0] = createNode(childSize, center + osg::Vec2f(-childSize/2.f, -childSize/2.f), minX, maxX, minY, maxY);
+        node->mChildren[1] = createNode(childSize, center + osg::Vec2f(childSize/2.f, -childSize/2.f), minX, maxX, minY, maxY);
+        node->mChildren[2] = createNode(childSize, center + osg::Vec2f(-childSize/2.f, childSize/2.f), minX, maxX, minY, maxY);
+        node->mChildren[3] = createNode(childSize, center + osg::Vec2f(childSize/2.f, childSize/2.f), minX, maxX, minY, maxY);
+    }
+    return node;
+}
+
+void QuadTreeWorld::loadCell(int x, int y)
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+
+        // the terrain bounds are only known once the content files are loaded
+        if (!mRootNode)
+            buildQuadTree();
+
+        mLoadedCells.insert(std::make_pair(x, y));
+    }
+
+    TerrainGrid::loadCell(x, y);
+}
+
+void QuadTreeWorld::unloadCell(int x, int y)
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        mLoadedCells.erase(std::make_pair(x, y));
+    }
+
+    TerrainGrid::unloadCell(x, y);
+}
+
+void QuadTreeWorld::setViewDistance(float distance)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    mViewDistance = distance;
+}
+
+void QuadTreeWorld::cullDistantTerrain(osgUtil::CullVisitor& cv)
+{
+    std::vector<osg::ref_ptr<osg::Node> > chunks;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+
+        // no exterior cells are loaded while in an interior
+        if (mLoadedCells.empty() || !mRootNode)
+            return;
+
+        mFrameNumber = cv.getTraversalNumber();
+        select(mRootNode, cv, chunks);
+    }
+
+    for (std::vector<osg::ref_ptr<osg::Node> >::const_iterator it = chunks.begin(); it != chunks.end(); ++it)
+        (*it)->accept(cv);
+}
+
+bool QuadTreeWorld::select(QuadTreeNode* node, osgUtil::CullVisitor& cv, std::vector<osg::ref_ptr<osg::Node> >& chunks)
+{
+    const float cellWorldSize = mStorage->getCellWorldSize();
+    const osg::Vec3f viewPoint = cv.getViewPoint();
+
+    float dx = std::max(0.f, std::abs(viewPoint.x() - node->mCenter.x() * cellWorldSize) - node->mSize/2.f * cellWorldSize);
+    float dy = std::max(0.f, std::abs(viewPoint.y() - node->mCenter.y() * cellWorldSize) - node->mSize/2.f * cellWorldSize);
+    float distance = std::sqrt(dx*dx + dy*dy);
+    if (distance > mViewDistance)
+        return true;
+
+    // the loaded cells are drawn by the TerrainGrid
+    bool hasLoadedCells = overlapsLoadedCells(node);
+    if (node->mSize <= 1.f)
+        return hasLoadedCells || useChunk(node, cv, chunks);
+
+    if (!hasLoadedCells && node->mSize <= mMaxChunkSize && distance > mLodFactor * node->mSize * cellWorldSize)
+        return useChunk(node, cv, chunks);
+
+    size_t firstChunk = chunks.size();
+    bool complete = true;
+    for (unsigned int i=0; i<4; ++i)
+    {
+        if (node->mChildren[i])
+            complete = select(node->mChildren[i], cv, chunks) && complete;
+    }
+
+    if (complete || hasLoadedCells || node->mSize > mMaxChunkSize)
+        return complete;
+
+    // some children are not built yet, this chunk stands in for all of them until they are
+    if (node->mChunk)
+        chunks.resize(firstChunk);
+    return useChunk(node, cv, chunks);
+}
+
+bool QuadTreeWorld::useChunk(QuadTreeNode* node, osgUtil::CullVisitor& cv, std::vector<osg::ref_ptr<osg::Node> >& chunks)
+{
+    node->mLastUsedFrame = mFrameNumber;
+
+    if (node->mChunk)
+    {
+        chunks.push_back(node->mChunk);
+        return true;
+    }
+
+    if (!node->mBuilding && mWorkQueue)
+    {
+        node->mBuilding = true;
+
+        const float cellWorldSize = mStorage->getCellWorldSize();
+        const osg::Vec2f min = (node->mCenter - osg::Vec2f(node->mSize, node->mSize) / 2.f) * cellWorldSize;
+        const osg::Vec2f max = (node->mCenter + osg::Vec2f(node->mSize, node->mSize) / 2.f) * cellWorldSize;
+        const osg::BoundingBox bounds (min.x(), min.y(), -sChunkHeightBound, max.x(), max.y(), sChunkHeightBound);
+
+        // chunks in view go before the ones that are only needed when the camera turns
+        mWorkQueue->addWorkItem(new BuildChunkWorkItem(this, node), !cv.isCulled(bounds));
+    }
+    return false;
+}
+
+bool QuadTreeWorld::overlapsLoadedCells(const QuadTreeNode* node) const
+{
+    float minX = node->mCenter.x() - node->mSize/2.f;
+    float minY = node->mCenter.y() - node->mSize/2.f;
+    for (std::set<std::pair<int, int> >::const_iterator it = mLoadedCells.begin(); it != mLoadedCells.end(); ++it)
+    {
+        if (it->first >= minX && it->first < minX + node->mSize && it->second >= minY && it->second < minY + node->mSize)
+            return true;
+    }
+    return false;
+}
+
+void QuadTreeWorld::buildChunk(QuadTreeNode* node)
+{
+    const float size = node->mSize;
+    const osg::Vec2f center = node->mCenter;
+
+    // LOD level n keeps every 2^n-th vertex, so that all chunks have as many vertices as a cell
+    int lodLevel = 0;
+    for (float lodSize = size; lodSize > 1.f; lodSize /= 2.f)
+        ++lodLevel;
+
+    osg::ref_ptr<osg::Vec3Array> positions (new osg::Vec3Array);
+    osg::ref_ptr<osg::Vec3Array> normals (new osg::Vec3Array);
+    osg::ref_ptr<osg::Vec4Array> colors (new osg::Vec4Array);
+
+    osg::ref_ptr<osg::VertexBufferObject> vbo (new osg::VertexBufferObject);
+    positions->setVertexBufferObject(vbo);
+    normals->setVertexBufferObject(vbo);
+    colors->setVertexBufferObject(vbo);
+
+    mStorage->fillVertexBuffers(lodLevel, size, center, positions, normals, colors);
+
+    // deep enough to cover the difference to a chunk of the next lower detail
+    const float skirtDepth = size * mStorage->getCellWorldSize() / 8.f;
+    for (std::vector<unsigned int>::const_iterator it = mEdgeVertices.begin(); it != mEdgeVertices.end(); ++it)
+    {
+        positions->push_back((*positions)[*it] - osg::Vec3f(0.f, 0.f, skirtDepth));
+        normals->push_back((*normals)[*it]);
+        colors->push_back((*colors)[*it]);
+    }
+
+    osg::ref_ptr<osg::Geometry> geometry (new osg::Geometry);
+    geometry->setVertexArray(positions);
+    geometry->setNormalArray(normals, osg::Array::BIND_PER_VERTEX);
+    geometry->setColorArray(colors, osg::Array::BIND_PER_VERTEX);
+    geometry->setTexCoordArray(0, mChunkUVs, osg::Array::BIND_PER_VERTEX);
+    geometry->setUseDisplayList(false);
+    geometry->setUseVertexBufferObjects(true);
+
+    geometry->addPrimitiveSet(mChunkCache.getIndexBuffer(0));
+    geometry->addPrimitiveSet(mSkirtIndices);
+
+    osg::ref_ptr<osg::Texture2D> compositeMap (new osg::Texture2D(createCompositeMap(size, center)));
+    compositeMap->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+    compositeMap->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+    mResourceSystem->getSceneManager()->applyFilterSettings(compositeMap);
+    geometry->getOrCreateStateSet()->setTextureAttributeAndModes(0, compositeMap);
+
+    osg::Vec2f worldCenter = center*mStorage->getCellWorldSize();
+    osg::ref_ptr<SceneUtil::PositionAttitudeTransform> transform (new SceneUtil::PositionAttitudeTransform);
+    transform->setPosition(osg::Vec3f(worldCenter.x(), worldCenter.y(), 0.f));
+    transform->addChild(geometry);
+
+    if (mIncrementalCompileOperation)
+        mIncrementalCompileOperation->add(geometry);
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    node->mChunk = transform;
+    node->mBuilding = false;
+}
+
+osg::ref_ptr<osg::Image> QuadTreeWorld::createCompositeMap(float size, const osg::Vec2f& center)
+{
+    const int resolution = std::min(sMaxCompositeMapSize, static_cast<int>(size * sCompositeMapTexelsPerCell));
+
+    std::vector<unsigned short> layerIndices;
+    std::vector<LayerInfo> layerList;
+    mStorage->getLayerIndices(size, center, resolution, layerIndices, layerList);
+
+    std::vector<osg::Vec4f> layerColours;
+    for (std::vector<LayerInfo>::const_iterator it = layerList.begin(); it != layerList.end(); ++it)
+        layerColours.push_back(getLayerColour(it->mDiffuseMap));
+
+    osg::ref_ptr<osg::Image> image (new osg::Image);
+    image->allocateImage(resolution, resolution, 1, GL_RGB, GL_UNSIGNED_BYTE);
+    unsigned char* data = image->data();
+
+    for (int y=0; y<resolution; ++y)
+    {
+        for (int x=0; x<resolution; ++x)
+        {
+            const osg::Vec4f& colour = layerColours[layerIndices[y*resolution + x]];
+
+            // flipped like the blendmaps, to match the texture coordinates of the chunk
+            unsigned char* texel = data + ((resolution - y - 1)*resolution + x)*3;
+            for (int i=0; i<3; ++i)
+                texel[i] = static_cast<unsigned char>(std::min(255.f, colour[i] * 255.f + 0.5f));
+        }
+    }
+
+    return image;
+}
+
+osg::Vec4f QuadTreeWorld::getLayerColour(const std::string& texture)
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mLayerColourMutex);
+        std::map<std::string, osg::Vec4f>::const_iterator found = mLayerColours.find(texture);
+        if (found != mLayerColours.end())
+            return found->second;
+    }
+
+    osg::ref_ptr<osg::Image> image = mResourceSystem->getImageManager()->getImage(texture);
+
+    osg::Vec4f colour (0.f, 0.f, 0.f, 0.f);
+    for (int y=0; y<sLayerColourSamples; ++y)
+    {
+        for (int x=0; x<sLayerColourSamples; ++x)
+            colour += image->getColor(osg::Vec2f((x + 0.5f) / sLayerColourSamples, (y + 0.5f) / sLayerColourSamples));
+    }
+    colour /= static_cast<float>(sLayerColourSamples * sLayerColourSamples);
+    colour.a() = 1.f;
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mLayerColourMutex);
+    mLayerColours[texture] = colour;
+    return colour;
+}
+
+void QuadTreeWorld::updateCache()
+{
+    TerrainGrid::updateCache();
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    if (mRootNode)
+        expireChunks(mRootNode);
+}
+
+void QuadTreeWorld::expireChunks(QuadTreeNode* node)
+{
+    if (node->mChunk && mFrameNumber - node->mLastUsedFrame > sChunkExpiryFrames)
+        node->mChunk = NULL;
+
+    for (unsigned int i=0; i<4; ++i)
+    {
+        if (node->mChildren[i])
+            expireChunks(node->mChildren[i]);
+    }
+}
+
+}
@@ -0,0 +1,119 @@
+#ifndef COMPONENTS_TERRAIN_QUADTREEWORLD_H
+#define COMPONENTS_TERRAIN_QUADTREEWORLD_H
+
+#include <set>
+
+#include <OpenThreads/Mutex>
+
+#include <osg/Vec3f>
+#include <osg/Vec4f>
+
+#include "terraingrid.hpp"
+
+namespace osg
+{
+    class DrawElements;
+    class Image;
+}
+
+namespace osgUtil
+{
+    class CullVisitor;
+}
+
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
+namespace Terrain
+{
+
+    class QuadTreeNode;
+
+    /// @brief Terrain implementation that draws the loaded cells like TerrainGrid, and the terrain around them using a quad tree
+    /// of chunks with decreasing level of detail.
+    /// @par All chunks have the same number of vertices, so the larger a chunk, the less detailed it is. A chunk is drawn once the
+    /// camera is far enough away relative to its size, otherwise its children are drawn. Chunks are built on a WorkQueue when they
+    /// are first needed, those in view before the others. Until then their parent stands in for them. Instead of blending the texture layers, distant chunks are
+    /// textured with a composite map holding the average colour of the layer at each point.
+    /// @note The work queue must be destroyed before this world, since it may still be building chunks.
+    class QuadTreeWorld : public TerrainGrid
+    {
+    public:
+        /// @param lodFactor a chunk is drawn when the camera is further away from it than \a lodFactor times its size
+        QuadTreeWorld(osg::Group* parent, Resource::ResourceSystem* resourceSystem, osgUtil::IncrementalCompileOperation* ico, Storage* storage, int nodeMask,
+                      SceneUtil::WorkQueue* workQueue, float lodFactor, Shader::ShaderManager* shaderManager = NULL, SceneUtil::UnrefQueue* unrefQueue = NULL);
+        ~QuadTreeWorld();
+
+        /// @note Not thread safe.
+        virtual void loadCell(int x, int y);
+
+        /// @note Not thread safe.
+        virtual void unloadCell(int x, int y);
+
+        virtual void setViewDistance(float distance);
+
+        /// Clear cached objects that are no longer referenced, and distant chunks that were not needed for a while.
+        /// @note Thread safe.
+        void updateCache();
+
+        /// Select the distant chunks to draw for the camera of \a cv, and cull them.
+        /// @par Used internally by the root node of the distant terrain.
+        void cullDistantTerrain(osgUtil::CullVisitor& cv);
+
+        /// Build the chunk of \a node.
+        /// @par Used internally, from the threads of the work queue.
+        void buildChunk(QuadTreeNode* node);
+
+    private:
+        // Build the quad tree over the bounds of the storage, on the first loadCell.
+        void buildQuadTree();
+
+        osg::ref_ptr<QuadTreeNode> createNode(float size, const osg::Vec2f& center, float minX, float maxX, float minY, float maxY);
+
+        // Add the chunks to draw for \a node to \a chunks.
+        // @return false if some of them could not be drawn, because they are not built yet
+        bool select(QuadTreeNode* node, osgUtil::CullVisitor& cv, std::vector<osg::ref_ptr<osg::Node> >& chunks);
+
+        // Add the chunk of \a node to \a chunks if it is built, otherwise request it.
+        bool useChunk(QuadTreeNode* node, osgUtil::CullVisitor& cv, std::vector<osg::ref_ptr<osg::Node> >& chunks);
+
+        bool overlapsLoadedCells(const QuadTreeNode* node) const;
+
+        void expireChunks(QuadTreeNode* node);
+
+        osg::ref_ptr<osg::Image> createCompositeMap(float size, const osg::Vec2f& center);
+
+        // the average colour of a layer texture
+        osg::Vec4f getLayerColour(const std::string& texture);
+
+        osg::ref_ptr<osg::Node> mDistantRoot;
+
+        SceneUtil::WorkQueue* mWorkQueue;
+
+        float mLodFactor;
+        float mViewDistance;
+
+        // size of the largest chunk in cell units, at which there is one quad per cell left
+        float mMaxChunkSize;
+
+        // shared by all chunks, which have the same number of vertices
+        BufferCache mChunkCache;
+        osg::ref_ptr<osg::Vec2Array> mChunkUVs; // includes the skirts
+        osg::ref_ptr<osg::DrawElements> mSkirtIndices;
+        std::vector<unsigned int> mEdgeVertices; // vertices along the four edges of a chunk, the skirts hang down from them
+
+        // guarded by mMutex, as is the state of the quad tree nodes
+        osg::ref_ptr<QuadTreeNode> mRootNode; // NULL until the first cell is loaded
+        std::set<std::pair<int, int> > mLoadedCells;
+        unsigned int mFrameNumber;
+        OpenThreads::Mutex mMutex;
+
+        std::map<std::string, osg::Vec4f> mLayerColours;
+        OpenThreads::Mutex mLayerColourMutex;
+    };
+
+}
+
+#endif
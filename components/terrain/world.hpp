@@ -51,6 +51,9 @@ namespace Terrain
         virtual void loadCell(int x, int y) {}
         virtual void unloadCell(int x, int y) {}
 
+        /// Distance up to which terrain is visible. This is only a hint and may be ignored by the implementation.
+        virtual void setViewDistance(float distance) {}
+
         Storage* getStorage() { return mStorage; }
 
     protected:
@@ -4,9 +4,9 @@ namespace VFS
 {
 
 
-BsaArchive::BsaArchive(const std::string &filename)
+BsaArchive::BsaArchive(const std::string &filename, bool memoryMapped)
 {
-    mFile.open(filename);
+    mFile.open(filename, memoryMapped);
 
     const Bsa::BSAFile::FileList &filelist = mFile.getList();
     for(Bsa::BSAFile::FileList::const_iterator it = filelist.begin();it != filelist.end();++it)
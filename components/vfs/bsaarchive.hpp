@@ -22,7 +22,8 @@ namespace VFS
     class BsaArchive : public Archive
     {
     public:
-        BsaArchive(const std::string& filename);
+        /// @param memoryMapped Serve the contained files from a memory mapping of the archive, see Bsa::BSAFile::open.
+        BsaArchive(const std::string& filename, bool memoryMapped=false);
 
         virtual void listResources(std::map<std::string, File*>& out, char (*normalize_function) (char));
 
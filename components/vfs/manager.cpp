@@ -26,6 +26,34 @@ namespace
         std::transform(path.begin(), path.end(), path.begin(), normalize_char);
     }
 
+    struct StrictNormalize
+    {
+        char operator()(char ch) const { return strict_normalize_char(ch); }
+    };
+
+    struct NonStrictNormalize
+    {
+        char operator()(char ch) const { return nonstrict_normalize_char(ch); }
+    };
+
+    struct AlreadyNormalized
+    {
+        char operator()(char ch) const { return ch; }
+    };
+
+    /// FNV-1a hash of the normalized path, computed without creating a normalized copy.
+    template <class Normalize>
+    size_t hash_path(const std::string& path, Normalize normalize)
+    {
+        size_t hash = 2166136261u;
+        for (std::string::const_iterator it = path.begin(); it != path.end(); ++it)
+        {
+            hash ^= static_cast<unsigned char>(normalize(*it));
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
 }
 
 namespace VFS
@@ -55,30 +83,86 @@ namespace VFS
 
         for (std::vector<Archive*>::const_iterator it = mArchives.begin(); it != mArchives.end(); ++it)
             (*it)->listResources(mIndex, mStrict ? &strict_normalize_char : &nonstrict_normalize_char);
+
+        // keep the load factor at or below 0.5
+        size_t size = 16;
+        while (size < mIndex.size() * 2)
+            size *= 2;
+
+        HashEntry empty;
+        empty.mHash = 0;
+        empty.mName = NULL;
+        empty.mFile = NULL;
+        mHashIndex.assign(size, empty);
+
+        const size_t mask = size - 1;
+        for (std::map<std::string, File*>::const_iterator it = mIndex.begin(); it != mIndex.end(); ++it)
+        {
+            size_t hash = hash_path(it->first, AlreadyNormalized());
+            size_t slot = hash & mask;
+            while (mHashIndex[slot].mFile)
+                slot = (slot + 1) & mask;
+
+            HashEntry& entry = mHashIndex[slot];
+            entry.mHash = hash;
+            entry.mName = &it->first;
+            entry.mFile = it->second;
+        }
     }
 
-    Files::IStreamPtr Manager::get(const std::string &name) const
+    template <class Normalize>
+    File* Manager::lookup(const std::string &name, size_t hash, Normalize normalize) const
     {
-        std::string normalized = name;
-        normalize_path(normalized, mStrict);
+        if (mHashIndex.empty())
+            return NULL;
+
+        const size_t mask = mHashIndex.size() - 1;
+        for (size_t slot = hash & mask; mHashIndex[slot].mFile; slot = (slot + 1) & mask)
+        {
+            const HashEntry& entry = mHashIndex[slot];
+            if (entry.mHash != hash || entry.mName->size() != name.size())
+                continue;
+
+            std::string::const_iterator it = name.begin();
+            std::string::const_iterator entryIt = entry.mName->begin();
+            for (; it != name.end(); ++it, ++entryIt)
+            {
+                if (normalize(*it) != *entryIt)
+                    break;
+            }
+            if (it == name.end())
+                return entry.mFile;
+        }
+        return NULL;
+    }
 
-        return getNormalized(normalized);
+    Files::IStreamPtr Manager::get(const std::string &name) const
+    {
+        File* file = mStrict ? lookup(name, hash_path(name, StrictNormalize()), StrictNormalize())
+                             : lookup(name, hash_path(name, NonStrictNormalize()), NonStrictNormalize());
+        if (!file)
+        {
+            std::string normalized = name;
+            normalize_path(normalized, mStrict);
+            throw std::runtime_error("Resource '" + normalized + "' not found");
+        }
+        return file->open();
     }
 
     Files::IStreamPtr Manager::getNormalized(const std::string &normalizedName) const
     {
-        std::map<std::string, File*>::const_iterator found = mIndex.find(normalizedName);
-        if (found == mIndex.end())
+        File* file = lookup(normalizedName, hash_path(normalizedName, AlreadyNormalized()), AlreadyNormalized());
+        if (!file)
             throw std::runtime_error("Resource '" + normalizedName + "' not found");
-        return found->second->open();
+        return file->open();
     }
 
     bool Manager::exists(const std::string &name) const
     {
-        std::string normalized = name;
-        normalize_path(normalized, mStrict);
-
-        return mIndex.find(normalized) != mIndex.end();
+        if (mStrict)
+            return lookup(name, hash_path(name, StrictNormalize()), StrictNormalize()) != NULL;
+        else
+            return lookup(name, hash_path(name, NonStrictNormalize()), NonStrictNormalize()) != NULL;
     }
 
     const std::map<std::string, File*>& Manager::getIndex() const
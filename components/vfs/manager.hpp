@@ -56,11 +56,25 @@ namespace VFS
         Files::IStreamPtr getNormalized(const std::string& normalizedName) const;
 
     private:
+        /// Find the file with the given name, normalizing the name on the fly. Returns NULL if not found.
+        template <class Normalize>
+        File* lookup(const std::string& name, size_t hash, Normalize normalize) const;
+
         bool mStrict;
 
         std::vector<Archive*> mArchives;
 
         std::map<std::string, File*> mIndex;
+
+        struct HashEntry
+        {
+            size_t mHash;
+            const std::string* mName;
+            File* mFile;
+        };
+
+        /// Open addressing hash table over mIndex, used for lookups. The size is a power of two.
+        std::vector<HashEntry> mHashIndex;
     };
 
 }